@@ -14,6 +14,7 @@
 #endif
 
 #include "CameraDevice.h"
+#include <algorithm>
 #include <chrono>
 #if defined(USE_EXPERIMENTAL_FS)
 #include <experimental/filesystem>
@@ -28,6 +29,10 @@ namespace fs = std::filesystem;
 #include "Text.h"
 #include "OpenCVWrapper.h"
 #include "CrDebugString.h"
+#include "TransferTuner.h"
+#include "ThumbnailCache.h"
+#include "Metrics.h"
+#include "Logger.h"
 
 #if defined(__APPLE__) || defined(__linux__)
 #include <sys/stat.h>
@@ -84,6 +89,33 @@ constexpr int const ImageSaveAutoStartNo = -1;
 
 namespace cli
 {
+namespace
+{
+struct DeviceMetrics
+{
+    MetricCounter& connectAttempts = metrics().counter("remotecli_connect_attempts_total", "Connect requests sent to cameras");
+    MetricCounter& reconnects = metrics().counter("remotecli_reconnects_total", "Connections lost and being re-established by the SDK");
+    MetricCounter& disconnects = metrics().counter("remotecli_disconnects_total", "Camera disconnections");
+    MetricGauge& connected = metrics().gauge("remotecli_cameras_connected", "Cameras currently connected");
+    MetricCounter& propertyReadFailures = metrics().counter("remotecli_property_read_failures_total", "Failed device property reads");
+    MetricCounter& transferBytes = metrics().counter("remotecli_transfer_bytes_total", "Bytes received by remote transfer");
+    MetricCounter& transferFailures = metrics().counter("remotecli_transfer_failures_total", "Remote transfers that failed or were cancelled");
+    MetricHistogram& transferSeconds = metrics().histogram("remotecli_transfer_file_seconds", "Duration of one remote transfer request");
+    MetricGauge& transferRate = metrics().gauge("remotecli_transfer_last_rate_kbps", "Rate of the last completed remote transfer, KiB/s");
+};
+
+DeviceMetrics& device_metrics()
+{
+    static DeviceMetrics m;
+    return m;
+}
+
+// A remote transfer with no data for this long is cancelled
+constexpr auto transfer_stall_timeout = 30s;
+// How long to wait for the camera to confirm a cancel before giving up on it
+constexpr auto transfer_cancel_timeout = 5s;
+} // namespace
+
 CameraDevice::CameraDevice(std::int32_t no, SCRSDK::ICrCameraObjectInfo const* camera_info)
     : m_number(no)
     , m_device_handle(0)
@@ -104,6 +136,16 @@ CameraDevice::CameraDevice(std::int32_t no, SCRSDK::ICrCameraObjectInfo const* c
     , m_getContentsDataStartFlg(false)
     , m_getContentsData_notify(0)
     , m_getContentsData_per(0)
+    , m_getContentsData_slot(0)
+    , m_getContentsData_addSize(0)
+    , m_transferSink(nullptr)
+    , m_transferOffset(0)
+    , m_transferPer(0)
+    , m_transferResult(0)
+    , m_transferDone(false)
+    , m_transferFailed(false)
+    , m_transferFirstBytes(0)
+    , m_thumbnailPrefetchStop(false)
     , m_latestFirmwareUploadRate(0)
 {
     m_info = SDK::CreateCameraObjectInfo(
@@ -125,10 +167,15 @@ CameraDevice::CameraDevice(std::int32_t no, SCRSDK::ICrCameraObjectInfo const* c
     m_captureDateList[1] = nullptr;
     m_contentsInfoList[0] = nullptr;
     m_contentsInfoList[1] = nullptr;
+    m_contentsListUpdateTime[0] = 0;
+    m_contentsListUpdateTime[1] = 0;
+    m_ingestedSeeded[0] = false;
+    m_ingestedSeeded[1] = false;
 }
 
 CameraDevice::~CameraDevice()
 {
+    stop_thumbnail_prefetch();
     if (m_modelNameProp)delete m_modelNameProp;
     if (m_info) m_info->Release();
 }
@@ -232,10 +279,14 @@ bool CameraDevice::connect(SCRSDK::CrSdkControlMode openMode, SCRSDK::CrReconnec
     }
 
     m_spontaneous_disconnection = false;
-    auto connect_status = SDK::Connect(m_info, this, &m_device_handle, openMode, reconnect, inputId, m_userPassword.c_str(), m_fingerprint.c_str(), (CrInt32u)m_fingerprint.size());
+    static SdkCallMetrics& connectMetrics = sdk_call_metrics("Connect");
+    device_metrics().connectAttempts.inc();
+    auto connect_status = timed_sdk_call(connectMetrics, [&]() {
+        return SDK::Connect(m_info, this, &m_device_handle, openMode, reconnect, inputId, m_userPassword.c_str(), m_fingerprint.c_str(), (CrInt32u)m_fingerprint.size());
+    });
     if (CR_FAILED(connect_status)) {
-        text id(this->get_id());
-        tout << std::endl << "Failed to connect: 0x" << std::hex << connect_status << std::dec << ". " << m_info->GetModel() << " (" << id.data() << ")\n";
+        log_error("connect failed").kv("camera", get_id()).kv("model", m_info->GetModel())
+            .kv_hex("error", static_cast<std::uint32_t>(connect_status));
         m_userPassword.clear();
         return false;
     }
@@ -4697,18 +4748,23 @@ text CameraDevice::get_id()
 
 void CameraDevice::OnConnected(SDK::DeviceConnectionVersioin version)
 {
-    m_connected.store(true);
-    text id(this->get_id());
-    tout << "Connected to " << m_info->GetModel() << " (" << id.data() << ")\n";
+    if (!m_connected.exchange(true)) {
+        device_metrics().connected.add(1);
+    }
+    log_info("connected").kv("camera", get_id()).kv("model", m_info->GetModel())
+        .kv("version", static_cast<std::uint32_t>(version));
 }
 
 void CameraDevice::OnDisconnected(CrInt32u error)
 {
-    m_connected.store(false);
-    text id(this->get_id());
-    tout << "Disconnected from " << m_info->GetModel() << " (" << id.data() << ")\n";
+    if (m_connected.exchange(false)) {
+        device_metrics().connected.add(-1);
+    }
+    device_metrics().disconnects.inc();
+    log_info("disconnected").kv("camera", get_id()).kv("model", m_info->GetModel()).kv_hex("error", error);
     if ((false == m_spontaneous_disconnection) && (SDK::CrSdkControlMode_ContentsTransfer == m_modeSDK))
     {
+        Logger::instance().flush();
         tout << "Please input '0' to return to the TOP-MENU\n";
     }
 }
@@ -4725,14 +4781,13 @@ void CameraDevice::OnLvPropertyChanged()
 
 void CameraDevice::OnCompleteDownload(CrChar* filename, CrInt32u type )
 {
-    text file(filename);
     switch (type)
     {
     case SCRSDK::CrDownloadSettingFileType_None:
-        tout << "Complete download. File: " << file.data() << '\n';
+        log_info("download complete").kv("camera", get_id()).kv("file", filename);
         break;
     case SCRSDK::CrDownloadSettingFileType_Setup:
-        tout << "Complete download. Camera Setting File: " << file.data() << '\n';
+        log_info("download complete").kv("camera", get_id()).kv("setting_file", filename);
         break;
     default:
         break;
@@ -4744,24 +4799,20 @@ void CameraDevice::OnNotifyContentsTransfer(CrInt32u notify, SDK::CrContentHandl
     // Start
     if (SDK::CrNotify_ContentsTransfer_Start == notify)
     {
-        tout << "[START] Contents Handle: 0x " << std::hex << contentHandle << std::dec << std::endl;
+        log_info("contents transfer started").kv("camera", get_id()).kv_hex("handle", contentHandle);
     }
     // Complete
     else if (SDK::CrNotify_ContentsTransfer_Complete == notify)
     {
-        text file(filename);
-        tout << "[COMPLETE] Contents Handle: 0x" << std::hex << contentHandle << std::dec << ", File: " << file.data() << std::endl;
+        log_info("contents transfer complete").kv("camera", get_id()).kv_hex("handle", contentHandle)
+            .kv("file", filename);
     }
     // Other
     else
     {
         text msg = get_message_desc(notify);
-        if (msg.empty()) {
-            tout << "[-] Content transfer failure. 0x" << std::hex << notify << ", handle: 0x" << contentHandle << std::dec << std::endl;
-        } else {
-            tout << "[-] Content transfer failure. handle: 0x" << std::hex << contentHandle  << std::dec << std::endl << "    -> ";
-            tout << msg.data() << std::endl;
-        }
+        log_warn("contents transfer failed").kv("camera", get_id()).kv_hex("handle", contentHandle)
+            .kv_hex("notify", notify).kv("reason", msg);
     }
 }
 
@@ -4769,9 +4820,12 @@ void CameraDevice::OnWarning(CrInt32u warning)
 {
     text id(this->get_id());
     if (SDK::CrWarning_Connect_Reconnecting == warning) {
-        tout << "Device Disconnected. Reconnecting... " << m_info->GetModel() << " (" << id.data() << ")\n";
+        device_metrics().reconnects.inc();
+        log_warn("reconnecting").kv("camera", id).kv("model", m_info->GetModel());
         return;
     }
+    // Events logged before this warning are printed ahead of its message
+    Logger::instance().flush();
     switch (warning)
     {
     case SDK::CrWarning_ContentsTransferMode_Invalid:
@@ -4894,15 +4948,56 @@ void CameraDevice::OnNotifyRemoteTransferResult(CrInt32u notify, CrInt32u per, C
 
 void CameraDevice::OnNotifyRemoteTransferResult(CrInt32u notify, CrInt32u per, CrInt8u* data, CrInt64u size)
 {
-    
+    std::lock_guard<std::mutex> lock(m_transferMtx);
+    if (nullptr == m_transferSink || m_transferDone) {
+        return;
+    }
+    if (data && size > 0 && !m_transferFailed) {
+        // The cancel request is issued by the waiting thread, not from inside the callback
+        if (!m_transferSink->write(data, size, m_transferOffset)) {
+            m_transferFailed = true;
+        }
+        if (m_transferOffset == 0) {
+            m_transferFirstBytes = size;
+            m_transferFirstData = std::chrono::steady_clock::now();
+        }
+        m_transferOffset += size;
+        m_transferLastData = std::chrono::steady_clock::now();
+    }
+    m_transferPer = per;
+    switch (notify) {
+    case SDK::CrNotify_RemoteTransfer_Result_OK:
+    case SDK::CrNotify_RemoteTransfer_Result_NG:
+    case SDK::CrNotify_RemoteTransfer_Result_DeviceBusy:
+    case SDK::CrNotify_RemoteTransfer_Control_Stopped:
+    case SDK::CrNotify_RemoteTransfer_Control_Canceled:
+        m_transferDone = true;
+        m_transferResult = notify;
+        break;
+    default:
+        break;
+    }
+    m_transferCv.notify_all();
 }
 
 void CameraDevice::OnNotifyRemoteTransferContentsListChanged(CrInt32u notify, CrInt32u slotNumber, CrInt32u addSize)
 {
     if( m_getContentsDataStartFlg == true ){
         m_getContentsData_notify = notify;
+        m_getContentsData_slot = slotNumber;
+        m_getContentsData_addSize = addSize;
         m_getContentsDataMovieCv.notify_all();
     }
+    std::lock_guard<std::mutex> lock(m_contentsListMtx);
+    if (m_contentsListListener) {
+        m_contentsListListener(notify, slotNumber, addSize);
+    }
+}
+
+void CameraDevice::set_contents_list_listener(ContentsListListener listener)
+{
+    std::lock_guard<std::mutex> lock(m_contentsListMtx);
+    m_contentsListListener = listener;
 }
 
 void CameraDevice::OnNotifyRemoteFirmwareUpdateResult(CrInt32u notify, const void* param)
@@ -5156,6 +5251,7 @@ void CameraDevice::OnError(CrInt32u error)
     text id(this->get_id());
     text msg = get_message_desc(error);
     if (!msg.empty()) {
+        Logger::instance().flush();
         // output is 2 line
         tout << std::endl << msg.data() << std::endl;
         tout << m_info->GetModel() << " (" << id.data() << ")" << std::endl;
@@ -5195,17 +5291,20 @@ void CameraDevice::load_properties(CrInt32u num, CrInt32u* codes)
     m_prop.media_slot1_quick_format_enable_status.writable = -1;
     m_prop.media_slot2_quick_format_enable_status.writable = -1;
 
+    static SdkCallMetrics& getAllMetrics = sdk_call_metrics("GetDeviceProperties");
+    static SdkCallMetrics& getSelectMetrics = sdk_call_metrics("GetSelectDeviceProperties");
     SDK::CrError status = SDK::CrError_Generic;
     if (0 == num){
         // Get all
-        status = SDK::GetDeviceProperties(m_device_handle, &prop_list, &nprop);
+        status = timed_sdk_call(getAllMetrics, [&]() { return SDK::GetDeviceProperties(m_device_handle, &prop_list, &nprop); });
     }
     else {
         // Get difference
-        status = SDK::GetSelectDeviceProperties(m_device_handle, num, codes, &prop_list, &nprop);
+        status = timed_sdk_call(getSelectMetrics, [&]() { return SDK::GetSelectDeviceProperties(m_device_handle, num, codes, &prop_list, &nprop); });
     }
 
     if (CR_FAILED(status)) {
+        device_metrics().propertyReadFailures.inc();
         tout << "Failed to get device properties.\n";
         return;
     }
@@ -5995,6 +6094,7 @@ void CameraDevice::getContentsList()
         return;
     }
 
+    stop_thumbnail_prefetch();
     for (CRFolderInfos* pF : m_foldList)
     {
         delete pF;
@@ -6138,6 +6238,8 @@ void CameraDevice::getContentsList()
             }
         }
 
+        start_thumbnail_prefetch();
+
         while (1)
         {
             if (m_connected == false) {
@@ -6210,6 +6312,8 @@ void CameraDevice::getContentsList()
                         }
                         break;
                     }
+                    // Interactive transfers get the handle to themselves
+                    stop_thumbnail_prefetch();
                     switch (selected_contentSize)
                     {
                     case 1:
@@ -6218,7 +6322,7 @@ void CameraDevice::getContentsList()
                         break;
                     case 2:
                         // [sync] get thumbnail jpeg
-                        getThumbnail(targetHandle);
+                        getThumbnail(*m_contentList[selected_index - 1]);
                         break;
                     case 3:
                         // [async] [only still] get screennail jpeg
@@ -6309,105 +6413,202 @@ void CameraDevice::getScreennail(SDK::CrContentHandle content)
     }
 }
 
-void CameraDevice::getThumbnail(SDK::CrContentHandle content)
+static ThumbnailCache& thumbnail_cache()
+{
+    static ThumbnailCache cache((fs::current_path() / "ThumbnailCache").native());
+    return cache;
+}
+
+static std::string narrow_text(text const& t)
+{
+    std::string s;
+    for (auto c : t) s.push_back((char)c);
+    return s;
+}
+
+std::string CameraDevice::content_cache_serial()
+{
+    text serial;
+    if (nullptr != m_bodySerialNumberProp) serial = getCurrentStr(m_bodySerialNumberProp);
+    if (serial.empty()) serial = get_id();
+    return narrow_text(serial);
+}
+
+std::string CameraDevice::thumbnail_cache_key(SDK::CrMtpContentsInfo const& content)
+{
+    size_t len = 0;
+    while (len < sizeof(content.dateChar) / sizeof(CrChar) && content.dateChar[len]) len++;
+    std::string date = narrow_text(text(content.dateChar, content.dateChar + len));
+    std::ostringstream handle;
+    handle << std::hex << std::uppercase << content.handle;
+    return ThumbnailCache::make_key(content_cache_serial(), "T", handle.str(), date);
+}
+
+bool CameraDevice::fetch_thumbnail(SDK::CrContentHandle content, std::vector<CrInt8u>& image, CrInt32u& fileType, SDK::CrError& err)
 {
     CrInt32u bufSize = 0x28000; // @@@@ temp
+    std::vector<CrInt8u> image_buff(bufSize);
+    SDK::CrImageDataBlock image_data;
+    image_data.SetSize(bufSize);
+    image_data.SetData(image_buff.data());
 
-    auto* image_data = new SDK::CrImageDataBlock();
-    if (!image_data)
+    SDK::CrFileType type = SDK::CrFileType_None;
     {
-        tout << "getThumbnail FAILED (new CrImageDataBlock class)\n";
-        return;
+        std::lock_guard<std::mutex> lock(m_thumbnailMtx);
+        err = SDK::GetContentsThumbnailImage(m_device_handle, content, &image_data, &type);
     }
-    CrInt8u* image_buff = new CrInt8u[bufSize];
-    if (!image_buff)
-    {
-        delete image_data;
-        tout << "getThumbnail FAILED (new Image buffer)\n";
+    if (CR_FAILED(err) || 0 == image_data.GetSize() || type == SDK::CrFileType_None) {
+        return false;
+    }
+    image.assign(image_data.GetImageData(), image_data.GetImageData() + image_data.GetImageSize());
+    fileType = type;
+    return true;
+}
+
+void CameraDevice::start_thumbnail_prefetch()
+{
+    stop_thumbnail_prefetch();
+    std::vector<std::pair<SDK::CrContentHandle, std::string>> targets;
+    for (SDK::CrMtpContentsInfo* pC : m_contentList) {
+        std::string key = thumbnail_cache_key(*pC);
+        if (!thumbnail_cache().contains(key)) {
+            targets.push_back(std::make_pair(pC->handle, key));
+        }
+    }
+    if (targets.empty()) {
         return;
     }
-    image_data->SetSize(bufSize);
-    image_data->SetData(image_buff);
+    tout << "Prefetching " << targets.size() << " thumbnails in the background\n";
+    m_thumbnailPrefetchStop = false;
+    m_thumbnailPrefetch = std::thread([this, targets]() {
+        for (auto const& target : targets) {
+            if (m_thumbnailPrefetchStop || !m_connected) break;
+            std::vector<CrInt8u> image;
+            CrInt32u fileType = 0;
+            SDK::CrError err = SDK::CrError_None;
+            if (fetch_thumbnail(target.first, image, fileType, err)) {
+                thumbnail_cache().insert(target.second, image.data(), image.size(), fileType);
+            }
+        }
+        thumbnail_cache().flush();
+    });
+}
 
-    SDK::CrFileType fileType = SDK::CrFileType_None;
-    SDK::CrError err = SDK::GetContentsThumbnailImage(m_device_handle, content, image_data, &fileType);
-    if (CR_FAILED(err))
-    {
-        //tout << "[Error] err=0x";
-        //std::ostringstream err_hex;
-        //err_hex << std::hex << std::uppercase << err;
-        //tout << std::dec;
-        //std::string err_str = err_hex.str();
-        //err_str.erase(std::remove(err_str.begin(), err_str.end(), ','), err_str.end());
-        //const char* err_char = err_str.c_str();
-        //tout.fill('0');
-        //tout.width(4);
-        //tout << err_char;
-        //tout << ", handle(0x";
-        //std::ostringstream content_hex;
-        //content_hex << std::hex << std::uppercase << content;
-        //tout << std::dec;
-        //std::string content_str = content_hex.str();
-        //content_str.erase(std::remove(content_str.begin(), content_str.end(), ','), content_str.end());
-        //const char* content_char = content_str.c_str();
-        //tout.fill('0');
-        //tout.width(8);
-        //tout << content_char << "), \n";
+void CameraDevice::stop_thumbnail_prefetch()
+{
+    m_thumbnailPrefetchStop = true;
+    if (m_thumbnailPrefetch.joinable()) {
+        m_thumbnailPrefetch.join();
+    }
+}
 
-        text id(this->get_id());
-        text msg = get_message_desc(err);
-        if (!msg.empty()) {
-            // output is 2 line
-            tout << std::endl << msg.data() << ", handle=" << std::hex << content << std::dec << std::endl;
-            tout << m_info->GetModel() << " (" << id.data() << ")" << std::endl;
+bool CameraDevice::get_remote_transfer_compresseddata_cached(SDK::CrSlotNumber slotNumber, SDK::CrContentsInfo& contentsInfo,
+                                                             SDK::CrContentsFile& contentsFile, SDK::CrGetContentsCompressedDataType type)
+{
+    bool thumbnail = (type == SDK::CrGetContentsCompressedDataType_Thumbnail);
+    char buff[64];
+    SDK::CrCaptureDate& date = contentsInfo.modificationDatetimeUTC;
+    snprintf(buff, sizeof(buff), "%04d%02d%02dT%02d%02d%02d.%03d", date.year, date.month, date.day, date.hour, date.minute, date.sec, date.msec);
+    std::string captured(buff);
+    snprintf(buff, sizeof(buff), "%d/%u/%u", (int)slotNumber, contentsInfo.contentId, (unsigned)contentsFile.fileId);
+    std::string key = ThumbnailCache::make_key(content_cache_serial(), thumbnail ? "T" : "S", buff, captured);
+
+    std::vector<CrInt8u> image;
+    CrInt32u fileType = 0;
+    if (thumbnail_cache().lookup(key, image, fileType)) {
+        tout << (thumbnail ? "Thumbnail" : "Screennail") << " from cache\n";
+    }
+    else {
+        CallbackTransferSink sink([&](const CrInt8u* data, CrInt64u size) {
+            image.insert(image.end(), data, data + size);
+            return true;
+        });
+        if (!get_remote_transfer_compresseddata_to_sink(slotNumber, contentsInfo.contentId, contentsFile.fileId, type, sink) || image.empty()) {
+            return false;
+        }
+        // The transfer does not report a type; only JPEG data is recognised and cached
+        if (image.size() >= 2 && image[0] == 0xFF && image[1] == 0xD8) {
+            fileType = SDK::CrFileType_Jpeg;
+        }
+        if (fileType != SDK::CrFileType_None) {
+            thumbnail_cache().insert(key, image.data(), image.size(), fileType);
         }
     }
-    else
-    {
-        if (0 < image_data->GetSize() && fileType != SDK::CrFileType_None)
-        {
-            text filename(TEXT("Thumbnail.JPG"));
-            if (fileType == SDK::CrFileType_Heif) {
-                filename= (TEXT("Thumbnail.HIF"));
+
+    const std::string filePath = contentsFile.filePath;
+    std::string fileName = filePath.substr(filePath.find_last_of('/') + 1);
+    fileName = fileName.substr(0, fileName.find_last_of('.')) + (thumbnail ? "_Thumbnail.JPG" : "_Screennail.JPG");
+    fs::path path = fs::current_path();
+    path.append(fileName);
+    std::ofstream file(path, std::ios::out | std::ios::binary);
+    if (file.bad()) {
+        return false;
+    }
+    file.write((char*)image.data(), image.size());
+    file.close();
+    tout << "File =" << path.native().c_str() << std::endl;
+    return true;
+}
+
+void CameraDevice::getThumbnail(SDK::CrMtpContentsInfo const& contentInfo)
+{
+    SDK::CrContentHandle content = contentInfo.handle;
+    std::string key = thumbnail_cache_key(contentInfo);
+    std::vector<CrInt8u> image;
+    CrInt32u fileType = SDK::CrFileType_None;
+    if (thumbnail_cache().lookup(key, image, fileType)) {
+        tout << "Thumbnail from cache\n";
+    }
+    else {
+        SDK::CrError err = SDK::CrError_None;
+        if (!fetch_thumbnail(content, image, fileType, err)) {
+            if (CR_FAILED(err)) {
+                text id(this->get_id());
+                text msg = get_message_desc(err);
+                if (!msg.empty()) {
+                    // output is 2 line
+                    tout << std::endl << msg.data() << ", handle=" << std::hex << content << std::dec << std::endl;
+                    tout << m_info->GetModel() << " (" << id.data() << ")" << std::endl;
+                }
             }
+            return;
+        }
+        thumbnail_cache().insert(key, image.data(), image.size(), fileType);
+    }
+
+    text filename(TEXT("Thumbnail.JPG"));
+    if (fileType == SDK::CrFileType_Heif) {
+        filename= (TEXT("Thumbnail.HIF"));
+    }
 
 #if defined(__APPLE__)
-            char path[MAC_MAX_PATH]; /*MAX_PATH*/
-            memset(path, 0, sizeof(path));
-            if(NULL == getcwd(path, sizeof(path) - 1)){
-                // FAILED
-                delete[] image_buff; // Release
-                delete image_data; // Release
-                tout << "Folder path is too long.\n";
-                return;
-            };
-            const char* delimit = "/";
-            if(strlen(path) + strlen(delimit) + filename.length() > MAC_MAX_PATH){
-                // FAILED
-                delete[] image_buff; // Release
-                delete image_data; // Release
-                tout << "Failed to create save path\n";
-                return;
-            }
-            strncat(path, delimit, strlen(delimit));
-            strncat(path, (CrChar*)filename.c_str(), filename.length());
+    char path[MAC_MAX_PATH]; /*MAX_PATH*/
+    memset(path, 0, sizeof(path));
+    if(NULL == getcwd(path, sizeof(path) - 1)){
+        // FAILED
+        tout << "Folder path is too long.\n";
+        return;
+    };
+    const char* delimit = "/";
+    if(strlen(path) + strlen(delimit) + filename.length() > MAC_MAX_PATH){
+        // FAILED
+        tout << "Failed to create save path\n";
+        return;
+    }
+    strncat(path, delimit, strlen(delimit));
+    strncat(path, (CrChar*)filename.c_str(), filename.length());
 #else
-            auto path = fs::current_path();
-            path.append(filename);
+    auto path = fs::current_path();
+    path.append(filename);
 #endif
-            tout << path << '\n';
+    tout << path << '\n';
 
-            std::ofstream file(path, std::ios::out | std::ios::binary);
-            if (!file.bad())
-            {
-                std::uint32_t len = image_data->GetImageSize();
-                file.write((char*)image_data->GetImageData(), len);
-                file.close();
-            }
-        }
+    std::ofstream file(path, std::ios::out | std::ios::binary);
+    if (!file.bad())
+    {
+        file.write((char*)image.data(), image.size());
+        file.close();
     }
-    delete[] image_buff; // Release
-    delete image_data; // Release
 }
 
 text CameraDevice::format_display_string_type(SDK::CrDisplayStringType type) {
@@ -7942,6 +8143,7 @@ void CameraDevice::get_remote_transfer_contentsdata()
         tout << "[3] Get Screennail Data\n";
         tout << "[4] Show Detail Info\n";
         tout << "[5] Delete\n";
+        tout << "[6] Get Contents Data (in memory, with XXH64)\n";
         tout << "[-1] Cancel input\n";
         tout << "input> ";
         std::getline(tin, input);
@@ -7950,13 +8152,10 @@ void CameraDevice::get_remote_transfer_contentsdata()
 
         SDK::CrContentsInfo contentsInfo = m_contentsInfoList[slotIndex][indexList[contents_indo_list_index].first];
         SDK::CrContentsFile contentsFile = m_contentsInfoList[slotIndex][indexList[contents_indo_list_index].first].files[indexList[contents_indo_list_index].second];
+        CrInt32u divisionSize = 0;
+        auto start = std::chrono::steady_clock::now();
         if( selected_index == 1 ) {
-            CrInt32u divisionSize = 0x5000000; // 80MB (80 * 1024 * 1024)
-#if defined(__linux__)
-            if (m_conn_type == ConnectionType::USB) { // When connected USB
-                divisionSize = 0x1000000; // 16MB (16 * 1024 * 1024)
-            }
-#endif
+            divisionSize = get_remote_transfer_division_size();
             ret = SDK::GetRemoteTransferContentsDataFile(m_device_handle, slotNumber, contentsInfo.contentId, contentsFile.fileId,
                     divisionSize, nullptr, nullptr);
             if( ret != SDK::CrError_None ) {
@@ -7965,17 +8164,13 @@ void CameraDevice::get_remote_transfer_contentsdata()
                 return;
             }
         }else if( selected_index == 2 ) {
-            ret = SDK::GetRemoteTransferContentsCompressedDataFile(m_device_handle, slotNumber, contentsInfo.contentId, contentsFile.fileId, 
-                    SDK::CrGetContentsCompressedDataType_Thumbnail, nullptr, nullptr);
-            if( ret != SDK::CrError_None ) {
+            if( !get_remote_transfer_compresseddata_cached(slotNumber, contentsInfo, contentsFile, SDK::CrGetContentsCompressedDataType_Thumbnail) ) {
                 tout << "Get Thumbnail Data fail.\n";
                 m_getContentsDataStartFlg = false;
                 return;
             }
         }else if( selected_index == 3 ) {
-            ret = SDK::GetRemoteTransferContentsCompressedDataFile(m_device_handle, slotNumber, contentsInfo.contentId, contentsFile.fileId, 
-                    SDK::CrGetContentsCompressedDataType_Screennail, nullptr, nullptr);
-            if( ret != SDK::CrError_None ) {
+            if( !get_remote_transfer_compresseddata_cached(slotNumber, contentsInfo, contentsFile, SDK::CrGetContentsCompressedDataType_Screennail) ) {
                 tout << "Get Screennail Data fail.\n";
                 m_getContentsDataStartFlg = false;
                 return;
@@ -7989,6 +8184,34 @@ void CameraDevice::get_remote_transfer_contentsdata()
                 m_getContentsDataStartFlg = false;
                 return;
             }
+        }else if( selected_index == 6 ) {
+            const std::string filePath = contentsFile.filePath;
+            const std::string fileName = filePath.substr(filePath.find_last_of('/') + 1);
+            fs::path path = fs::current_path();
+            path.append(fileName);
+
+            FileTransferSink fileSink(path.native());
+            HashTransferSink hashSink;
+            TeeTransferSink sink({&fileSink, &hashSink});
+            if (get_remote_transfer_contentsdata_to_sink(slotNumber, contentsInfo.contentId, contentsFile.fileId,
+                    contentsFile.fileSize, get_remote_transfer_division_size(), sink)) {
+                double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                tout << "Get Contents Data OK\n";
+                tout << "File =" << path.native().c_str() << std::endl;
+                static const bool hashOk = HashTransferSink::self_test();
+                if (hashOk) {
+                    tout << "XXH64 =" << hashSink.digest_string().c_str() << std::endl;
+                }
+                else {
+                    tout << "XXH64 self-test failed, no hash shown\n";
+                }
+                if (sec > 0) {
+                    tout << "Rate =" << (contentsFile.fileSize / (1024.0 * 1024.0) / sec) << " MB/s" << std::endl;
+                }
+            }
+            else {
+                tout << "Get Contents Data NG\n";
+            }
         }else{
             tout << "Input cancelled.\n";
             release_contents_info(slotIndex);
@@ -8001,7 +8224,7 @@ void CameraDevice::get_remote_transfer_contentsdata()
         if (selected_index == 5) {
             return;
         }
-        else if (selected_index != 4) {
+        else if (selected_index == 1) {
             tout << "Start Get Contents Data...\n";
         
             std::unique_lock<std::mutex> lock(m_getContentsDataMtx);
@@ -8013,6 +8236,10 @@ void CameraDevice::get_remote_transfer_contentsdata()
                     tout << "Get Contents Data OK\n";
                     tout << "File =" << m_getContentsData_fileName.c_str() << std::endl;
                     m_lockgetContentsData.unlock();
+                    if (divisionSize != 0) {
+                        double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                        record_remote_transfer_rate(divisionSize, contentsFile.fileSize, contentsFile.fileSize / (1024.0 * 1024.0) / sec);
+                    }
                     break;
                 }
                 else if (m_getContentsData_notify == SDK::CrNotify_RemoteTransfer_Result_NG ||
@@ -8514,75 +8741,27 @@ void CameraDevice::execute_movie_rec_and_get_contentsdata()
     }
 
     tout << "Get ContentsInfoList InProgress.\n";
-    // Waiting for DP update
-    std::this_thread::sleep_for(2s);
-    load_properties();
-
-    SDK::CrSlotNumber slotNumber;
-    CrInt32u getCode;
-    if(m_prop.movie_recording_media.current == SDK::CrRecordingMedia_Slot2) {
-        slotNumber = SDK::CrSlotNumber_Slot2;
-        getCode = SDK::CrDevicePropertyCode::CrDeviceProperty_MediaSLOT2_ContentsInfoListUpdateTime;
-    }else{
-        slotNumber = SDK::CrSlotNumber_Slot1;
-        getCode = SDK::CrDevicePropertyCode::CrDeviceProperty_MediaSLOT1_ContentsInfoListUpdateTime;
-    }
-
-    int slotIndex;
-    slotIndex = slotNumber - 1;
-    release_contents_info(slotIndex);
-
-    std::int32_t nprop = 0;
-    SDK::CrDeviceProperty* prop_list = nullptr;
-    SDK::CrError ret = SDK::GetSelectDeviceProperties(m_device_handle, 1, &getCode, &prop_list, &nprop);
-    if (CR_FAILED(ret) || (0 == nprop)) {
-        tout << "Get ContentsInfoListUpdateTime fail.\n";
-        m_getContentsDataStartFlg = false;
-        return;
-    }
-
-    CrInt64u contentsInfoListUpdateTime = prop_list[0].GetCurrentValue();
-    SDK::ReleaseDeviceProperties(m_device_handle, prop_list);
-
-    SDK::CrCaptureDate dummyCaptureDate;
-    CrInt32u contentsInfoListNum;
-    ret = SDK::GetRemoteTransferContentsInfoList(m_device_handle, slotNumber, SDK::CrGetContentsInfoListType_All, 
-        &dummyCaptureDate, 0, &m_contentsInfoList[slotIndex], &contentsInfoListNum);
-    if( (ret != SDK::CrError_None) || (contentsInfoListNum == 0) ) {
-        release_contents_info(slotIndex);
-        tout << "Get ContentsInfoList fail.\n";
-        m_getContentsDataStartFlg = false;
-        return;
-    }
-
-    SDK::CrContentsInfo targetContentsInfo;
-    SDK::CrCaptureDate contentsInfoListUpdateCaptureDate(contentsInfoListUpdateTime);
-    for(CrInt32u i = 0;i < contentsInfoListNum;i++) {
-        if( m_contentsInfoList[slotIndex][i].modificationDatetimeUTC == contentsInfoListUpdateCaptureDate ) {
-            targetContentsInfo = m_contentsInfoList[slotIndex][i];
-            break;
-        }
-    }
+    SDK::CrSlotNumber slotNumber = (m_getContentsData_slot == SDK::CrSlotNumber_Slot2) ? SDK::CrSlotNumber_Slot2 : SDK::CrSlotNumber_Slot1;
+    CrInt32u addSize = (m_getContentsData_addSize != 0) ? m_getContentsData_addSize : 1;
 
-    if( targetContentsInfo.contentId == 0 ) {
-        release_contents_info(slotIndex);
+    std::vector<RemoteTransferFile> files;
+    if( !get_remote_transfer_added_files(slotNumber, addSize, files) || files.empty() ) {
         tout << "Target contents not found.\n";
         m_getContentsDataStartFlg = false;
         return;
     }
 
     tout << "Get Contents Data InProgress.\n";
-    CrInt32u divisionSize = 0x5000000; // 80MB (80 * 1024 * 1024)
-#if defined(__linux__)
-    if (m_conn_type == ConnectionType::USB) { // When connected USB
-        divisionSize = 0x1000000; // 16MB (16 * 1024 * 1024)
-    }
-#endif
-    for(CrInt32u i = 0;i < targetContentsInfo.filesNum;i++) {
-        ret = SDK::GetRemoteTransferContentsDataFile(m_device_handle, slotNumber, targetContentsInfo.contentId, targetContentsInfo.files[i].fileId, 
+    for(CrInt32u i = 0;i < files.size();i++) {
+        // Per file, so the tuner can try another candidate on the next one
+        CrInt32u divisionSize = get_remote_transfer_division_size();
+        auto start = std::chrono::steady_clock::now();
+        SDK::CrError ret = SDK::GetRemoteTransferContentsDataFile(m_device_handle, slotNumber, files[i].contentId, files[i].fileId, 
             divisionSize, nullptr, nullptr);
         if( ret != SDK::CrError_None ) {
-            tout << "Get Contents Data fail.\n";
+            log_warn("get contents data failed").kv("camera", get_id()).kv_hex("content", files[i].contentId)
+                .kv_hex("error", ret);
+            continue;
         }
 
         while(1) {
@@ -8592,6 +8771,8 @@ void CameraDevice::execute_movie_rec_and_get_contentsdata()
                 tout << "Get Contents Data OK\n";
                 tout << "File =" << m_getContentsData_fileName.c_str() << std::endl;
                 m_lockgetContentsData.unlock();
+                double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                record_remote_transfer_rate(divisionSize, files[i].fileSize, files[i].fileSize / (1024.0 * 1024.0) / sec);
                 break;
             }else if( m_getContentsData_notify == SDK::CrNotify_RemoteTransfer_Result_NG ||
                       m_getContentsData_notify == SDK::CrNotify_RemoteTransfer_Result_DeviceBusy ) {
@@ -8606,10 +8787,326 @@ void CameraDevice::execute_movie_rec_and_get_contentsdata()
     }
 
     m_getContentsDataStartFlg = false;
-    release_contents_info(slotIndex);
     return;
 }
 
+static TransferTuner& remote_transfer_tuner()
+{
+    static TransferTuner tuner((fs::current_path() / "RemoteTransferTuning.txt").native());
+    return tuner;
+}
+
+static text remote_transfer_tuning_key(SDK::ICrCameraObjectInfo* info, ConnectionType type)
+{
+    return text(info->GetModel()) + (type == ConnectionType::USB ? TEXT(" USB") : TEXT(" Network"));
+}
+
+static std::vector<CrInt32u> remote_transfer_division_candidates(ConnectionType type)
+{
+#if defined(__linux__)
+    if (type == ConnectionType::USB) { // When connected USB, usbfs limits a request to 16MB
+        return { 0x400000, 0x800000, 0x1000000 }; // 4MB, 8MB, 16MB
+    }
+#endif
+    return { 0x1000000, 0x2000000, 0x4000000, 0x5000000 }; // 16MB, 32MB, 64MB, 80MB
+}
+
+CrInt32u CameraDevice::get_remote_transfer_division_size() const
+{
+    return remote_transfer_tuner().division_size(remote_transfer_tuning_key(m_info, m_conn_type),
+                                                 remote_transfer_division_candidates(m_conn_type));
+}
+
+void CameraDevice::record_remote_transfer_rate(CrInt32u divisionSize, CrInt64u fileSize, double mbps) const
+{
+    // A file shorter than two divisions mostly measures the request latency
+    if (fileSize < (CrInt64u)divisionSize * 2 || mbps <= 0.0) {
+        return;
+    }
+    text key = remote_transfer_tuning_key(m_info, m_conn_type);
+    auto candidates = remote_transfer_division_candidates(m_conn_type);
+    bool wasSettled = remote_transfer_tuner().settled(key, candidates);
+    remote_transfer_tuner().record(key, divisionSize, mbps);
+    tout << "Division " << (divisionSize >> 20) << "MB: " << mbps << " MB/s\n";
+    if (!wasSettled && remote_transfer_tuner().settled(key, candidates)) {
+        tout << "Division size settled at " << (remote_transfer_tuner().division_size(key, candidates) >> 20) << "MB for " << key << '\n';
+    }
+}
+
+bool CameraDevice::get_remote_transfer_contentsdata_to_sink(SDK::CrSlotNumber slotNumber, CrInt32u contentsId, CrInt32u fileId,
+                                                            CrInt64u fileSize, CrInt32u divisionSize, RemoteTransferSink& sink, bool showProgress)
+{
+    double mbps = 0.0;
+    bool ok = transfer_to_sink([&]() {
+        return SDK::GetRemoteTransferContentsData(m_device_handle, slotNumber, contentsId, fileId, divisionSize);
+    }, fileSize, sink, showProgress, mbps);
+    if (ok) {
+        record_remote_transfer_rate(divisionSize, fileSize, mbps);
+    }
+    return ok;
+}
+
+bool CameraDevice::get_remote_transfer_compresseddata_to_sink(SDK::CrSlotNumber slotNumber, CrInt32u contentsId, CrInt32u fileId,
+                                                              SDK::CrGetContentsCompressedDataType type, RemoteTransferSink& sink)
+{
+    double mbps = 0.0;
+    return transfer_to_sink([&]() {
+        return SDK::GetRemoteTransferContentsCompressedData(m_device_handle, slotNumber, contentsId, fileId, type);
+    }, 0, sink, false, mbps);
+}
+
+bool CameraDevice::cancel_remote_transfer(CrInt32u belowPercent)
+{
+    std::lock_guard<std::mutex> lock(m_transferMtx);
+    if (nullptr == m_transferSink || m_transferDone || m_transferFailed || m_transferPer >= belowPercent) {
+        return false;
+    }
+    // The waiting thread issues the cancel, the same way as for a failed sink
+    m_transferFailed = true;
+    m_transferCv.notify_all();
+    return true;
+}
+
+bool CameraDevice::transfer_to_sink(std::function<SDK::CrError()> request, CrInt64u fileSize, RemoteTransferSink& sink,
+                                    bool showProgress, double& mbps)
+{
+    if (!sink.begin(fileSize)) {
+        sink.end(false);
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_transferMtx);
+        m_transferSink = &sink;
+        m_transferOffset = 0;
+        m_transferPer = 0;
+        m_transferResult = 0;
+        m_transferDone = false;
+        m_transferFailed = false;
+        m_transferFirstBytes = 0;
+        m_transferLastData = std::chrono::steady_clock::now();
+    }
+
+    auto started = std::chrono::steady_clock::now();
+    SDK::CrError ret = request();
+    if (ret != SDK::CrError_None) {
+        device_metrics().transferFailures.inc();
+        log_warn("get contents data failed").kv("camera", get_id()).kv_hex("error", ret);
+        {
+            std::lock_guard<std::mutex> lock(m_transferMtx);
+            m_transferSink = nullptr;
+        }
+        sink.end(false);
+        return false;
+    }
+
+    std::unique_lock<std::mutex> lock(m_transferMtx);
+    bool cancelRequested = false;
+    std::chrono::steady_clock::time_point cancelDeadline;
+    CrInt32u lastPer = 0;
+    while (!m_transferDone && m_connected) {
+        m_transferCv.wait_for(lock, std::chrono::seconds(1));
+        if (m_transferDone) {
+            break;
+        }
+        auto now = std::chrono::steady_clock::now();
+        if (!m_transferFailed && now - m_transferLastData > transfer_stall_timeout) {
+            log_warn("get contents data stalled").kv("camera", get_id()).kv("received", m_transferOffset);
+            m_transferFailed = true;
+        }
+        if (m_transferFailed && !cancelRequested) {
+            cancelRequested = true;
+            cancelDeadline = now + transfer_cancel_timeout;
+            lock.unlock();
+            SDK::ControlGetRemoteTransferContentsDataFile(m_device_handle, SDK::CrGetContentsDataControlType_Cancel);
+            lock.lock();
+        } else if (cancelRequested && now > cancelDeadline) {
+            log_warn("get contents data cancel not confirmed").kv("camera", get_id());
+            break;
+        }
+        if (m_transferPer != lastPer) {
+            lastPer = m_transferPer;
+            if (showProgress) {
+                log_info("get contents data in progress").kv("camera", get_id()).kv("percent", lastPer);
+            }
+        }
+    }
+
+    bool ok = m_transferDone && !m_transferFailed && (m_transferResult == SDK::CrNotify_RemoteTransfer_Result_OK)
+        && (fileSize == 0 || m_transferOffset == fileSize);
+    m_transferSink = nullptr;
+    // Rate from the division arrivals, leaving out the latency before the first one
+    double sec = std::chrono::duration<double>(m_transferLastData - m_transferFirstData).count();
+    mbps = (ok && sec > 0) ? (m_transferOffset - m_transferFirstBytes) / (1024.0 * 1024.0) / sec : 0.0;
+    CrInt64u received = m_transferOffset;
+    lock.unlock();
+    sink.end(ok);
+
+    DeviceMetrics& dm = device_metrics();
+    dm.transferSeconds.observe(std::chrono::steady_clock::now() - started);
+    dm.transferBytes.inc(received);
+    if (ok) dm.transferRate.set((std::int64_t)(mbps * 1024.0));
+    else dm.transferFailures.inc();
+    return ok;
+}
+
+bool CameraDevice::get_remote_transfer_file_list(SDK::CrSlotNumber slotNumber, std::vector<RemoteTransferFile>& files)
+{
+    // A list of its own, so the interactive m_contentsInfoList is left alone
+    SDK::CrCaptureDate dummyCaptureDate;
+    SDK::CrContentsInfo* contentsInfoList = nullptr;
+    CrInt32u contentsInfoListNum = 0;
+    SDK::CrError ret = SDK::GetRemoteTransferContentsInfoList(m_device_handle, slotNumber, SDK::CrGetContentsInfoListType_All,
+        &dummyCaptureDate, 0, &contentsInfoList, &contentsInfoListNum);
+    if (ret != SDK::CrError_None) {
+        return false;
+    }
+    for (CrInt32u i = 0; i < contentsInfoListNum; i++) {
+        for (CrInt32u j = 0; j < contentsInfoList[i].filesNum; j++) {
+            SDK::CrContentsFile& file = contentsInfoList[i].files[j];
+            RemoteTransferFile entry;
+            entry.slotNumber = slotNumber;
+            entry.contentId = contentsInfoList[i].contentId;
+            entry.fileId = file.fileId;
+            entry.fileSize = file.fileSize;
+            entry.fileFormat = file.fileFormat;
+            entry.filePath = file.filePath ? std::string(file.filePath) : std::string();
+            files.push_back(entry);
+        }
+    }
+    if (contentsInfoList) {
+        SDK::ReleaseRemoteTransferContentsInfoList(m_device_handle, contentsInfoList);
+    }
+    return true;
+}
+
+static void append_remote_transfer_files(SDK::CrSlotNumber slotNumber, SDK::CrContentsInfo& info, std::vector<RemoteTransferFile>& files)
+{
+    for (CrInt32u j = 0; j < info.filesNum; j++) {
+        RemoteTransferFile entry;
+        entry.slotNumber = slotNumber;
+        entry.contentId = info.contentId;
+        entry.fileId = info.files[j].fileId;
+        entry.fileSize = info.files[j].fileSize;
+        entry.fileFormat = info.files[j].fileFormat;
+        entry.filePath = info.files[j].filePath ? std::string(info.files[j].filePath) : std::string();
+        files.push_back(entry);
+    }
+}
+
+bool CameraDevice::get_remote_transfer_added_files(SDK::CrSlotNumber slotNumber, CrInt32u addSize, std::vector<RemoteTransferFile>& files)
+{
+    int slotIndex = (slotNumber == SDK::CrSlotNumber_Slot2) ? 1 : 0;
+    std::set<CrInt32u>& ingested = m_ingestedContents[slotIndex];
+
+    // First time for this slot: everything already on the media counts as seen,
+    // except the newest addSize contents this notification is about
+    if (!m_ingestedSeeded[slotIndex]) {
+        SDK::CrCaptureDate dummyCaptureDate;
+        SDK::CrContentsInfo* contentsInfoList = nullptr;
+        CrInt32u contentsInfoListNum = 0;
+        SDK::CrError ret = SDK::GetRemoteTransferContentsInfoList(m_device_handle, slotNumber, SDK::CrGetContentsInfoListType_All,
+            &dummyCaptureDate, 0, &contentsInfoList, &contentsInfoListNum);
+        if (ret != SDK::CrError_None) {
+            tout << "Get ContentsInfoList fail.\n";
+            return false;
+        }
+        std::vector<CrInt32u> order;
+        for (CrInt32u i = 0; i < contentsInfoListNum; i++) {
+            order.push_back(i);
+        }
+        std::sort(order.begin(), order.end(), [&](CrInt32u a, CrInt32u b) {
+            return contentsInfoList[a].contentId < contentsInfoList[b].contentId;
+        });
+        size_t first = order.size() > addSize ? order.size() - addSize : 0;
+        for (size_t k = 0; k < order.size(); k++) {
+            SDK::CrContentsInfo& info = contentsInfoList[order[k]];
+            ingested.insert(info.contentId);
+            if (k >= first) append_remote_transfer_files(slotNumber, info, files);
+        }
+        if (contentsInfoList) SDK::ReleaseRemoteTransferContentsInfoList(m_device_handle, contentsInfoList);
+        m_ingestedSeeded[slotIndex] = true;
+        return true;
+    }
+
+    CrInt32u getCode = (slotNumber == SDK::CrSlotNumber_Slot2)
+        ? SDK::CrDevicePropertyCode::CrDeviceProperty_MediaSLOT2_ContentsInfoListUpdateTime
+        : SDK::CrDevicePropertyCode::CrDeviceProperty_MediaSLOT1_ContentsInfoListUpdateTime;
+
+    // The update time can lag the notification; poll just that property until it moves
+    CrInt64u updateTime = 0;
+    for (int retry = 0; retry < 30; retry++) {
+        std::int32_t nprop = 0;
+        SDK::CrDeviceProperty* prop_list = nullptr;
+        SDK::CrError ret = SDK::GetSelectDeviceProperties(m_device_handle, 1, &getCode, &prop_list, &nprop);
+        if (CR_SUCCEEDED(ret) && (0 < nprop)) {
+            updateTime = prop_list[0].GetCurrentValue();
+            SDK::ReleaseDeviceProperties(m_device_handle, prop_list);
+            if (updateTime != 0 && updateTime != m_contentsListUpdateTime[slotIndex]) {
+                break;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    if (updateTime == 0) {
+        tout << "Get ContentsInfoListUpdateTime fail.\n";
+        return false;
+    }
+    if (updateTime == m_contentsListUpdateTime[slotIndex]) {
+        // Listed after this update already; a late notification whose contents
+        // went out with an earlier one
+        return true;
+    }
+    m_contentsListUpdateTime[slotIndex] = updateTime;
+
+    // Ask for the hour of the update first and only widen the range if it does
+    // not hold addSize unseen contents, instead of listing the whole media every
+    // time. Every unseen content in the range is taken, not just the newest
+    // addSize, so notifications that queued up behind a slow one lose nothing.
+    SDK::CrCaptureDate updateDate(updateTime);
+    const SDK::CrGetContentsInfoListType ranges[] = {
+        SDK::CrGetContentsInfoListType_Range_Hour,
+        SDK::CrGetContentsInfoListType_Range_Day,
+        SDK::CrGetContentsInfoListType_All,
+    };
+    for (auto range : ranges) {
+        SDK::CrContentsInfo* contentsInfoList = nullptr;
+        CrInt32u contentsInfoListNum = 0;
+        SDK::CrError ret = SDK::GetRemoteTransferContentsInfoList(m_device_handle, slotNumber, range,
+            &updateDate, 0, &contentsInfoList, &contentsInfoListNum);
+        if (ret != SDK::CrError_None) {
+            continue;
+        }
+
+        std::vector<CrInt32u> added;
+        for (CrInt32u i = 0; i < contentsInfoListNum; i++) {
+            if (ingested.count(contentsInfoList[i].contentId) == 0) added.push_back(i);
+        }
+        if (added.size() >= addSize || range == SDK::CrGetContentsInfoListType_All) {
+            // Oldest first
+            std::sort(added.begin(), added.end(), [&](CrInt32u a, CrInt32u b) {
+                return contentsInfoList[a].contentId < contentsInfoList[b].contentId;
+            });
+            for (CrInt32u i : added) {
+                ingested.insert(contentsInfoList[i].contentId);
+                append_remote_transfer_files(slotNumber, contentsInfoList[i], files);
+            }
+            if (contentsInfoList) SDK::ReleaseRemoteTransferContentsInfoList(m_device_handle, contentsInfoList);
+            return true;
+        }
+        if (contentsInfoList) SDK::ReleaseRemoteTransferContentsInfoList(m_device_handle, contentsInfoList);
+    }
+    tout << "Get ContentsInfoList fail.\n";
+    return false;
+}
+
+void CameraDevice::forget_remote_transfer_contents(SDK::CrSlotNumber slotNumber)
+{
+    int slotIndex = (slotNumber == SDK::CrSlotNumber_Slot2) ? 1 : 0;
+    m_ingestedContents[slotIndex].clear();
+    m_ingestedSeeded[slotIndex] = false;
+    m_contentsListUpdateTime[slotIndex] = 0;
+}
+
 void CameraDevice::show_contents_data_detail(SCRSDK::CrContentsInfo& contentsInfo, SCRSDK::CrContentsFile& contentsFile)
 {
     tout << std::endl;
@@ -14,19 +14,37 @@ typedef int errno_t;
 #endif
 
 #include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <condition_variable>
+#include <functional>
 #include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
 #include "CameraRemote_SDK.h"
 #include "IDeviceCallback.h"
 #include "ConnectionInfo.h"
 #include "PropertyValueTable.h"
 #include "Text.h"
 #include "MessageDefine.h"
+#include "RemoteTransferSink.h"
 
 namespace cli
 {
 
+// One file of a remote transfer contents list, copied out of the SDK-owned list
+struct RemoteTransferFile
+{
+    SCRSDK::CrSlotNumber slotNumber;
+    CrInt32u contentId;
+    CrInt32u fileId;
+    CrInt64u fileSize;
+    CrInt32u fileFormat; // SCRSDK::CrContentsFile_FileFormat
+    std::string filePath; // path on the media, e.g. /PRIVATE/M4ROOT/CLIP/C0001.MP4
+};
+
 class CRFolderInfos
 {
 public:
@@ -229,7 +247,9 @@ public:
     void getFileNames(std::vector<text> &file_names);
     void pullContents(SCRSDK::CrContentHandle content);
     void getScreennail(SCRSDK::CrContentHandle content);
-    void getThumbnail(SCRSDK::CrContentHandle content);
+    void getThumbnail(SCRSDK::CrMtpContentsInfo const& contentInfo);
+    void start_thumbnail_prefetch();
+    void stop_thumbnail_prefetch();
 
     SCRSDK::CrSdkControlMode get_sdkmode();
 
@@ -251,6 +271,25 @@ public:
     void show_contents_data_detail(SCRSDK::CrContentsInfo& contentsInfo, SCRSDK::CrContentsFile& contentsFile);
     void release_contents_info(int slotIndex);
     void execute_movie_rec_and_get_contentsdata();
+    bool get_remote_transfer_contentsdata_to_sink(SCRSDK::CrSlotNumber slotNumber, CrInt32u contentsId, CrInt32u fileId,
+                                                  CrInt64u fileSize, CrInt32u divisionSize, RemoteTransferSink& sink, bool showProgress = true);
+    bool get_remote_transfer_compresseddata_to_sink(SCRSDK::CrSlotNumber slotNumber, CrInt32u contentsId, CrInt32u fileId,
+                                                    SCRSDK::CrGetContentsCompressedDataType type, RemoteTransferSink& sink);
+    // Cancel the in-memory transfer in flight unless it is already past belowPercent
+    bool cancel_remote_transfer(CrInt32u belowPercent = 100);
+    bool get_remote_transfer_file_list(SCRSDK::CrSlotNumber slotNumber, std::vector<RemoteTransferFile>& files);
+    // Files of every content on the slot not returned before; on the first call,
+    // of the newest addSize contents
+    bool get_remote_transfer_added_files(SCRSDK::CrSlotNumber slotNumber, CrInt32u addSize, std::vector<RemoteTransferFile>& files);
+    // After the slot's contents were cleared, content ids may be reused
+    void forget_remote_transfer_contents(SCRSDK::CrSlotNumber slotNumber);
+    // Called on the SDK callback thread from OnNotifyRemoteTransferContentsListChanged; keep it short
+    using ContentsListListener = std::function<void(CrInt32u notify, CrInt32u slotNumber, CrInt32u addSize)>;
+    void set_contents_list_listener(ContentsListListener listener);
+    CrInt32u get_remote_transfer_division_size() const;
+    void record_remote_transfer_rate(CrInt32u divisionSize, CrInt64u fileSize, double mbps) const;
+    bool transfer_to_sink(std::function<SCRSDK::CrError()> request, CrInt64u fileSize, RemoteTransferSink& sink,
+                          bool showProgress, double& mbps);
 
     // RemoteFirmwareUpdate Mode
     void get_firmware_version();
@@ -311,6 +350,11 @@ private:
     text format_dispstrlist(SCRSDK::CrDisplayStringListInfo list);
     text format_display_string_type(SCRSDK::CrDisplayStringType type);
     void check_monitoringstatus();
+    std::string content_cache_serial();
+    std::string thumbnail_cache_key(SCRSDK::CrMtpContentsInfo const& content);
+    bool get_remote_transfer_compresseddata_cached(SCRSDK::CrSlotNumber slotNumber, SCRSDK::CrContentsInfo& contentsInfo,
+                                                   SCRSDK::CrContentsFile& contentsFile, SCRSDK::CrGetContentsCompressedDataType type);
+    bool fetch_thumbnail(SCRSDK::CrContentHandle content, std::vector<CrInt8u>& image, CrInt32u& fileType, SCRSDK::CrError& err);
 
 private:
     std::int32_t m_number;
@@ -343,12 +387,35 @@ private:
     std::mutex m_lockgetContentsData;
     CrInt32u m_getContentsData_notify;
     CrInt32u m_getContentsData_per;
+    CrInt32u m_getContentsData_slot;
+    CrInt32u m_getContentsData_addSize;
+    std::mutex m_contentsListMtx;
+    ContentsListListener m_contentsListListener;
+    CrInt64u m_contentsListUpdateTime[2]; // last ContentsInfoListUpdateTime seen per slot
+    std::set<CrInt32u> m_ingestedContents[2]; // content ids already returned as added, per slot
+    bool m_ingestedSeeded[2];
 
 #if defined(_UNICODE) || defined(UNICODE)
     std::wstring m_getContentsData_fileName;
 #else
     std::string m_getContentsData_fileName;
 #endif
+    // In-memory remote transfer (GetRemoteTransferContentsData)
+    std::mutex m_transferMtx;
+    std::condition_variable m_transferCv;
+    RemoteTransferSink* m_transferSink;
+    CrInt64u m_transferOffset;
+    CrInt32u m_transferPer;
+    CrInt32u m_transferResult;
+    bool m_transferDone;
+    bool m_transferFailed;
+    CrInt64u m_transferFirstBytes; // size of the first division, excluded from the rate
+    std::chrono::steady_clock::time_point m_transferFirstData;
+    std::chrono::steady_clock::time_point m_transferLastData;
+    // Thumbnail cache
+    std::mutex m_thumbnailMtx; // one GetContentsThumbnailImage at a time
+    std::thread m_thumbnailPrefetch;
+    std::atomic<bool> m_thumbnailPrefetchStop;
     std::mutex m_dispCameraKeyMutex;
     std::condition_variable m_dispCameraKeyCV;
 
@@ -1,38 +1,119 @@
-#include <unordered_map>
+#include <array>
+#include <algorithm>
+#include <cstddef>
 #include <string>
+#include <string_view>
 #include <CrDefines.h>
 #include "CrDebugString.h"
 
-static std::string getMapString(const std::unordered_map<CrInt32, std::string>* _map, CrInt32 code)
+// Each enum table is a constexpr array of {code, name} pairs that is sorted
+// twice at compile time (by code and by name), so both directions are a
+// binary search and nothing is allocated at static-init time.
+
+struct CrEnumName
+{
+	CrInt32 code;
+	std::string_view name;
+
+	constexpr CrEnumName() : code(0), name() {}
+	// Takes CrInt64 so that enumerators above INT32_MAX wrap like they did in the old map keys
+	constexpr CrEnumName(CrInt64 _code, std::string_view _name) : code((CrInt32)_code), name(_name) {}
+};
+
+// Type-erased view of a CrEnumTable. size == 0 means "no table".
+struct CrEnumTableRef
+{
+	const CrEnumName* byCode;
+	const CrEnumName* byName;
+	std::size_t size;
+};
+
+template <std::size_t N>
+struct CrEnumTable
+{
+	std::array<CrEnumName, N> byCode;
+	std::array<CrEnumName, N> byName;
+
+	constexpr operator CrEnumTableRef() const { return { byCode.data(), byName.data(), N }; }
+};
+
+// Stable bottom-up merge sort usable in a constant expression (std::sort is not constexpr in C++17).
+// Stability keeps the first of any duplicated code/name winning, as with the old map initializers.
+template <std::size_t N, typename Less>
+constexpr void sortEnumNames(std::array<CrEnumName, N>& a, Less less)
+{
+	std::array<CrEnumName, N> tmp{};
+	for (std::size_t width = 1; width < N; width *= 2) {
+		for (std::size_t lo = 0; lo < N; lo += 2 * width) {
+			std::size_t mid = std::min(lo + width, N);
+			std::size_t hi = std::min(lo + 2 * width, N);
+			std::size_t i = lo, j = mid, k = lo;
+			while (i < mid && j < hi) {
+				if (less(a[j], a[i])) tmp[k++] = a[j++];
+				else                  tmp[k++] = a[i++];
+			}
+			while (i < mid) tmp[k++] = a[i++];
+			while (j < hi)  tmp[k++] = a[j++];
+		}
+		for (std::size_t x = 0; x < N; x++) a[x] = tmp[x];
+	}
+}
+
+constexpr bool lessByCode(const CrEnumName& a, const CrEnumName& b) { return a.code < b.code; }
+constexpr bool lessByName(const CrEnumName& a, const CrEnumName& b) { return a.name < b.name; }
+
+template <std::size_t N>
+constexpr CrEnumTable<N> makeEnumTable(const CrEnumName (&list)[N])
+{
+	CrEnumTable<N> table{};
+	for (std::size_t i = 0; i < N; i++) {
+		table.byCode[i] = list[i];
+		table.byName[i] = list[i];
+	}
+	sortEnumNames(table.byCode, lessByCode);
+	sortEnumNames(table.byName, lessByName);
+	return table;
+}
+
+static std::string_view getMapName(CrEnumTableRef _map, CrInt32 code)
+{
+	const CrEnumName* last = _map.byCode + _map.size;
+	const CrEnumName* iter = std::lower_bound(_map.byCode, last, code,
+		[](const CrEnumName& e, CrInt32 c) { return e.code < c; });
+	if(iter == last || iter->code != code) {
+		return std::string_view();
+	}
+	return iter->name;
+}
+
+static std::string getMapString(CrEnumTableRef _map, CrInt32 code)
 {
-	if(_map == NULL) {
+	if(_map.size == 0) {
 		return "";
 	}
 
-	auto iter = _map->find(code);
-	if(iter == end(*_map)) {
+	std::string_view name = getMapName(_map, code);
+	if(name.empty()) {
 		char tmp[64] = {0};
 		snprintf(tmp, sizeof(tmp), "unknown(0x%x)", code);
 		std::string tmp2(tmp);
 		return tmp2;
 	}
-	return iter->second;
+	return std::string(name);
 }
 
-static CrInt32 getMapCode(const std::unordered_map<CrInt32, std::string>* _map, std::string name)
+static CrInt32 getMapCode(CrEnumTableRef _map, std::string_view name)
 {
-	if(_map == NULL) {
+	const CrEnumName* last = _map.byName + _map.size;
+	const CrEnumName* iter = std::lower_bound(_map.byName, last, name,
+		[](const CrEnumName& e, std::string_view n) { return e.name < n; });
+	if(iter == last || iter->name != name) {
 		return -1;
 	}
-
-	for (const auto& pair : *_map) {
-		if(pair.second == name)
-			return pair.first;
-	}
-	return -1;
+	return iter->code;
 }
 
-const std::unordered_map<CrInt32, std::string> map_CrCommandId
+constexpr CrEnumName list_CrCommandId[] =
 {
 //	{ SCRSDK::CrCommandId_\1,"\1" },
 	{ SCRSDK::CrCommandId_Release,"Release" },
@@ -78,18 +159,24 @@ const std::unordered_map<CrInt32, std::string> map_CrCommandId
 	{ SCRSDK::CrCommandId_RemoteKeyLeft,"RemoteKeyLeft" },
 	{ SCRSDK::CrCommandId_RemoteKeyRight,"RemoteKeyRight" },
 };
+constexpr auto map_CrCommandId = makeEnumTable(list_CrCommandId);
 
 std::string CrCommandIdString(SCRSDK::CrCommandId id)
 {
-	return getMapString(&map_CrCommandId, (CrInt32)id);
+	return getMapString(map_CrCommandId, (CrInt32)id);
+}
+
+std::string_view CrCommandIdName(SCRSDK::CrCommandId id)
+{
+	return getMapName(map_CrCommandId, (CrInt32)id);
 }
 
-SCRSDK::CrCommandId CrCommandIdCode(std::string name)
+SCRSDK::CrCommandId CrCommandIdCode(std::string_view name)
 {
-	return (SCRSDK::CrCommandId)getMapCode(&map_CrCommandId, name);
+	return (SCRSDK::CrCommandId)getMapCode(map_CrCommandId, name);
 }
 
-const std::unordered_map<CrInt32, std::string> map_CrDeviceProperty
+constexpr CrEnumName list_CrDeviceProperty[] =
 {
 //	{ SCRSDK::CrDeviceProperty_\1,"\1" },
 	{ SCRSDK::CrDeviceProperty_Undefined,"Undefined" },
@@ -927,18 +1014,24 @@ const std::unordered_map<CrInt32, std::string> map_CrDeviceProperty
 	{ SCRSDK::CrDeviceProperty_GuideframeDisplay, "GuideframeDisplay" },
 	{ SCRSDK::CrDeviceProperty_PullPostViewImageStatus, "PullPostViewImageStatus" },
 };
+constexpr auto map_CrDeviceProperty = makeEnumTable(list_CrDeviceProperty);
 
 std::string CrDevicePropertyString(SCRSDK::CrDevicePropertyCode code)
 {
-	return getMapString(&map_CrDeviceProperty, (CrInt32)code);
+	return getMapString(map_CrDeviceProperty, (CrInt32)code);
+}
+
+std::string_view CrDevicePropertyName(SCRSDK::CrDevicePropertyCode code)
+{
+	return getMapName(map_CrDeviceProperty, (CrInt32)code);
 }
 
-SCRSDK::CrDevicePropertyCode CrDevicePropertyCode(std::string name)
+SCRSDK::CrDevicePropertyCode CrDevicePropertyCode(std::string_view name)
 {
-	return (SCRSDK::CrDevicePropertyCode)getMapCode(&map_CrDeviceProperty, name);
+	return (SCRSDK::CrDevicePropertyCode)getMapCode(map_CrDeviceProperty, name);
 }
 
-const std::unordered_map<CrInt32, std::string> map_CrControlCode
+constexpr CrEnumName list_CrControlCode[] =
 {
 //	{ SCRSDK::CrControlCode_\1,"\1" },
 	{ SCRSDK::CrControlCode_Undefined, "Undefined" },
@@ -1013,18 +1106,24 @@ const std::unordered_map<CrInt32, std::string> map_CrControlCode
 	{ SCRSDK::CrControlCode_PresetPTZFRecall, "PresetPTZFRecall" },
 	{ SCRSDK::CrControlCode_USBConnectionModeRequest, "USBConnectionModeRequest" },
 };
+constexpr auto map_CrControlCode = makeEnumTable(list_CrControlCode);
 
 std::string CrControlCodeString(SCRSDK::CrControlCode code)
 {
-	return getMapString(&map_CrControlCode, (CrInt32)code);
+	return getMapString(map_CrControlCode, (CrInt32)code);
 }
 
-SCRSDK::CrControlCode CrControlCode(std::string name)
+std::string_view CrControlCodeName(SCRSDK::CrControlCode code)
 {
-	return (SCRSDK::CrControlCode)getMapCode(&map_CrControlCode, name);
+	return getMapName(map_CrControlCode, (CrInt32)code);
 }
 
-const std::unordered_map<CrInt32, std::string> map_CrError
+SCRSDK::CrControlCode CrControlCode(std::string_view name)
+{
+	return (SCRSDK::CrControlCode)getMapCode(map_CrControlCode, name);
+}
+
+constexpr CrEnumName list_CrError[] =
 {
 //	{ SCRSDK::CrError_\1,"\1" },
 	{ SCRSDK::CrError_None,"None" },
@@ -1347,13 +1446,19 @@ const std::unordered_map<CrInt32, std::string> map_CrError
 	{ SCRSDK::CrWarning_DisplayListChanged_Reserved30,"DisplayListChanged_Reserved30" },
 	{ SCRSDK::CrWarning_DisplayListChanged_Reserved31,"DisplayListChanged_Reserved31" },
 };
+constexpr auto map_CrError = makeEnumTable(list_CrError);
 
 std::string CrErrorString(SCRSDK::CrError error)
 {
-	return getMapString(&map_CrError, (CrInt32)error);
+	return getMapString(map_CrError, (CrInt32)error);
+}
+
+std::string_view CrErrorName(SCRSDK::CrError error)
+{
+	return getMapName(map_CrError, (CrInt32)error);
 }
 
-const std::unordered_map<CrInt32, std::string> map_CrWarningExt_AFStatusParam
+constexpr CrEnumName list_CrWarningExt_AFStatusParam[] =
 {
 	{ SCRSDK::CrWarningExt_AFStatusParam_Unlocked,"Unlocked" },
 	{ SCRSDK::CrWarningExt_AFStatusParam_Focused_AF_S,"Focused_AF_S" },
@@ -1364,8 +1469,9 @@ const std::unordered_map<CrInt32, std::string> map_CrWarningExt_AFStatusParam
 	{ SCRSDK::CrWarningExt_AFStatusParam_Unpause,"Unpause" },
 	{ SCRSDK::CrWarningExt_AFStatusParam_Pause,"Pause" },
 };
+constexpr auto map_CrWarningExt_AFStatusParam = makeEnumTable(list_CrWarningExt_AFStatusParam);
 
-const std::unordered_map<CrInt32, std::string> map_CrSdkApi
+constexpr CrEnumName list_CrSdkApi[] =
 {
 	{ SCRSDK::CrSdkApi_Unknown,"Unknown" },
 	{ SCRSDK::CrSdkApi_Invalid,"Invalid" },
@@ -1373,8 +1479,9 @@ const std::unordered_map<CrInt32, std::string> map_CrSdkApi
 	{ SCRSDK::CrSdkApi_SendCommand,"SendCommand" },
 	{ SCRSDK::CrSdkApi_ExecuteControlCode,"ExecuteControlCode" },
 };
+constexpr auto map_CrSdkApi = makeEnumTable(list_CrSdkApi);
 
-const std::unordered_map<CrInt32, std::string> map_CrWarningExt_OperationResultsParam
+constexpr CrEnumName list_CrWarningExt_OperationResultsParam[] =
 {
 	{ SCRSDK::CrWarningExt_OperationResultsParam_Invalid,"Invalid" },
 	{ SCRSDK::CrWarningExt_OperationResultsParam_OK,"OK" },
@@ -1383,16 +1490,18 @@ const std::unordered_map<CrInt32, std::string> map_CrWarningExt_OperationResults
 	{ SCRSDK::CrWarningExt_OperationResultsParam_CameraStatusError,"CameraStatusError" },
 	{ SCRSDK::CrWarningExt_OperationResultsParam_CharacterSizeError,"CharacterSizeError" },
 };
+constexpr auto map_CrWarningExt_OperationResultsParam = makeEnumTable(list_CrWarningExt_OperationResultsParam);
 
-const std::unordered_map<CrInt32, std::string> map_CrWarningExtParam_ControlPTZFResult
+constexpr CrEnumName list_CrWarningExtParam_ControlPTZFResult[] =
 {
 	{ SCRSDK::CrWarningExtParam_ControlPTZFResult_Invalid,"Invalid" },
 	{ SCRSDK::CrWarningExtParam_ControlPTZFResult_OK,"OK" },
 	{ SCRSDK::CrWarningExtParam_ControlPTZFResult_NG,"NG" },
 	{ SCRSDK::CrWarningExtParam_ControlPTZFResult_Canceled,"Canceled" },
 };
+constexpr auto map_CrWarningExtParam_ControlPTZFResult = makeEnumTable(list_CrWarningExtParam_ControlPTZFResult);
 
-const std::unordered_map<CrInt32, std::string> map_CrPTZFControlType
+constexpr CrEnumName list_CrPTZFControlType[] =
 {
 	{ SCRSDK::CrPTZFControlType_Absolute,"Absolute" },
 	{ SCRSDK::CrPTZFControlType_Relative,"Relative" },
@@ -1401,16 +1510,18 @@ const std::unordered_map<CrInt32, std::string> map_CrPTZFControlType
 	{ SCRSDK::CrPTZFControlType_Reset,"Reset" },
 	{ SCRSDK::CrPTZFControlType_Cancel,"Cancel" },
 };
+constexpr auto map_CrPTZFControlType = makeEnumTable(list_CrPTZFControlType);
 
-const std::unordered_map<CrInt32, std::string> map_CrWarningExtParam_PresetPTZFEvent
+constexpr CrEnumName list_CrWarningExtParam_PresetPTZFEvent[] =
 {
 	{ SCRSDK::CrWarningExtParam_PresetPTZFEvent_Invalid,"Invalid" },
 	{ SCRSDK::CrWarningExtParam_PresetPTZFEvent_DriveCompleted,"DriveCompleted" },
 	{ SCRSDK::CrWarningExtParam_PresetPTZFEvent_DriveInterrupted,"DriveInterrupted" },
 	{ SCRSDK::CrWarningExtParam_PresetPTZFEvent_DriveError,"DriveError" },
 };
+constexpr auto map_CrWarningExtParam_PresetPTZFEvent = makeEnumTable(list_CrWarningExtParam_PresetPTZFEvent);
 
-const std::unordered_map<CrInt32, std::string> map_CrWarningExtParam_SetStreamSetting
+constexpr CrEnumName list_CrWarningExtParam_SetStreamSetting[] =
 {
 	{ SCRSDK::CrWarningExtParam_SetStreamSetting_OK,"OK" },
 	{ SCRSDK::CrWarningExtParam_SetStreamSetting_NG,"NG" },
@@ -1423,8 +1534,9 @@ const std::unordered_map<CrInt32, std::string> map_CrWarningExtParam_SetStreamSe
 	{ SCRSDK::CrWarningExtParam_SetStreamSetting_InvalidCipherKey,"InvalidCipherKey" },
 	{ SCRSDK::CrWarningExtParam_SetStreamSetting_InvalidMode,"InvalidMode" },
 };
+constexpr auto map_CrWarningExtParam_SetStreamSetting = makeEnumTable(list_CrWarningExtParam_SetStreamSetting);
 
-const std::unordered_map<CrInt32, std::string> map_CrWarningExtParam_DeleteContent
+constexpr CrEnumName list_CrWarningExtParam_DeleteContent[] =
 {
 	{ SCRSDK::CrWarningExtParam_DeleteContentResult_Invalid, "DeleteContent_Invalid"},
 	{ SCRSDK::CrWarningExtParam_DeleteContentResult_OK, "DeleteContent_OK" },
@@ -1433,8 +1545,9 @@ const std::unordered_map<CrInt32, std::string> map_CrWarningExtParam_DeleteConte
 	{ SCRSDK::CrWarningExtParam_DeleteContentResult_ContentProtected, "DeleteContent_ContentProtected"},
 	{ SCRSDK::CrWarningExtParam_DeleteContentResult_ContentNotExist, "DeleteContent_ContentNotExist"},
 };
+constexpr auto map_CrWarningExtParam_DeleteContent = makeEnumTable(list_CrWarningExtParam_DeleteContent);
 
-const std::unordered_map<CrInt32, std::string> map_CrWarningExtParam_UploadSceneFile
+constexpr CrEnumName list_CrWarningExtParam_UploadSceneFile[] =
 {
 	{ SCRSDK::CrWarningExtParam_UploadSceneFileResult_Invalid, "UploadSceneFile_Invalid"},
 	{ SCRSDK::CrWarningExtParam_UploadSceneFileResult_OK, "UploadSceneFile_OK" },
@@ -1448,15 +1561,17 @@ const std::unordered_map<CrInt32, std::string> map_CrWarningExtParam_UploadScene
 	{ SCRSDK::CrWarningExtParam_UploadSceneFileResult_File_CantOpen, "UploadSceneFile_File_CantOpen"},
 	{ SCRSDK::CrWarningExtParam_UploadSceneFileResult_File_CantRead, "UploadSceneFile_File_CantRead"},
 };
+constexpr auto map_CrWarningExtParam_UploadSceneFile = makeEnumTable(list_CrWarningExtParam_UploadSceneFile);
 
-const std::unordered_map<CrInt32, std::string> map_CrWarningExtParam_DownloadSceneFile
+constexpr CrEnumName list_CrWarningExtParam_DownloadSceneFile[] =
 {
 	{ SCRSDK::CrWarningExtParam_DownloadSceneFileResult_Invalid, "DownloadSceneFile_Invalid"},
 	{ SCRSDK::CrWarningExtParam_DownloadSceneFileResult_DeviceBusy, "DownloadSceneFile_DeviceBusy" },
 	{ SCRSDK::CrWarningExtParam_DownloadSceneFileResult_NG, "DownloadSceneFile_NG"},
 };
+constexpr auto map_CrWarningExtParam_DownloadSceneFile = makeEnumTable(list_CrWarningExtParam_DownloadSceneFile);
 
-const std::unordered_map<CrInt32, std::string> map_CrWarningExtParam_UploadCustomGridLineFileResult
+constexpr CrEnumName list_CrWarningExtParam_UploadCustomGridLineFileResult[] =
 {
 	{ SCRSDK::CrWarningExtParam_UploadCustomGridLineFile_Invalid, "UploadCustomGridLineFile_Invalid"},
 	{ SCRSDK::CrWarningExtParam_UploadCustomGridLineFile_OK, "UploadCustomGridLineFile_OK" },
@@ -1475,8 +1590,9 @@ const std::unordered_map<CrInt32, std::string> map_CrWarningExtParam_UploadCusto
 	{ SCRSDK::CrWarningExtParam_UploadCustomGridLineFile_TemporaryStorageFull, "UploadCustomGridLineFile_TemporaryStorageFull"},
 	{ SCRSDK::CrWarningExtParam_UploadCustomGridLineFile_CameraStatusError, "UploadCustomGridLineFile_CameraStatusError"},
 };
+constexpr auto map_CrWarningExtParam_UploadCustomGridLineFileResult = makeEnumTable(list_CrWarningExtParam_UploadCustomGridLineFileResult);
 
-const std::unordered_map<CrInt32, std::string> map_CrWarningExt_ControlGeneralSettingFileResult
+constexpr CrEnumName list_CrWarningExt_ControlGeneralSettingFileResult[] =
 {
 	{ SCRSDK::CrWarningExtParam_ControlGeneralSettingFile_Invalid,"ControlGeneralSettingFile_Invalid" },
 	{ SCRSDK::CrWarningExtParam_ControlGeneralSettingFile_OK,"ControlGeneralSettingFile_OK" },
@@ -1489,31 +1605,33 @@ const std::unordered_map<CrInt32, std::string> map_CrWarningExt_ControlGeneralSe
 	{ SCRSDK::CrWarningExtParam_ControlGeneralSettingFile_CantOpen,"ControlGeneralSettingFile_CantOpen"},
 	{ SCRSDK::CrWarningExtParam_ControlGeneralSettingFile_CantRead,"ControlGeneralSettingFile_CantRead"},
 };
+constexpr auto map_CrWarningExt_ControlGeneralSettingFileResult = makeEnumTable(list_CrWarningExt_ControlGeneralSettingFileResult);
 
-const std::unordered_map<CrInt32, std::string> map_CrGeneralSettingControlType
+constexpr CrEnumName list_CrGeneralSettingControlType[] =
 {
 	{ SCRSDK::CrGeneralSettingControlType_CheckGeneralSettings,"Check General Settings" },
 	{ SCRSDK::CrGeneralSettingControlType_SetOfGeneralSettings,"Set of General Settings" },
 };
+constexpr auto map_CrGeneralSettingControlType = makeEnumTable(list_CrGeneralSettingControlType);
 
 static std::string func_OperationResults(CrInt32 param1, CrInt32 param2, CrInt32 param3)
 {
 	std::string str = "";
-	str += getMapString(&map_CrSdkApi, param1) + ",";
+	str += getMapString(map_CrSdkApi, param1) + ",";
 
-	if(param1 == SCRSDK::CrSdkApi_SetDeviceProperty) str += getMapString(&map_CrDeviceProperty, param2) + ",";
-	else if(param1 == SCRSDK::CrSdkApi_SendCommand)	 str += getMapString(&map_CrCommandId, param2) + ",";
-	else if (param1 == SCRSDK::CrSdkApi_ExecuteControlCode)	 str += getMapString(&map_CrControlCode, param2) + ",";
+	if(param1 == SCRSDK::CrSdkApi_SetDeviceProperty) str += getMapString(map_CrDeviceProperty, param2) + ",";
+	else if(param1 == SCRSDK::CrSdkApi_SendCommand)	 str += getMapString(map_CrCommandId, param2) + ",";
+	else if (param1 == SCRSDK::CrSdkApi_ExecuteControlCode)	 str += getMapString(map_CrControlCode, param2) + ",";
 	else											 str += "unknown,";
 
-	str += getMapString(&map_CrWarningExt_OperationResultsParam, param3);
+	str += getMapString(map_CrWarningExt_OperationResultsParam, param3);
 	return str;
 }
 
 static std::string func_DeleteContentResults(CrInt32 param1, CrInt32 param2, CrInt32 param3)
 {
 	std::string str = "";
-	str += getMapString(&map_CrWarningExtParam_DeleteContent, param1) + ",";
+	str += getMapString(map_CrWarningExtParam_DeleteContent, param1) + ",";
 
 	str += "ContentsId:" + std::to_string(param2) + ",";
 	str += "SlotNumber:" + std::to_string(param3) + ",";
@@ -1523,76 +1641,87 @@ static std::string func_DeleteContentResults(CrInt32 param1, CrInt32 param2, CrI
 
 struct CrWarningExtString
 {
-	std::string str;
-	std::string (*const func)(CrInt32 param1, CrInt32 param2, CrInt32 param3);
-	const std::unordered_map<CrInt32, std::string>* param1;
-	const std::unordered_map<CrInt32, std::string>* param2;
-	const std::unordered_map<CrInt32, std::string>* param3;
+	CrInt32 code;
+	std::string_view str;
+	std::string (*func)(CrInt32 param1, CrInt32 param2, CrInt32 param3);
+	CrEnumTableRef param1;
+	CrEnumTableRef param2;
+	CrEnumTableRef param3;
 };
 
-const std::unordered_map<CrInt32, std::string> map_CrOperationCode
+constexpr CrEnumTableRef CrEnumTableNone = { nullptr, nullptr, 0 };
+
+constexpr CrEnumName list_CrOperationCode[] =
 {
 	{ SCRSDK::CrOperationCode_GetLicenseInfoList, "GetLicenseInfoList" },
 };
+constexpr auto map_CrOperationCode = makeEnumTable(list_CrOperationCode);
 
 std::string CrOperationCodeString(SCRSDK::CrOperationCode code)
 {
-	return getMapString(&map_CrOperationCode, (CrInt32)code);
+	return getMapString(map_CrOperationCode, (CrInt32)code);
 }
 
-SCRSDK::CrOperationCode CrOperationCode(std::string name)
+std::string_view CrOperationCodeName(SCRSDK::CrOperationCode code)
 {
-	return (SCRSDK::CrOperationCode)getMapCode(&map_CrOperationCode, name);
+	return getMapName(map_CrOperationCode, (CrInt32)code);
 }
 
-const std::unordered_map<CrInt32, struct CrWarningExtString> map_CrWarningExt
+SCRSDK::CrOperationCode CrOperationCode(std::string_view name)
+{
+	return (SCRSDK::CrOperationCode)getMapCode(map_CrOperationCode, name);
+}
+
+constexpr struct CrWarningExtString map_CrWarningExt[] =
 {
 													// str,						func, param1,param2,param3
-	{ SCRSDK::CrWarningExt_Unknown, 				{"Unknown", 				NULL, NULL, NULL, NULL }},
-	{ SCRSDK::CrWarningExt_AFStatus, 				{"AFStatus", 				NULL, &map_CrWarningExt_AFStatusParam, NULL, NULL }},	// Status
-	{ SCRSDK::CrWarningExt_OperationResults, 		{"OperationResults", 		func_OperationResults, NULL, NULL, NULL }},	// SdkApi, DpCode/CmdCode, result
-	{ SCRSDK::CrWarningExt_OperationInvalid, 		{"OperationInvalid", 		func_OperationResults, NULL, NULL, NULL }},	// SdkApi, DpCode/CmdCode, result
-	{ SCRSDK::CrWarningExt_ControlPTZFResult, 		{"ControlPTZFResult", 		NULL, &map_CrError, &map_CrWarningExtParam_ControlPTZFResult, &map_CrPTZFControlType}},	// ResponceCode,Result,ControlType
-	{ SCRSDK::CrWarningExt_PresetPTZFSet,     		{"PresetPTZFSet", 			NULL, &map_CrError, NULL, NULL }},	// ResponceCode
-	{ SCRSDK::CrWarningExt_PresetPTZFClear,			{"PresetPTZFClear", 		NULL, &map_CrError, NULL, NULL }},	// ResponceCode
-	{ SCRSDK::CrWarningExt_PresetPTZFEvent,			{"PresetPTZFEvent", 		NULL, &map_CrWarningExtParam_PresetPTZFEvent, NULL, NULL }},	// Result
-	{ SCRSDK::CrWarningExt_RequestTimeZoneSetting, 		{"RequestTimeZoneSetting", 		NULL, &map_CrError, NULL, NULL }},	// ResponceCode
-	{ SCRSDK::CrWarningExt_SetTimeZoneSetting, 		{"SetTimeZoneSetting", 		NULL, &map_CrError, NULL, NULL }},	// ResponceCode
-	{ SCRSDK::CrWarningExt_ExecuteEframing, 		{"ExecuteEframing", 		NULL, &map_CrError, NULL, NULL }},	// ResponceCode
-	{ SCRSDK::CrWarningExt_RequestStreamSettingList, 	{"RequestStreamSettingList",	NULL, &map_CrError, NULL, NULL }},	// ResponceCode
-	{ SCRSDK::CrWarningExt_SetStreamSettingList, 	{"SetStreamSettingList", 	NULL, &map_CrError, &map_CrWarningExtParam_SetStreamSetting, NULL }},	// ResponceCode,Result
-	{ SCRSDK::CrWarningExt_DeleteContent,			{"DeleteContentResult",	func_DeleteContentResults, &map_CrWarningExtParam_DeleteContent, NULL, NULL }}, // ContentsId,SlotNumber
-	{ SCRSDK::CrWarningExt_UploadSceneFile,			{"UploadSceneFileResult",	NULL, &map_CrWarningExtParam_UploadSceneFile, NULL, NULL }},	// Result
-	{ SCRSDK::CrWarningExt_DownloadSceneFile,		{"DownloadSceneFileResult",	NULL, &map_CrWarningExtParam_DownloadSceneFile, NULL, NULL }},	// Result
-	{ SCRSDK::CrWarningExt_UploadCustomGridLineFile,	{"UploadCustomGridLineFileResult",	NULL, &map_CrWarningExtParam_UploadCustomGridLineFileResult, NULL, NULL }},
-	{ SCRSDK::CrWarningExt_ControlGeneralSettingFile, {"ControlGeneralSettingFile", NULL, &map_CrWarningExt_ControlGeneralSettingFileResult, &map_CrGeneralSettingControlType, NULL}},	// ResponceCode/Result,ControlType
-	{ SCRSDK::CrWarningExt_RequestControlGeneralSettingResultFile, {"RequestControlGeneralSettingResultFile", NULL, &map_CrError, &map_CrGeneralSettingControlType, NULL}},	// ResponceCode,ControlType
-	{ SCRSDK::CrWarningExt_RequestOperation, {"RequestOperation", NULL, &map_CrOperationCode, &map_CrError, NULL}},	// OperationCode,ResponceCode
+	{ SCRSDK::CrWarningExt_Unknown, 				"Unknown", nullptr, CrEnumTableNone, CrEnumTableNone, CrEnumTableNone },
+	{ SCRSDK::CrWarningExt_AFStatus, 				"AFStatus", nullptr, map_CrWarningExt_AFStatusParam, CrEnumTableNone, CrEnumTableNone },	// Status
+	{ SCRSDK::CrWarningExt_OperationResults, 		"OperationResults", func_OperationResults, CrEnumTableNone, CrEnumTableNone, CrEnumTableNone },	// SdkApi, DpCode/CmdCode, result
+	{ SCRSDK::CrWarningExt_OperationInvalid, 		"OperationInvalid", func_OperationResults, CrEnumTableNone, CrEnumTableNone, CrEnumTableNone },	// SdkApi, DpCode/CmdCode, result
+	{ SCRSDK::CrWarningExt_ControlPTZFResult, 		"ControlPTZFResult", nullptr, map_CrError, map_CrWarningExtParam_ControlPTZFResult, map_CrPTZFControlType },	// ResponceCode,Result,ControlType
+	{ SCRSDK::CrWarningExt_PresetPTZFSet,     		"PresetPTZFSet", nullptr, map_CrError, CrEnumTableNone, CrEnumTableNone },	// ResponceCode
+	{ SCRSDK::CrWarningExt_PresetPTZFClear,			"PresetPTZFClear", nullptr, map_CrError, CrEnumTableNone, CrEnumTableNone },	// ResponceCode
+	{ SCRSDK::CrWarningExt_PresetPTZFEvent,			"PresetPTZFEvent", nullptr, map_CrWarningExtParam_PresetPTZFEvent, CrEnumTableNone, CrEnumTableNone },	// Result
+	{ SCRSDK::CrWarningExt_RequestTimeZoneSetting, 		"RequestTimeZoneSetting", nullptr, map_CrError, CrEnumTableNone, CrEnumTableNone },	// ResponceCode
+	{ SCRSDK::CrWarningExt_SetTimeZoneSetting, 		"SetTimeZoneSetting", nullptr, map_CrError, CrEnumTableNone, CrEnumTableNone },	// ResponceCode
+	{ SCRSDK::CrWarningExt_ExecuteEframing, 		"ExecuteEframing", nullptr, map_CrError, CrEnumTableNone, CrEnumTableNone },	// ResponceCode
+	{ SCRSDK::CrWarningExt_RequestStreamSettingList, 	"RequestStreamSettingList", nullptr, map_CrError, CrEnumTableNone, CrEnumTableNone },	// ResponceCode
+	{ SCRSDK::CrWarningExt_SetStreamSettingList, 	"SetStreamSettingList", nullptr, map_CrError, map_CrWarningExtParam_SetStreamSetting, CrEnumTableNone },	// ResponceCode,Result
+	{ SCRSDK::CrWarningExt_DeleteContent,			"DeleteContentResult", func_DeleteContentResults, map_CrWarningExtParam_DeleteContent, CrEnumTableNone, CrEnumTableNone }, // ContentsId,SlotNumber
+	{ SCRSDK::CrWarningExt_UploadSceneFile,			"UploadSceneFileResult", nullptr, map_CrWarningExtParam_UploadSceneFile, CrEnumTableNone, CrEnumTableNone },	// Result
+	{ SCRSDK::CrWarningExt_DownloadSceneFile,		"DownloadSceneFileResult", nullptr, map_CrWarningExtParam_DownloadSceneFile, CrEnumTableNone, CrEnumTableNone },	// Result
+	{ SCRSDK::CrWarningExt_UploadCustomGridLineFile,	"UploadCustomGridLineFileResult", nullptr, map_CrWarningExtParam_UploadCustomGridLineFileResult, CrEnumTableNone, CrEnumTableNone },
+	{ SCRSDK::CrWarningExt_ControlGeneralSettingFile, "ControlGeneralSettingFile", nullptr, map_CrWarningExt_ControlGeneralSettingFileResult, map_CrGeneralSettingControlType, CrEnumTableNone },	// ResponceCode/Result,ControlType
+	{ SCRSDK::CrWarningExt_RequestControlGeneralSettingResultFile, "RequestControlGeneralSettingResultFile", nullptr, map_CrError, map_CrGeneralSettingControlType, CrEnumTableNone },	// ResponceCode,ControlType
+	{ SCRSDK::CrWarningExt_RequestOperation, "RequestOperation", nullptr, map_CrOperationCode, map_CrError, CrEnumTableNone },	// OperationCode,ResponceCode
 
 };
 
 std::string CrWarningExtString(SCRSDK::CrError error, CrInt32 param1, CrInt32 param2, CrInt32 param3)
 {
-	auto iter = map_CrWarningExt.find(error);
-	if(iter == end(map_CrWarningExt)) {
+	// Only a couple dozen entries; a linear scan over the constexpr table is cheaper than sorting it
+	const struct CrWarningExtString* iter = std::find_if(std::begin(map_CrWarningExt), std::end(map_CrWarningExt),
+		[error](const struct CrWarningExtString& e) { return e.code == (CrInt32)error; });
+	if(iter == std::end(map_CrWarningExt)) {
 		char tmp[64] = {0};
 		snprintf(tmp, sizeof(tmp), "unknown(0x%x, param1: 0x%x, param2: 0x%x, param3: 0x%x)", error, param1, param2, param3);
 		std::string tmp2(tmp);
 		return tmp2;
 	}
 
-	std::string str = iter->second.str + "(";
-	if(iter->second.func) {
-		str += iter->second.func(param1, param2, param3) + ")";
+	std::string str = std::string(iter->str) + "(";
+	if(iter->func) {
+		str += iter->func(param1, param2, param3) + ")";
 	} else {
-		str += getMapString(iter->second.param1, param1) + ",";
-		str += getMapString(iter->second.param2, param2) + ",";
-		str += getMapString(iter->second.param3, param3) + ")";
+		str += getMapString(iter->param1, param1) + ",";
+		str += getMapString(iter->param2, param2) + ",";
+		str += getMapString(iter->param3, param3) + ")";
 	}
 	return str;
 }
 
-const std::unordered_map<CrInt32, std::string> map_CrCameraDeviceModel
+constexpr CrEnumName list_CrCameraDeviceModel[] =
 {
 	{ SCRSDK::CrCameraDeviceModel_ILCE_7RM4,"ILCE-7RM4" },
 	{ SCRSDK::CrCameraDeviceModel_ILCE_9M2,"ILCE-9M2" },
@@ -1626,13 +1755,19 @@ const std::unordered_map<CrInt32, std::string> map_CrCameraDeviceModel
 	{ SCRSDK::CrCameraDeviceModel_PXW_Z300,"PXW-Z300"},
 	{ SCRSDK::CrCameraDeviceModel_PXW_Z380,"PXW-Z380"},
 };
+constexpr auto map_CrCameraDeviceModel = makeEnumTable(list_CrCameraDeviceModel);
 
 std::string CrCameraDeviceModelString(CrInt32 id)
 {
-	return getMapString(&map_CrCameraDeviceModel, (CrInt32)id);
+	return getMapString(map_CrCameraDeviceModel, (CrInt32)id);
+}
+
+std::string_view CrCameraDeviceModelName(CrInt32 id)
+{
+	return getMapName(map_CrCameraDeviceModel, (CrInt32)id);
 }
 
-CrInt32 CrCameraDeviceModelIdCode(std::string name)
+CrInt32 CrCameraDeviceModelIdCode(std::string_view name)
 {
-	return getMapCode(&map_CrCameraDeviceModel, name);
+	return getMapCode(map_CrCameraDeviceModel, name);
 }
@@ -3,6 +3,8 @@
 #ifndef CRERRORSTRING_H
 #define CRERRORSTRING_H
 
+#include <string>
+#include <string_view>
 #include <CrTypes.h>
 #include <CrError.h>
 #include <CrDeviceProperty.h>
@@ -19,10 +21,18 @@ std::string CrControlCodeString(SCRSDK::CrControlCode code);
 std::string CrOperationCodeString(SCRSDK::CrOperationCode code);
 std::string CrCameraDeviceModelString(CrInt32 id);
 
-SCRSDK::CrCommandId CrCommandIdCode(std::string name);
-SCRSDK::CrDevicePropertyCode CrDevicePropertyCode(std::string name);
-SCRSDK::CrControlCode CrControlCode(std::string name);
-SCRSDK::CrOperationCode CrOperationCode(std::string name);
-CrInt32 CrCameraDeviceModelIdCode(std::string name);
+SCRSDK::CrCommandId CrCommandIdCode(std::string_view name);
+SCRSDK::CrDevicePropertyCode CrDevicePropertyCode(std::string_view name);
+SCRSDK::CrControlCode CrControlCode(std::string_view name);
+SCRSDK::CrOperationCode CrOperationCode(std::string_view name);
+CrInt32 CrCameraDeviceModelIdCode(std::string_view name);
+
+// Allocation-free variants: return a view into a static table, or an empty view for unknown codes
+std::string_view CrErrorName(SCRSDK::CrError error);
+std::string_view CrCommandIdName(SCRSDK::CrCommandId id);
+std::string_view CrDevicePropertyName(SCRSDK::CrDevicePropertyCode code);
+std::string_view CrControlCodeName(SCRSDK::CrControlCode code);
+std::string_view CrOperationCodeName(SCRSDK::CrOperationCode code);
+std::string_view CrCameraDeviceModelName(CrInt32 id);
 
 #endif // CRERRORSTRING_H
@@ -0,0 +1,343 @@
+﻿#include "Logger.h"
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cli
+{
+
+namespace
+{
+char const* const LEVEL_NAMES[] = { "debug", "info", "warn", "error", "off" };
+
+// Single producer (the owning thread), single consumer (the flusher)
+class ThreadRing
+{
+public:
+    static const std::uint64_t CAPACITY = 256;
+
+    explicit ThreadRing(std::uint32_t thread) : m_thread(thread), m_records(CAPACITY) {}
+
+    bool push(LogRecord const& record)
+    {
+        std::uint64_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) >= CAPACITY) return false;
+        m_records[head % CAPACITY] = record;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    void drain(std::vector<LogRecord>& out)
+    {
+        std::uint64_t tail = m_tail.load(std::memory_order_relaxed);
+        std::uint64_t head = m_head.load(std::memory_order_acquire);
+        for (; tail < head; ++tail) out.push_back(m_records[tail % CAPACITY]);
+        m_tail.store(tail, std::memory_order_release);
+    }
+
+    std::uint32_t thread() const { return m_thread; }
+
+    bool retired = false; // owning thread exited; Impl::mutex held
+
+private:
+    std::uint32_t m_thread;
+    std::vector<LogRecord> m_records;
+    std::atomic<std::uint64_t> m_head{0};
+    std::atomic<std::uint64_t> m_tail{0};
+};
+
+void format(LogRecord const& r, text& out)
+{
+    std::time_t seconds = static_cast<std::time_t>(r.time_us / 1000000);
+    std::tm tm;
+#if defined(_WIN32) || defined(_WIN64)
+    gmtime_s(&tm, &seconds);
+#else
+    gmtime_r(&seconds, &tm);
+#endif
+    char ts[32];
+    std::strftime(ts, sizeof(ts), "%Y-%m-%dT%H:%M:%S", &tm);
+    char prefix[96];
+    int n = std::snprintf(prefix, sizeof(prefix), "ts=%s.%03dZ level=%s thread=%u ", ts,
+                          static_cast<int>(r.time_us / 1000 % 1000), LEVEL_NAMES[static_cast<int>(r.level)], r.thread);
+    out.append(prefix, prefix + n);
+    out.append(r.chars, r.length);
+    out += TEXT('\n');
+}
+
+// The logger's own notice, formatted like any other line; thread 0 is the logger itself
+LogRecord dropped_record(std::uint64_t count)
+{
+    LogRecord r;
+    r.time_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    r.thread = 0;
+    r.level = LogLevel::Warn;
+    std::string msg = "msg=\"log lines dropped\" count=" + std::to_string(count);
+    std::size_t room = LogRecord::TEXT_SIZE;
+    r.length = static_cast<std::uint16_t>(std::min(msg.size(), room));
+    std::copy(msg.begin(), msg.begin() + r.length, r.chars);
+    return r;
+}
+} // namespace
+
+struct Logger::Impl
+{
+    std::mutex mutex;      // rings, flusher start/stop
+    std::mutex out_mutex;  // one writer to tout at a time
+    std::condition_variable cond;
+    std::vector<std::shared_ptr<ThreadRing>> rings;
+    std::uint32_t next_thread = 1; // 0 is the logger itself
+    std::thread flusher;
+    bool stop = false;
+    std::chrono::milliseconds interval{100};
+    std::uint64_t reported_dropped = 0;
+    std::vector<LogRecord> batch;
+    text out;
+
+    // The ring is marked retired when its thread exits and freed by the next flush
+    ThreadRing& ring()
+    {
+        struct Owner
+        {
+            Impl* impl = nullptr;
+            ThreadRing* ring = nullptr;
+            ~Owner()
+            {
+                if (!ring) return;
+                std::lock_guard<std::mutex> lock(impl->mutex);
+                ring->retired = true;
+            }
+        };
+        static thread_local Owner mine;
+        if (!mine.ring) {
+            std::lock_guard<std::mutex> lock(mutex);
+            rings.push_back(std::make_shared<ThreadRing>(next_thread++));
+            mine.impl = this;
+            mine.ring = rings.back().get();
+        }
+        return *mine.ring;
+    }
+
+    // One write per batch
+    void flush(std::uint64_t dropped)
+    {
+        std::lock_guard<std::mutex> out_lock(out_mutex);
+        batch.clear();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (auto& r : rings) r->drain(batch);
+            // A retired ring got its last line before it was marked, so it is empty now
+            rings.erase(std::remove_if(rings.begin(), rings.end(),
+                [](std::shared_ptr<ThreadRing> const& r) { return r->retired; }), rings.end());
+        }
+        std::stable_sort(batch.begin(), batch.end(),
+            [](LogRecord const& a, LogRecord const& b) { return a.time_us < b.time_us; });
+        out.clear();
+        for (auto const& r : batch) format(r, out);
+        if (dropped != reported_dropped) {
+            format(dropped_record(dropped - reported_dropped), out);
+            reported_dropped = dropped;
+        }
+        if (out.empty()) return;
+        tout << out;
+        tout.flush();
+    }
+};
+
+Logger& Logger::instance()
+{
+    static Logger logger;
+    return logger;
+}
+
+Logger::Logger()
+    : m_impl(new Impl)
+{
+}
+
+Logger::~Logger()
+{
+    stop();
+}
+
+void Logger::start(std::chrono::milliseconds interval)
+{
+    Impl& d = *m_impl;
+    std::lock_guard<std::mutex> lock(d.mutex);
+    if (d.flusher.joinable()) return;
+    d.stop = false;
+    d.interval = interval;
+    d.flusher = std::thread([this, &d]() {
+        std::unique_lock<std::mutex> lock(d.mutex);
+        while (!d.stop) {
+            d.cond.wait_for(lock, d.interval);
+            lock.unlock();
+            d.flush(dropped());
+            lock.lock();
+        }
+    });
+    m_running.store(true, std::memory_order_release);
+}
+
+void Logger::stop()
+{
+    Impl& d = *m_impl;
+    {
+        std::lock_guard<std::mutex> lock(d.mutex);
+        d.stop = true;
+    }
+    d.cond.notify_one();
+    if (d.flusher.joinable()) d.flusher.join();
+    m_running.store(false, std::memory_order_release);
+    d.flush(dropped());
+}
+
+void Logger::flush()
+{
+    m_impl->flush(dropped());
+}
+
+void Logger::commit(LogRecord& record)
+{
+    Impl& d = *m_impl;
+    ThreadRing& ring = d.ring();
+    record.thread = ring.thread();
+    if (!m_running.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(d.out_mutex);
+        text line;
+        format(record, line);
+        tout << line;
+        tout.flush();
+        return;
+    }
+    if (!ring.push(record)) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    if (record.level >= LogLevel::Error) d.cond.notify_one();
+}
+
+LogLine::LogLine(LogLevel level, char const* msg)
+    : m_active(Logger::instance().enabled(level))
+{
+    if (!m_active) return;
+    m_record.time_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    m_record.level = level;
+    m_record.length = 0;
+    append_ascii("msg=");
+    text m(msg, msg + std::char_traits<char>::length(msg));
+    append_value(m.c_str());
+}
+
+LogLine::~LogLine()
+{
+    if (m_active) Logger::instance().commit(m_record);
+}
+
+LogLine& LogLine::kv(char const* key, text_literal value)
+{
+    if (!m_active) return *this;
+    append_key(key);
+    append_value(value ? value : TEXT(""));
+    return *this;
+}
+
+LogLine& LogLine::kv(char const* key, double value)
+{
+    if (!m_active) return *this;
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.3f", value);
+    append_key(key);
+    append_ascii(buf);
+    return *this;
+}
+
+LogLine& LogLine::kv_int(char const* key, std::int64_t value)
+{
+    if (!m_active) return *this;
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%lld", static_cast<long long>(value));
+    append_key(key);
+    append_ascii(buf);
+    return *this;
+}
+
+LogLine& LogLine::kv_uint(char const* key, std::uint64_t value)
+{
+    if (!m_active) return *this;
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%llu", static_cast<unsigned long long>(value));
+    append_key(key);
+    append_ascii(buf);
+    return *this;
+}
+
+LogLine& LogLine::kv_hex(char const* key, std::uint64_t value)
+{
+    if (!m_active) return *this;
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "0x%llx", static_cast<unsigned long long>(value));
+    append_key(key);
+    append_ascii(buf);
+    return *this;
+}
+
+void LogLine::append(text_literal s, std::size_t n)
+{
+    std::size_t room = LogRecord::TEXT_SIZE - m_record.length;
+    n = (std::min)(room, n);
+    std::copy(s, s + n, m_record.chars + m_record.length);
+    m_record.length = static_cast<std::uint16_t>(m_record.length + n);
+}
+
+void LogLine::append_ascii(char const* s)
+{
+    for (; *s && m_record.length < LogRecord::TEXT_SIZE; ++s) {
+        m_record.chars[m_record.length++] = static_cast<text_char>(*s);
+    }
+}
+
+void LogLine::append_key(char const* key)
+{
+    append_ascii(" ");
+    append_ascii(key);
+    append_ascii("=");
+}
+
+// Quoted only when needed, as logfmt does
+void LogLine::append_value(text_literal v)
+{
+    text s(v);
+    if (!s.empty() && s.find_first_of(TEXT(" =\"\n\t")) == text::npos) {
+        append(s.data(), s.size());
+        return;
+    }
+    append_ascii("\"");
+    for (text_char c : s) {
+        if (c == TEXT('"') || c == TEXT('\\')) append_ascii("\\");
+        if (c == TEXT('\n')) append_ascii("\\n");
+        else append(&c, 1);
+    }
+    append_ascii("\"");
+}
+
+bool parse_log_level(text const& name, LogLevel& level)
+{
+    for (int i = 0; i < 5; ++i) {
+        text candidate(LEVEL_NAMES[i], LEVEL_NAMES[i] + std::char_traits<char>::length(LEVEL_NAMES[i]));
+        if (name == candidate) {
+            level = static_cast<LogLevel>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace cli
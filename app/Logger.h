@@ -0,0 +1,118 @@
+﻿#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include "Text.h"
+
+namespace cli
+{
+
+// Structured log lines from the connection, callback and transfer paths.
+//
+//   log_info("connected").kv("camera", id).kv("model", model);
+//
+// prints "ts=... level=info thread=2 msg=connected camera=... model=..."
+// on tout. A line below the current level costs one atomic load. Otherwise
+// it is built in a fixed record on the caller's stack and pushed into a ring
+// owned by the calling thread; a background thread merges the rings in time
+// order and writes them in batches, so SDK callback threads never wait on
+// the console. A full ring drops the line and counts it.
+
+enum class LogLevel { Debug, Info, Warn, Error, Off };
+
+struct LogRecord
+{
+    static const std::size_t TEXT_SIZE = 232; // msg and fields; longer lines are cut
+
+    std::int64_t time_us; // system_clock
+    std::uint32_t thread;
+    std::uint16_t length;
+    LogLevel level;
+    text_char chars[TEXT_SIZE];
+};
+
+class Logger
+{
+public:
+    static Logger& instance();
+
+    void set_level(LogLevel level) { m_level.store(level, std::memory_order_relaxed); }
+    bool enabled(LogLevel level) const { return level >= m_level.load(std::memory_order_relaxed); }
+
+    // Until started, and after stop(), lines are written synchronously
+    void start(std::chrono::milliseconds interval = std::chrono::milliseconds(100));
+    void stop();
+
+    // Writes what has been logged so far now. Call before console output
+    // that follows a logged event, so the two come out in order.
+    void flush();
+
+    void commit(LogRecord& record);
+    std::uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    Logger();
+    ~Logger();
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+
+    std::atomic<LogLevel> m_level{LogLevel::Info};
+    std::atomic<bool> m_running{false};
+    std::atomic<std::uint64_t> m_dropped{0};
+};
+
+// One log line under construction; written when it goes out of scope
+class LogLine
+{
+public:
+    LogLine(LogLevel level, char const* msg);
+    ~LogLine();
+    LogLine(const LogLine&) = delete;
+    LogLine& operator=(const LogLine&) = delete;
+
+    LogLine& kv(char const* key, text_literal value);
+    LogLine& kv(char const* key, const text& value) { return kv(key, value.c_str()); }
+    LogLine& kv(char const* key, bool value) { return kv(key, value ? TEXT("true") : TEXT("false")); }
+    LogLine& kv(char const* key, double value);
+
+    template <typename T, typename std::enable_if<std::is_integral<T>::value, int>::type = 0>
+    LogLine& kv(char const* key, T value)
+    {
+        if (std::is_signed<T>::value) return kv_int(key, static_cast<std::int64_t>(value));
+        return kv_uint(key, static_cast<std::uint64_t>(value));
+    }
+
+    // Handles, codes and error numbers
+    LogLine& kv_hex(char const* key, std::uint64_t value);
+
+private:
+    bool m_active;
+    LogRecord m_record;
+
+    LogLine& kv_int(char const* key, std::int64_t value);
+    LogLine& kv_uint(char const* key, std::uint64_t value);
+    void append(text_literal s, std::size_t n);
+    void append_ascii(char const* s);
+    void append_key(char const* key);
+    void append_value(text_literal v);
+};
+
+inline LogLine log_debug(char const* msg) { return LogLine(LogLevel::Debug, msg); }
+inline LogLine log_info(char const* msg) { return LogLine(LogLevel::Info, msg); }
+inline LogLine log_warn(char const* msg) { return LogLine(LogLevel::Warn, msg); }
+inline LogLine log_error(char const* msg) { return LogLine(LogLevel::Error, msg); }
+
+// "debug", "info", "warn", "error" or "off"
+bool parse_log_level(text const& name, LogLevel& level);
+
+} // namespace cli
+
+#endif // !LOGGER_H
@@ -0,0 +1,194 @@
+﻿#include "Metrics.h"
+#if defined(USE_EXPERIMENTAL_FS)
+#include <experimental/filesystem>
+namespace fs = std::experimental::filesystem;
+#else
+#include <filesystem>
+namespace fs = std::filesystem;
+#endif
+#include <cstdio>
+#include <fstream>
+
+namespace cli
+{
+
+const double MetricHistogram::BUCKETS[MetricHistogram::BUCKET_COUNT] = {
+    0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10, 30, 60, 300
+};
+
+void MetricHistogram::observe(double seconds)
+{
+    int i = 0;
+    while (i < BUCKET_COUNT && seconds > BUCKETS[i]) i++;
+    m_buckets[i].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sumMicros.fetch_add((std::uint64_t)(seconds > 0 ? seconds * 1e6 : 0), std::memory_order_relaxed);
+}
+
+MetricsRegistry::~MetricsRegistry()
+{
+    stop_textfile_writer();
+}
+
+void* MetricsRegistry::find_or_add(std::string const& name, std::string const& help, std::string const& labels, Type type)
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    for (auto const& e : m_entries) {
+        if (e.name == name && e.labels == labels && e.type == type) return e.metric;
+    }
+    void* metric = nullptr;
+    switch (type) {
+    case Counter:
+        m_counters.emplace_back();
+        metric = &m_counters.back();
+        break;
+    case Gauge:
+        m_gauges.emplace_back();
+        metric = &m_gauges.back();
+        break;
+    case Histogram:
+        m_histograms.emplace_back();
+        metric = &m_histograms.back();
+        break;
+    }
+    m_entries.push_back(Entry{ name, help, labels, type, metric });
+    return metric;
+}
+
+MetricCounter& MetricsRegistry::counter(std::string const& name, std::string const& help, std::string const& labels)
+{
+    return *static_cast<MetricCounter*>(find_or_add(name, help, labels, Counter));
+}
+
+MetricGauge& MetricsRegistry::gauge(std::string const& name, std::string const& help, std::string const& labels)
+{
+    return *static_cast<MetricGauge*>(find_or_add(name, help, labels, Gauge));
+}
+
+MetricHistogram& MetricsRegistry::histogram(std::string const& name, std::string const& help, std::string const& labels)
+{
+    return *static_cast<MetricHistogram*>(find_or_add(name, help, labels, Histogram));
+}
+
+static std::string with_labels(std::string const& name, std::string const& labels, std::string const& extra = std::string())
+{
+    if (labels.empty() && extra.empty()) return name;
+    std::string s = name + '{' + labels;
+    if (!labels.empty() && !extra.empty()) s += ',';
+    return s + extra + '}';
+}
+
+std::string MetricsRegistry::render() const
+{
+    static const char* const TYPE_NAMES[] = { "counter", "gauge", "histogram" };
+    std::lock_guard<std::mutex> lock(m_mtx);
+    std::string out;
+    char buff[64];
+    std::vector<bool> done(m_entries.size(), false);
+    // Samples of one family have to stay together under a single HELP/TYPE
+    for (size_t i = 0; i < m_entries.size(); i++) {
+        if (done[i]) continue;
+        Entry const& head = m_entries[i];
+        out += "# HELP " + head.name + ' ' + head.help + '\n';
+        out += "# TYPE " + head.name + ' ' + TYPE_NAMES[head.type] + '\n';
+        for (size_t j = i; j < m_entries.size(); j++) {
+            Entry const& e = m_entries[j];
+            if (done[j] || e.name != head.name) continue;
+            done[j] = true;
+            switch (e.type) {
+            case Counter:
+                snprintf(buff, sizeof(buff), " %llu\n", (unsigned long long)static_cast<MetricCounter*>(e.metric)->value());
+                out += with_labels(e.name, e.labels) + buff;
+                break;
+            case Gauge:
+                snprintf(buff, sizeof(buff), " %lld\n", (long long)static_cast<MetricGauge*>(e.metric)->value());
+                out += with_labels(e.name, e.labels) + buff;
+                break;
+            case Histogram: {
+                MetricHistogram const& h = *static_cast<MetricHistogram*>(e.metric);
+                std::uint64_t cumulative = 0;
+                for (int b = 0; b <= MetricHistogram::BUCKET_COUNT; b++) {
+                    cumulative += h.bucket(b);
+                    if (b < MetricHistogram::BUCKET_COUNT) snprintf(buff, sizeof(buff), "le=\"%g\"", MetricHistogram::BUCKETS[b]);
+                    else snprintf(buff, sizeof(buff), "le=\"+Inf\"");
+                    out += with_labels(e.name + "_bucket", e.labels, buff);
+                    snprintf(buff, sizeof(buff), " %llu\n", (unsigned long long)cumulative);
+                    out += buff;
+                }
+                snprintf(buff, sizeof(buff), " %.6f\n", h.sum());
+                out += with_labels(e.name + "_sum", e.labels) + buff;
+                snprintf(buff, sizeof(buff), " %llu\n", (unsigned long long)h.count());
+                out += with_labels(e.name + "_count", e.labels) + buff;
+                break;
+            }
+            }
+        }
+    }
+    return out;
+}
+
+bool MetricsRegistry::write_textfile(text const& path) const
+{
+    std::string body = render();
+    fs::path target(path);
+    fs::path temp(path + TEXT(".tmp"));
+    {
+        std::ofstream file(temp, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!file) return false;
+        file.write(body.data(), body.size());
+        if (!file) return false;
+    }
+    std::error_code ec;
+    fs::rename(temp, target, ec);
+    return !ec;
+}
+
+void MetricsRegistry::start_textfile_writer(text const& path, std::chrono::seconds interval)
+{
+    stop_textfile_writer();
+    m_writerStop = false;
+    m_writer = std::thread([this, path, interval]() {
+        std::unique_lock<std::mutex> lock(m_writerMtx);
+        while (!m_writerStop) {
+            lock.unlock();
+            write_textfile(path);
+            lock.lock();
+            m_writerCv.wait_for(lock, interval, [this]() { return m_writerStop; });
+        }
+        lock.unlock();
+        write_textfile(path); // final values
+    });
+}
+
+void MetricsRegistry::stop_textfile_writer()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_writerMtx);
+        m_writerStop = true;
+    }
+    m_writerCv.notify_all();
+    if (m_writer.joinable()) m_writer.join();
+}
+
+MetricsRegistry& metrics()
+{
+    static MetricsRegistry registry;
+    return registry;
+}
+
+SdkCallMetrics& sdk_call_metrics(const char* api)
+{
+    static std::mutex mtx;
+    static std::deque<std::pair<std::string, SdkCallMetrics>> calls;
+    std::lock_guard<std::mutex> lock(mtx);
+    for (auto& c : calls) {
+        if (c.first == api) return c.second;
+    }
+    std::string labels = std::string("api=\"") + api + '"';
+    calls.emplace_back(api, SdkCallMetrics{
+        metrics().histogram("remotecli_sdk_call_seconds", "Latency of Camera Remote SDK calls", labels),
+        metrics().counter("remotecli_sdk_call_errors_total", "Camera Remote SDK calls that returned an error", labels) });
+    return calls.back().second;
+}
+
+} // namespace cli
@@ -0,0 +1,141 @@
+﻿#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "CrTypes.h"
+#include "CrError.h"
+#include "Text.h"
+
+namespace cli
+{
+
+// Metrics are registered once (allocation happens then, under the registry
+// lock) and updated with relaxed atomics only, so the SDK wrappers and
+// callbacks can record without locking or allocating. render() produces the
+// Prometheus text exposition format.
+
+class MetricCounter
+{
+public:
+    void inc(std::uint64_t n = 1) { m_value.fetch_add(n, std::memory_order_relaxed); }
+    std::uint64_t value() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<std::uint64_t> m_value{0};
+};
+
+class MetricGauge
+{
+public:
+    void set(std::int64_t v) { m_value.store(v, std::memory_order_relaxed); }
+    void add(std::int64_t n) { m_value.fetch_add(n, std::memory_order_relaxed); }
+    std::int64_t value() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<std::int64_t> m_value{0};
+};
+
+// Fixed buckets in seconds, from 1 ms to 5 min
+class MetricHistogram
+{
+public:
+    static const int BUCKET_COUNT = 16;
+    static const double BUCKETS[BUCKET_COUNT];
+
+    void observe(double seconds);
+    void observe(std::chrono::steady_clock::duration d) { observe(std::chrono::duration<double>(d).count()); }
+
+    std::uint64_t count() const { return m_count.load(std::memory_order_relaxed); }
+    double sum() const { return m_sumMicros.load(std::memory_order_relaxed) / 1e6; }
+    std::uint64_t bucket(int i) const { return m_buckets[i].load(std::memory_order_relaxed); } // not cumulative
+
+private:
+    std::atomic<std::uint64_t> m_buckets[BUCKET_COUNT + 1] = {}; // last one is +Inf
+    std::atomic<std::uint64_t> m_count{0};
+    std::atomic<std::uint64_t> m_sumMicros{0};
+};
+
+class MetricsRegistry
+{
+public:
+    MetricsRegistry() = default;
+    ~MetricsRegistry();
+
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    // Returns the existing metric for the same name and labels.
+    // labels is the inside of the braces, e.g. api="Connect"
+    MetricCounter& counter(std::string const& name, std::string const& help, std::string const& labels = std::string());
+    MetricGauge& gauge(std::string const& name, std::string const& help, std::string const& labels = std::string());
+    MetricHistogram& histogram(std::string const& name, std::string const& help, std::string const& labels = std::string());
+
+    std::string render() const;
+
+    // Write render() to a file through a temporary one, as the node_exporter
+    // textfile collector expects
+    bool write_textfile(text const& path) const;
+    // Rewrite the file every interval until stop_textfile_writer()
+    void start_textfile_writer(text const& path, std::chrono::seconds interval);
+    void stop_textfile_writer();
+
+private:
+    enum Type { Counter, Gauge, Histogram };
+
+    struct Entry
+    {
+        std::string name;
+        std::string help;
+        std::string labels;
+        Type type;
+        void* metric;
+    };
+
+    void* find_or_add(std::string const& name, std::string const& help, std::string const& labels, Type type);
+
+    mutable std::mutex m_mtx;
+    std::deque<Entry> m_entries;
+    std::deque<MetricCounter> m_counters;
+    std::deque<MetricGauge> m_gauges;
+    std::deque<MetricHistogram> m_histograms;
+
+    std::mutex m_writerMtx;
+    std::condition_variable m_writerCv;
+    bool m_writerStop = false;
+    std::thread m_writer;
+};
+
+MetricsRegistry& metrics();
+
+// Latency histogram and error counter of one SDK API
+struct SdkCallMetrics
+{
+    MetricHistogram& seconds;
+    MetricCounter& errors;
+};
+
+// Look the pair up once and keep the reference, e.g.
+//   static SdkCallMetrics& m = sdk_call_metrics("Connect");
+SdkCallMetrics& sdk_call_metrics(const char* api);
+
+// Run one SDK call and record its latency, and its result if it failed
+template <typename F>
+inline auto timed_sdk_call(SdkCallMetrics& m, F&& call) -> decltype(call())
+{
+    auto start = std::chrono::steady_clock::now();
+    auto result = call();
+    m.seconds.observe(std::chrono::steady_clock::now() - start);
+    if (CR_FAILED(result)) m.errors.inc();
+    return result;
+}
+
+} // namespace cli
+
+#endif // !METRICS_H
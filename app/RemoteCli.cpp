@@ -14,6 +14,10 @@ namespace fs = std::filesystem;
 #include <iomanip>
 #include "CameraRemote_SDK.h"
 #include "CameraDevice.h"
+#include "Logger.h"
+#include "Metrics.h"
+#include "RemoteTransferEngine.h"
+#include "RemoteTransferIngest.h"
 #include "Text.h"
 
 //#define LIVEVIEW_ENB
@@ -66,6 +70,25 @@ int main()
     }
     cli::tout << "Remote SDK successfully initialized.\n\n";
 
+    // No HTTP server here: metrics go to a file for the node_exporter textfile collector,
+    // only when asked for with REMOTECLI_METRICS_FILE=<path>
+    if (char const* env_metrics = std::getenv("REMOTECLI_METRICS_FILE")) {
+        std::string path(env_metrics);
+        if (!path.empty()) {
+            cli::metrics().start_textfile_writer(cli::text(path.begin(), path.end()), std::chrono::seconds(15));
+        }
+    }
+
+    // Connection, callback and transfer events; REMOTECLI_LOG_LEVEL=debug|info|warn|error|off
+    if (char const* env_level = std::getenv("REMOTECLI_LOG_LEVEL")) {
+        std::string name(env_level);
+        cli::LogLevel level;
+        if (cli::parse_log_level(cli::text(name.begin(), name.end()), level)) {
+            cli::Logger::instance().set_level(level);
+        }
+    }
+    cli::Logger::instance().start();
+
 #ifdef MSEARCH_ENB
     cli::tout << "Enumerate connected camera devices...\n";
     SDK::ICrEnumCameraObjectInfo* camera_list = nullptr;
@@ -982,6 +1005,8 @@ int main()
                             << "(0) Return to REMOTE-MENU\n"
                             << "(1) Get Contents Data \n"
                             << "(2) Movie Playback \n"
+                            << "(3) Offload All Contents (all cameras, both slots) \n"
+                            << "(4) Auto Ingest New Contents (all cameras) \n"
                             ;
 
                         cli::tout << "input> ";
@@ -991,6 +1016,31 @@ int main()
                         if (select == TEXT("1")) { /* Get Contents Data */
                             camera->get_remote_transfer_contentsdata();                   
                         }
+                        else if (select == TEXT("3")) { /* Offload All Contents */
+                            cli::RemoteTransferEngine engine(fs::current_path().native());
+                            CrInt32u queued = 0;
+                            for (auto& cam : cameraList) {
+                                if (cam->is_connected() && (SDK::CrSdkControlMode_RemoteTransfer == cam->get_sdkmode())) {
+                                    queued += engine.enqueue_all(cam);
+                                }
+                            }
+                            cli::tout << queued << " files queued.\n";
+                            engine.wait();
+                        }
+                        else if (select == TEXT("4")) { /* Auto Ingest New Contents */
+                            cli::RemoteTransferEngine engine(fs::current_path().native());
+                            cli::RemoteTransferIngest ingest(engine);
+                            for (auto& cam : cameraList) {
+                                if (cam->is_connected() && (SDK::CrSdkControlMode_RemoteTransfer == cam->get_sdkmode())) {
+                                    ingest.attach(cam);
+                                }
+                            }
+                            cli::tout << "Waiting for new contents. Press Enter to stop.\n";
+                            cli::text dummy;
+                            std::getline(cli::tin, dummy);
+                            ingest.stop();
+                            engine.wait();
+                        }
                         else if(select == TEXT("2")) { /* Movie Playback */                      
                             if (false == camera->isMoviePlaybackFunctionSupport()) {
                                 cli::tout << "Movie playback function cannot be used with this device.\n";
@@ -1315,6 +1365,8 @@ int main()
 
     }// end of loop-A
 
+    cli::metrics().stop_textfile_writer();
+    cli::Logger::instance().stop();
     cli::tout << "Release SDK resources.\n";
     SDK::Release();
 
@@ -0,0 +1,259 @@
+﻿#include "RemoteTransferEngine.h"
+#if defined(USE_EXPERIMENTAL_FS)
+#include <experimental/filesystem>
+namespace fs = std::experimental::filesystem;
+#else
+#include <filesystem>
+namespace fs = std::filesystem;
+#endif
+#include <cstdio>
+
+namespace SDK = SCRSDK;
+
+namespace cli
+{
+
+RemoteTransferEngine::RemoteTransferEngine(text destination, bool proxyFirst)
+    : m_destination(destination)
+    , m_proxyFirst(proxyFirst)
+    , m_stop(false)
+    , m_start(std::chrono::steady_clock::now())
+{
+}
+
+RemoteTransferEngine::~RemoteTransferEngine()
+{
+    stop();
+}
+
+CrInt32u RemoteTransferEngine::enqueue_all(CameraDevicePtr camera)
+{
+    std::vector<RemoteTransferFile> files;
+    if (!camera->get_remote_transfer_file_list(SDK::CrSlotNumber_Slot1, files)) {
+        tout << "Get ContentsInfoList fail. " << camera->get_model() << " SLOT1\n";
+    }
+    if (!camera->get_remote_transfer_file_list(SDK::CrSlotNumber_Slot2, files)) {
+        tout << "Get ContentsInfoList fail. " << camera->get_model() << " SLOT2\n";
+    }
+    for (auto const& file : files) {
+        enqueue(camera, file);
+    }
+    return (CrInt32u)files.size();
+}
+
+void RemoteTransferEngine::enqueue(CameraDevicePtr camera, RemoteTransferFile const& file)
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    if (m_stop) return;
+    if (idle()) {
+        m_start = std::chrono::steady_clock::now(); // throughput is per batch
+    }
+    CameraQueue& queue = queue_for(camera);
+    int slot = (file.slotNumber == SDK::CrSlotNumber_Slot2) ? 1 : 0;
+    if (m_proxyFirst) {
+        if (file.filePath.find("/SUB/") != std::string::npos) {
+            push_proxy(queue, Job{ file, true, false });
+            m_cv.notify_all();
+            return;
+        }
+        switch (file.fileFormat) {
+        case SDK::CrContentsFile_FileFormat_Mp4:
+        case SDK::CrContentsFile_FileFormat_Jpeg:
+        case SDK::CrContentsFile_FileFormat_Raw:
+        case SDK::CrContentsFile_FileFormat_Heif:
+            push_proxy(queue, Job{ file, true, true });
+            break;
+        default:
+            break;
+        }
+    }
+    queue.slots[slot].push_back(Job{ file, false, false });
+    queue.stats[slot].queued++;
+    m_cv.notify_all();
+}
+
+void RemoteTransferEngine::push_proxy(CameraQueue& queue, Job const& job)
+{
+    queue.proxies.push_back(job);
+    queue.proxyStats.queued++;
+    // Called under m_mtx, so the worker cannot move on to another transfer meanwhile
+    if (queue.busy && queue.busyOriginal && !queue.preempted
+        && queue.camera->cancel_remote_transfer(PREEMPT_BELOW_PERCENT)) {
+        queue.preempted = true;
+    }
+}
+
+RemoteTransferEngine::CameraQueue& RemoteTransferEngine::queue_for(CameraDevicePtr const& camera)
+{
+    for (auto& queue : m_queues) {
+        if (queue->camera == camera) return *queue;
+    }
+    std::unique_ptr<CameraQueue> queue(new CameraQueue());
+    queue->camera = camera;
+    text id = camera->get_id();
+    for (auto& c : id) {
+        if (c == TEXT(':')) c = TEXT('-'); // MAC address
+    }
+    queue->folder = (fs::path(m_destination) / (camera->get_model() + TEXT("_") + id)).native();
+    CameraQueue* raw = queue.get();
+    queue->worker = std::thread([this, raw]() { run(*raw); });
+    m_queues.push_back(std::move(queue));
+    return *raw;
+}
+
+bool RemoteTransferEngine::transfer(CameraQueue& queue, Job const& job)
+{
+    RemoteTransferFile const& file = job.file;
+    std::string fileName = file.filePath.substr(file.filePath.find_last_of('/') + 1);
+    fs::path dir = fs::path(queue.folder) / (file.slotNumber == SDK::CrSlotNumber_Slot2 ? "SLOT2" : "SLOT1");
+    if (job.screennail) {
+        // Keep the original extension, so the proxies of a RAW+JPEG pair do not collide:
+        // DSC00001.ARW -> DSC00001_ARW.JPG
+        dir /= "PROXY";
+        size_t dot = fileName.find_last_of('.');
+        if (dot != std::string::npos) {
+            fileName = fileName.substr(0, dot) + "_" + fileName.substr(dot + 1);
+        }
+        fileName += ".JPG";
+    }
+    std::error_code ec;
+    fs::create_directories(dir, ec);
+    fs::path path = dir / fileName;
+
+    if (!queue.camera->is_connected()) {
+        return false;
+    }
+    FileTransferSink sink(path.native());
+    if (job.screennail) {
+        return queue.camera->get_remote_transfer_compresseddata_to_sink(file.slotNumber, file.contentId, file.fileId,
+            SDK::CrGetContentsCompressedDataType_Screennail, sink);
+    }
+    return queue.camera->get_remote_transfer_contentsdata_to_sink(file.slotNumber, file.contentId, file.fileId, file.fileSize,
+        queue.camera->get_remote_transfer_division_size(), sink, false);
+}
+
+void RemoteTransferEngine::run(CameraQueue& queue)
+{
+    std::unique_lock<std::mutex> lock(m_mtx);
+    while (true) {
+        m_cv.wait(lock, [&]() { return m_stop || !queue.proxies.empty() || !queue.slots[0].empty() || !queue.slots[1].empty(); });
+        if (m_stop) break;
+
+        Job job;
+        int slot = 0;
+        if (!queue.proxies.empty()) {
+            job = queue.proxies.front();
+            queue.proxies.pop_front();
+        }
+        else {
+            // Alternate slots so both cards make progress
+            slot = queue.nextSlot;
+            if (queue.slots[slot].empty()) slot = 1 - slot;
+            queue.nextSlot = 1 - slot;
+            job = queue.slots[slot].front();
+            queue.slots[slot].pop_front();
+        }
+        queue.busy = true;
+        queue.busyOriginal = !job.proxy;
+        queue.preempted = false;
+        lock.unlock();
+
+        bool ok = transfer(queue, job);
+
+        lock.lock();
+        queue.busy = false;
+        const std::string fileName = job.file.filePath.substr(job.file.filePath.find_last_of('/') + 1);
+        if (!ok && !job.proxy && queue.preempted) {
+            queue.slots[slot].push_front(job);
+            tout << "Preempted " << queue.camera->get_model() << " SLOT" << (slot + 1) << ' ' << fileName.c_str() << '\n';
+            m_cv.notify_all();
+            continue;
+        }
+        SlotStats& stats = job.proxy ? queue.proxyStats : queue.stats[slot];
+        if (ok) {
+            stats.done++;
+            if (!job.screennail) stats.bytes += job.file.fileSize;
+        }
+        else {
+            stats.failed++;
+        }
+        tout << (ok ? "OK " : "NG ") << queue.camera->get_model() << (job.proxy ? " PROXY " : (slot == 0 ? " SLOT1 " : " SLOT2 "))
+             << fileName.c_str() << (job.screennail ? " (screennail)" : "") << '\n';
+        m_cv.notify_all();
+    }
+}
+
+bool RemoteTransferEngine::idle() const
+{
+    for (auto const& queue : m_queues) {
+        if (queue->busy || !queue->proxies.empty() || !queue->slots[0].empty() || !queue->slots[1].empty()) return false;
+    }
+    return true;
+}
+
+void RemoteTransferEngine::wait()
+{
+    std::unique_lock<std::mutex> lock(m_mtx);
+    auto lastReport = std::chrono::steady_clock::now();
+    while (!m_stop && !idle()) {
+        m_cv.wait_for(lock, std::chrono::seconds(1));
+        if (std::chrono::steady_clock::now() - lastReport >= std::chrono::seconds(5)) {
+            print_status_locked();
+            lastReport = std::chrono::steady_clock::now();
+        }
+    }
+    print_status_locked();
+}
+
+void RemoteTransferEngine::stop()
+{
+    std::vector<std::thread> workers;
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        m_stop = true;
+        for (auto& queue : m_queues) {
+            queue->proxies.clear();
+            queue->slots[0].clear();
+            queue->slots[1].clear();
+            if (queue->worker.joinable()) workers.push_back(std::move(queue->worker));
+        }
+        m_cv.notify_all();
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void RemoteTransferEngine::print_status()
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    print_status_locked();
+}
+
+void RemoteTransferEngine::print_status_locked() const
+{
+    char buff[256];
+    CrInt64u total = 0;
+    for (auto const& queue : m_queues) {
+        if (queue->proxyStats.queued != 0) {
+            snprintf(buff, sizeof(buff), " PROXY: %u/%u files, %u failed\n",
+                queue->proxyStats.done, queue->proxyStats.queued, queue->proxyStats.failed);
+            tout << queue->camera->get_model() << buff;
+            total += queue->proxyStats.bytes;
+        }
+        for (int slot = 0; slot < 2; slot++) {
+            SlotStats const& stats = queue->stats[slot];
+            if (stats.queued == 0) continue;
+            snprintf(buff, sizeof(buff), " SLOT%d: %u/%u files, %u failed, %.1f MB\n", slot + 1,
+                stats.done, stats.queued, stats.failed, stats.bytes / (1024.0 * 1024.0));
+            tout << queue->camera->get_model() << buff;
+            total += stats.bytes;
+        }
+    }
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+    snprintf(buff, sizeof(buff), "Total: %.1f MB in %.1f s, %.1f MB/s\n", total / (1024.0 * 1024.0), sec,
+        sec > 0 ? total / (1024.0 * 1024.0) / sec : 0.0);
+    tout << buff;
+}
+
+} // namespace cli
@@ -0,0 +1,100 @@
+﻿#ifndef REMOTETRANSFERENGINE_H
+#define REMOTETRANSFERENGINE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "CameraDevice.h"
+#include "Text.h"
+
+namespace cli
+{
+
+// Non-interactive offload of remote transfer contents.
+// Every camera gets a worker and one queue per slot; cameras transfer in
+// parallel. OnNotifyRemoteTransferResult does not say which slot a division
+// belongs to, so a camera keeps one request in flight and its worker
+// alternates between the slot queues instead of running them side by side.
+// Files are written to <destination>/<model>_<id>/SLOT<n>/<file name>.
+//
+// Proxies are scheduled ahead of originals: proxy clips (M4ROOT/SUB) and the
+// screennail of every picture or movie go to a proxy queue that is always
+// drained first. A new proxy cancels an original still early in its transfer;
+// the original goes back to the head of its slot queue and starts over.
+// Screennails are written to SLOT<n>/PROXY/<file name>.JPG.
+class RemoteTransferEngine
+{
+public:
+    using CameraDevicePtr = std::shared_ptr<CameraDevice>;
+
+    struct SlotStats
+    {
+        CrInt32u queued = 0;
+        CrInt32u done = 0;
+        CrInt32u failed = 0;
+        CrInt64u bytes = 0;
+    };
+
+    explicit RemoteTransferEngine(text destination, bool proxyFirst = true);
+    ~RemoteTransferEngine();
+
+    // Queue every file on both slots of the camera; returns the number of files queued
+    CrInt32u enqueue_all(CameraDevicePtr camera);
+    void enqueue(CameraDevicePtr camera, RemoteTransferFile const& file);
+
+    // Block until every queue has drained, printing progress every few seconds
+    void wait();
+    // Drop queued files and join the workers; a transfer already running finishes first
+    void stop();
+
+    void print_status();
+
+private:
+    struct Job
+    {
+        RemoteTransferFile file;
+        bool proxy;      // proxy tier
+        bool screennail; // compressed rendition of file rather than file itself
+    };
+
+    struct CameraQueue
+    {
+        CameraDevicePtr camera;
+        text folder;
+        std::deque<Job> proxies;
+        std::deque<Job> slots[2];
+        SlotStats proxyStats;
+        SlotStats stats[2];
+        int nextSlot = 0;
+        bool busy = false;
+        bool busyOriginal = false;
+        bool preempted = false;
+        std::thread worker;
+    };
+
+    // An original past this point is left to finish rather than restarted
+    static const CrInt32u PREEMPT_BELOW_PERCENT = 80;
+
+    CameraQueue& queue_for(CameraDevicePtr const& camera);
+    void push_proxy(CameraQueue& queue, Job const& job);
+    bool transfer(CameraQueue& queue, Job const& job);
+    void run(CameraQueue& queue);
+    bool idle() const;
+    void print_status_locked() const;
+
+    text m_destination;
+    bool m_proxyFirst;
+    mutable std::mutex m_mtx;
+    std::condition_variable m_cv;
+    std::vector<std::unique_ptr<CameraQueue>> m_queues;
+    bool m_stop;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+} // namespace cli
+
+#endif // !REMOTETRANSFERENGINE_H
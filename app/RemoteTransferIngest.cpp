@@ -0,0 +1,84 @@
+﻿#include "RemoteTransferIngest.h"
+
+namespace SDK = SCRSDK;
+
+namespace cli
+{
+
+RemoteTransferIngest::RemoteTransferIngest(RemoteTransferEngine& engine)
+    : m_engine(engine)
+    , m_stop(false)
+{
+    m_thread = std::thread([this]() { run(); });
+}
+
+RemoteTransferIngest::~RemoteTransferIngest()
+{
+    stop();
+}
+
+void RemoteTransferIngest::attach(CameraDevicePtr camera)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        m_cameras.push_back(camera);
+    }
+    // A raw pointer is enough: stop() clears the listener before the camera can go away
+    CameraDevice* raw = camera.get();
+    camera->set_contents_list_listener([this, raw](CrInt32u notify, CrInt32u slotNumber, CrInt32u addSize) {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        for (auto& cam : m_cameras) {
+            if (cam.get() == raw) {
+                m_events.push_back(Event{ cam, notify, slotNumber, addSize });
+                m_cv.notify_one();
+                break;
+            }
+        }
+    });
+}
+
+void RemoteTransferIngest::stop()
+{
+    std::vector<CameraDevicePtr> cameras;
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        cameras.swap(m_cameras);
+        m_stop = true;
+        m_cv.notify_one();
+    }
+    for (auto& camera : cameras) {
+        camera->set_contents_list_listener(nullptr);
+    }
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void RemoteTransferIngest::run()
+{
+    std::unique_lock<std::mutex> lock(m_mtx);
+    while (true) {
+        m_cv.wait(lock, [this]() { return m_stop || !m_events.empty(); });
+        if (m_stop) break;
+        Event event = m_events.front();
+        m_events.pop_front();
+        lock.unlock();
+
+        SDK::CrSlotNumber slotNumber = (event.slotNumber == SDK::CrSlotNumber_Slot2) ? SDK::CrSlotNumber_Slot2 : SDK::CrSlotNumber_Slot1;
+        if (event.notify == SDK::CrNotify_RemoteTransfer_Changed_Clear) {
+            event.camera->forget_remote_transfer_contents(slotNumber);
+        } else if (event.notify == SDK::CrNotify_RemoteTransfer_Changed_Add) {
+            std::vector<RemoteTransferFile> files;
+            if (event.camera->get_remote_transfer_added_files(slotNumber, event.addSize != 0 ? event.addSize : 1, files) && !files.empty()) {
+                tout << event.camera->get_model() << " SLOT" << (int)slotNumber << ": " << files.size() << " new files\n";
+                for (auto const& file : files) {
+                    m_engine.enqueue(event.camera, file);
+                }
+            }
+        }
+
+        lock.lock();
+    }
+}
+
+} // namespace cli
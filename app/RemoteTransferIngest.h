@@ -0,0 +1,52 @@
+﻿#ifndef REMOTETRANSFERINGEST_H
+#define REMOTETRANSFERINGEST_H
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "RemoteTransferEngine.h"
+
+namespace cli
+{
+
+// Pulls newly recorded contents as soon as the camera reports them.
+// OnNotifyRemoteTransferContentsListChanged only queues an event; a service
+// thread resolves the added contents from the ContentsInfoListUpdateTime
+// property and hands the files to a RemoteTransferEngine.
+class RemoteTransferIngest
+{
+public:
+    using CameraDevicePtr = RemoteTransferEngine::CameraDevicePtr;
+
+    explicit RemoteTransferIngest(RemoteTransferEngine& engine);
+    ~RemoteTransferIngest();
+
+    void attach(CameraDevicePtr camera);
+    // Detach from every camera and stop the service thread
+    void stop();
+
+private:
+    struct Event
+    {
+        CameraDevicePtr camera;
+        CrInt32u notify;
+        CrInt32u slotNumber;
+        CrInt32u addSize;
+    };
+
+    void run();
+
+    RemoteTransferEngine& m_engine;
+    std::mutex m_mtx;
+    std::condition_variable m_cv;
+    std::deque<Event> m_events;
+    std::vector<CameraDevicePtr> m_cameras;
+    bool m_stop;
+    std::thread m_thread;
+};
+
+} // namespace cli
+
+#endif // !REMOTETRANSFERINGEST_H
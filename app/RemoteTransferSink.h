@@ -0,0 +1,100 @@
+﻿#ifndef REMOTETRANSFERSINK_H
+#define REMOTETRANSFERSINK_H
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "CrTypes.h"
+#include "Text.h"
+
+namespace cli
+{
+
+// Receives the divisions of a GetRemoteTransferContentsData transfer, in order.
+// Called on the SDK callback thread; a sink returning false cancels the transfer.
+class RemoteTransferSink
+{
+public:
+    virtual ~RemoteTransferSink() {}
+
+    // fileSize is CrContentsFile::fileSize, or 0 if unknown
+    virtual bool begin(CrInt64u fileSize) { return true; }
+    virtual bool write(const CrInt8u* data, CrInt64u size, CrInt64u offset) = 0;
+    // ok is false if the transfer failed, was canceled or came up short
+    virtual void end(bool ok) {}
+};
+
+// Writes each division at its offset (pwrite), removing the file if the transfer fails
+class FileTransferSink : public RemoteTransferSink
+{
+public:
+    explicit FileTransferSink(text path);
+    ~FileTransferSink();
+
+    bool begin(CrInt64u fileSize) override;
+    bool write(const CrInt8u* data, CrInt64u size, CrInt64u offset) override;
+    void end(bool ok) override;
+
+private:
+    void close();
+
+    text m_path;
+#if defined(_WIN32) || defined(_WIN64)
+    void* m_file; // HANDLE
+#else
+    int m_fd;
+#endif
+};
+
+// Streaming XXH64 of the transferred data
+class HashTransferSink : public RemoteTransferSink
+{
+public:
+    explicit HashTransferSink(std::uint64_t seed = 0);
+
+    bool begin(CrInt64u fileSize) override;
+    bool write(const CrInt8u* data, CrInt64u size, CrInt64u offset) override;
+
+    std::uint64_t digest() const;
+    text digest_string() const;
+    // Checks the implementation against known XXH64 answers
+    static bool self_test();
+
+private:
+    std::uint64_t m_seed;
+    std::uint64_t m_acc[4];
+    std::uint8_t m_buf[32];
+    std::uint32_t m_bufSize;
+    std::uint64_t m_total;
+};
+
+// Forwards divisions to a callback, e.g. the DataSink of an HTTP response
+class CallbackTransferSink : public RemoteTransferSink
+{
+public:
+    using Callback = std::function<bool(const CrInt8u* data, CrInt64u size)>;
+    explicit CallbackTransferSink(Callback callback) : m_callback(callback) {}
+
+    bool write(const CrInt8u* data, CrInt64u size, CrInt64u offset) override { return m_callback(data, size); }
+
+private:
+    Callback m_callback;
+};
+
+// Fans each division out to several sinks
+class TeeTransferSink : public RemoteTransferSink
+{
+public:
+    explicit TeeTransferSink(std::vector<RemoteTransferSink*> sinks) : m_sinks(sinks) {}
+
+    bool begin(CrInt64u fileSize) override;
+    bool write(const CrInt8u* data, CrInt64u size, CrInt64u offset) override;
+    void end(bool ok) override;
+
+private:
+    std::vector<RemoteTransferSink*> m_sinks;
+};
+
+} // namespace cli
+
+#endif // !REMOTETRANSFERSINK_H
@@ -0,0 +1,338 @@
+﻿#if defined (_WIN32) || defined(_WIN64)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "ThumbnailCache.h"
+#if defined(USE_EXPERIMENTAL_FS)
+#include <experimental/filesystem>
+namespace fs = std::experimental::filesystem;
+#else
+#include <filesystem>
+namespace fs = std::filesystem;
+#endif
+#include <cstring>
+#include <fstream>
+#include "RemoteTransferSink.h"
+
+namespace cli
+{
+
+static const std::uint32_t PACK_RECORD_MAGIC = 0x31524354; // "TCR1"
+static const std::uint32_t INDEX_MAGIC = 0x31494354;       // "TCI1"
+static const CrInt32u INDEX_SAVE_INTERVAL = 64;            // inserts between index writes
+
+struct PackRecordHeader
+{
+    std::uint32_t magic;
+    std::uint32_t keySize;
+    std::uint32_t fileType;
+    std::uint32_t reserved;
+    std::uint64_t size;
+};
+
+struct IndexHeader
+{
+    std::uint32_t magic;
+    std::uint32_t count;
+    std::uint64_t packSize;
+};
+
+struct IndexEntry
+{
+    std::uint64_t hash;
+    std::uint64_t offset;
+    std::uint64_t size;
+    std::uint32_t keySize;
+    std::uint32_t fileType;
+};
+
+ThumbnailCache::ThumbnailCache(text directory)
+    : m_directory(directory)
+    , m_opened(false)
+    , m_packSize(0)
+    , m_indexedSize(0)
+    , m_unsaved(0)
+#if defined(_WIN32) || defined(_WIN64)
+    , m_file(INVALID_HANDLE_VALUE)
+    , m_mapping(nullptr)
+#else
+    , m_fd(-1)
+#endif
+    , m_map(nullptr)
+    , m_mapSize(0)
+{
+}
+
+ThumbnailCache::~ThumbnailCache()
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    close();
+}
+
+std::string ThumbnailCache::make_key(std::string const& serial, std::string const& kind, std::string const& content, std::string const& date)
+{
+    return serial + '/' + kind + '/' + content + '/' + date;
+}
+
+std::uint64_t ThumbnailCache::hash(std::string const& key)
+{
+    HashTransferSink xxh;
+    xxh.write((const CrInt8u*)key.data(), key.size(), 0);
+    return xxh.digest();
+}
+
+bool ThumbnailCache::contains(std::string const& key)
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    Slot slot;
+    return open() && find(key, slot) != nullptr;
+}
+
+bool ThumbnailCache::lookup(std::string const& key, std::vector<CrInt8u>& data, CrInt32u& fileType)
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    Slot slot;
+    const CrInt8u* image = open() ? find(key, slot) : nullptr;
+    if (nullptr == image) {
+        return false;
+    }
+    data.assign(image, image + slot.size);
+    fileType = slot.fileType;
+    return true;
+}
+
+bool ThumbnailCache::insert(std::string const& key, const CrInt8u* data, CrInt64u size, CrInt32u fileType)
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    if (!open()) {
+        return false;
+    }
+    Slot slot;
+    if (find(key, slot)) {
+        return true; // same key, same image
+    }
+#if defined(_WIN32) || defined(_WIN64)
+    unmap(); // the file cannot grow under a mapped view
+#endif
+    PackRecordHeader header = { PACK_RECORD_MAGIC, (std::uint32_t)key.size(), fileType, 0, size };
+    CrInt64u offset = m_packSize;
+    if (!write_at(offset, &header, sizeof(header))
+        || !write_at(offset + sizeof(header), key.data(), key.size())
+        || !write_at(offset + sizeof(header) + key.size(), data, (size_t)size)) {
+        return false; // the next insert overwrites the partial record
+    }
+    slot.offset = offset;
+    slot.size = size;
+    slot.keySize = (CrInt32u)key.size();
+    slot.fileType = fileType;
+    m_index[hash(key)] = slot;
+    m_packSize = offset + sizeof(header) + key.size() + size;
+    if (++m_unsaved >= INDEX_SAVE_INTERVAL) {
+        save_index();
+    }
+    return true;
+}
+
+void ThumbnailCache::flush()
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    if (m_opened && m_unsaved > 0) {
+        save_index();
+    }
+}
+
+bool ThumbnailCache::open()
+{
+    if (m_opened) return true;
+
+    std::error_code ec;
+    fs::create_directories(fs::path(m_directory), ec);
+    fs::path packPath = fs::path(m_directory) / "thumbnails.pack";
+#if defined(_WIN32) || defined(_WIN64)
+    m_file = CreateFileW(packPath.wstring().c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (m_file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER fileSize;
+    GetFileSizeEx((HANDLE)m_file, &fileSize);
+    m_packSize = (CrInt64u)fileSize.QuadPart;
+#else
+    m_fd = ::open(packPath.c_str(), O_RDWR | O_CREAT, 0644);
+    if (m_fd < 0) return false;
+    struct stat st;
+    m_packSize = (fstat(m_fd, &st) == 0) ? (CrInt64u)st.st_size : 0;
+#endif
+    m_opened = true;
+
+    // Take the index as far as it goes, then pick up records appended after it
+    m_indexedSize = 0;
+    std::ifstream index(fs::path(m_directory) / "thumbnails.idx", std::ios::in | std::ios::binary);
+    IndexHeader header;
+    if (index.read((char*)&header, sizeof(header)) && header.magic == INDEX_MAGIC && header.packSize <= m_packSize) {
+        IndexEntry entry;
+        for (std::uint32_t i = 0; i < header.count && index.read((char*)&entry, sizeof(entry)); i++) {
+            m_index[entry.hash] = Slot{ entry.offset, entry.size, entry.keySize, entry.fileType };
+        }
+        m_indexedSize = header.packSize;
+    }
+    scan(m_indexedSize);
+    return true;
+}
+
+void ThumbnailCache::close()
+{
+    if (!m_opened) return;
+    if (m_unsaved > 0) {
+        save_index();
+    }
+    unmap();
+#if defined(_WIN32) || defined(_WIN64)
+    CloseHandle((HANDLE)m_file);
+    m_file = INVALID_HANDLE_VALUE;
+#else
+    ::close(m_fd);
+    m_fd = -1;
+#endif
+    m_opened = false;
+}
+
+void ThumbnailCache::scan(CrInt64u from)
+{
+    CrInt64u offset = from;
+    std::vector<char> key;
+    while (offset + sizeof(PackRecordHeader) <= m_packSize) {
+        PackRecordHeader header;
+        if (!read_at(offset, &header, sizeof(header)) || header.magic != PACK_RECORD_MAGIC) break;
+        CrInt64u end = offset + sizeof(header) + header.keySize + header.size;
+        if (end > m_packSize) break;
+        key.resize(header.keySize);
+        if (!read_at(offset + sizeof(header), key.data(), key.size())) break;
+        m_index[hash(std::string(key.begin(), key.end()))] = Slot{ offset, header.size, header.keySize, header.fileType };
+        m_unsaved++;
+        offset = end;
+    }
+    if (offset < m_packSize) {
+        // Drop a record cut short by a crash so later appends line up again
+#if defined(_WIN32) || defined(_WIN64)
+        LARGE_INTEGER pos;
+        pos.QuadPart = (LONGLONG)offset;
+        SetFilePointerEx((HANDLE)m_file, pos, NULL, FILE_BEGIN);
+        SetEndOfFile((HANDLE)m_file);
+#else
+        if (ftruncate(m_fd, (off_t)offset) != 0) {
+            tout << "Failed to truncate the thumbnail cache\n";
+        }
+#endif
+        m_packSize = offset;
+    }
+}
+
+bool ThumbnailCache::map()
+{
+    unmap();
+    if (m_packSize == 0) return false;
+#if defined(_WIN32) || defined(_WIN64)
+    m_mapping = CreateFileMapping((HANDLE)m_file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (nullptr == m_mapping) return false;
+    m_map = (CrInt8u*)MapViewOfFile((HANDLE)m_mapping, FILE_MAP_READ, 0, 0, 0);
+    if (nullptr == m_map) {
+        CloseHandle((HANDLE)m_mapping);
+        m_mapping = nullptr;
+        return false;
+    }
+#else
+    void* p = mmap(nullptr, (size_t)m_packSize, PROT_READ, MAP_SHARED, m_fd, 0);
+    if (p == MAP_FAILED) return false;
+    m_map = (CrInt8u*)p;
+#endif
+    m_mapSize = m_packSize;
+    return true;
+}
+
+void ThumbnailCache::unmap()
+{
+    if (nullptr == m_map) return;
+#if defined(_WIN32) || defined(_WIN64)
+    UnmapViewOfFile(m_map);
+    CloseHandle((HANDLE)m_mapping);
+    m_mapping = nullptr;
+#else
+    munmap(m_map, (size_t)m_mapSize);
+#endif
+    m_map = nullptr;
+    m_mapSize = 0;
+}
+
+const CrInt8u* ThumbnailCache::find(std::string const& key, Slot& slot)
+{
+    auto it = m_index.find(hash(key));
+    if (it == m_index.end()) return nullptr;
+    slot = it->second;
+    CrInt64u keyOffset = slot.offset + sizeof(PackRecordHeader);
+    CrInt64u end = keyOffset + slot.keySize + slot.size;
+    if (end > m_mapSize && !(end <= m_packSize && map())) return nullptr;
+    if (slot.keySize != key.size() || memcmp(m_map + keyOffset, key.data(), key.size()) != 0) return nullptr;
+    return m_map + keyOffset + slot.keySize;
+}
+
+bool ThumbnailCache::read_at(CrInt64u offset, void* buf, size_t size)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    OVERLAPPED ov = {};
+    ov.Offset = (DWORD)offset;
+    ov.OffsetHigh = (DWORD)(offset >> 32);
+    DWORD read = 0;
+    return ReadFile((HANDLE)m_file, buf, (DWORD)size, &read, &ov) && read == size;
+#else
+    return pread(m_fd, buf, size, (off_t)offset) == (ssize_t)size;
+#endif
+}
+
+bool ThumbnailCache::write_at(CrInt64u offset, const void* buf, size_t size)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    OVERLAPPED ov = {};
+    ov.Offset = (DWORD)offset;
+    ov.OffsetHigh = (DWORD)(offset >> 32);
+    DWORD written = 0;
+    return WriteFile((HANDLE)m_file, buf, (DWORD)size, &written, &ov) && written == size;
+#else
+    const char* p = (const char*)buf;
+    while (size > 0) {
+        ssize_t written = pwrite(m_fd, p, size, (off_t)offset);
+        if (written <= 0) return false;
+        p += written;
+        offset += written;
+        size -= written;
+    }
+    return true;
+#endif
+}
+
+void ThumbnailCache::save_index()
+{
+    fs::path path = fs::path(m_directory) / "thumbnails.idx";
+    fs::path temp = fs::path(m_directory) / "thumbnails.idx.tmp";
+    {
+        std::ofstream index(temp, std::ios::out | std::ios::binary | std::ios::trunc);
+        IndexHeader header = { INDEX_MAGIC, (std::uint32_t)m_index.size(), m_packSize };
+        index.write((const char*)&header, sizeof(header));
+        for (auto const& it : m_index) {
+            IndexEntry entry = { it.first, it.second.offset, it.second.size, it.second.keySize, it.second.fileType };
+            index.write((const char*)&entry, sizeof(entry));
+        }
+        if (!index) return;
+    }
+    std::error_code ec;
+    fs::rename(temp, path, ec);
+    if (!ec) {
+        m_indexedSize = m_packSize;
+        m_unsaved = 0;
+    }
+}
+
+} // namespace cli
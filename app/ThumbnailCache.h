@@ -0,0 +1,79 @@
+﻿#ifndef THUMBNAILCACHE_H
+#define THUMBNAILCACHE_H
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "CrTypes.h"
+#include "Text.h"
+
+namespace cli
+{
+
+// Local cache of thumbnails and screennails for content browsing.
+// Images are appended to one pack file (thumbnails.pack) that is memory-mapped
+// for reads; thumbnails.idx maps the XXH64 of each key to its record. Every
+// record also carries its key, so the index can be rebuilt from the pack
+// after a crash and a hash collision is never served as a hit.
+class ThumbnailCache
+{
+public:
+    explicit ThumbnailCache(text directory);
+    ~ThumbnailCache();
+
+    ThumbnailCache(const ThumbnailCache&) = delete;
+    ThumbnailCache& operator=(const ThumbnailCache&) = delete;
+
+    // serial: camera body serial (or id), kind: "T" thumbnail / "S" screennail,
+    // content: content handle or slot/contentId/fileId, date: capture time
+    static std::string make_key(std::string const& serial, std::string const& kind, std::string const& content, std::string const& date);
+
+    bool contains(std::string const& key);
+    bool lookup(std::string const& key, std::vector<CrInt8u>& data, CrInt32u& fileType);
+    bool insert(std::string const& key, const CrInt8u* data, CrInt64u size, CrInt32u fileType);
+
+    // Write the index now; also done every few inserts and on destruction
+    void flush();
+
+private:
+    struct Slot
+    {
+        CrInt64u offset;  // record start in the pack
+        CrInt64u size;    // image bytes
+        CrInt32u keySize;
+        CrInt32u fileType;
+    };
+
+    bool open();
+    void close();
+    bool map();
+    void unmap();
+    void scan(CrInt64u from);
+    bool read_at(CrInt64u offset, void* buf, size_t size);
+    bool write_at(CrInt64u offset, const void* buf, size_t size);
+    static std::uint64_t hash(std::string const& key);
+    const CrInt8u* find(std::string const& key, Slot& slot);
+    void save_index();
+
+    text m_directory;
+    bool m_opened;
+    std::mutex m_mtx;
+    std::unordered_map<std::uint64_t, Slot> m_index;
+    CrInt64u m_packSize;
+    CrInt64u m_indexedSize; // pack bytes covered by the index file
+    CrInt32u m_unsaved;
+#if defined(_WIN32) || defined(_WIN64)
+    void* m_file;    // HANDLE
+    void* m_mapping; // HANDLE
+#else
+    int m_fd;
+#endif
+    CrInt8u* m_map;
+    CrInt64u m_mapSize;
+};
+
+} // namespace cli
+
+#endif // !THUMBNAILCACHE_H
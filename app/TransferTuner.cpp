@@ -0,0 +1,92 @@
+﻿#include "TransferTuner.h"
+#include <fstream>
+
+namespace cli
+{
+
+TransferTuner::TransferTuner(text path)
+    : m_path(path)
+    , m_loaded(false)
+{
+}
+
+CrInt32u TransferTuner::division_size(text const& key, std::vector<CrInt32u> const& candidates)
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    load();
+    auto const& rates = m_rates[key];
+    CrInt32u best = candidates.empty() ? 0 : candidates.back();
+    double bestRate = 0.0;
+    for (auto size : candidates) {
+        auto it = rates.find(size);
+        if (it == rates.end()) {
+            return size; // still probing
+        }
+        if (it->second > bestRate) {
+            bestRate = it->second;
+            best = size;
+        }
+    }
+    return best;
+}
+
+void TransferTuner::record(text const& key, CrInt32u divisionSize, double mbps)
+{
+    if (mbps <= 0.0) return;
+    std::lock_guard<std::mutex> lock(m_mtx);
+    load();
+    auto& rates = m_rates[key];
+    auto it = rates.find(divisionSize);
+    if (it == rates.end()) {
+        rates[divisionSize] = mbps;
+    }
+    else {
+        it->second = (it->second * 3.0 + mbps) / 4.0;
+    }
+    save();
+}
+
+bool TransferTuner::settled(text const& key, std::vector<CrInt32u> const& candidates)
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    load();
+    auto const& rates = m_rates[key];
+    for (auto size : candidates) {
+        if (rates.find(size) == rates.end()) return false;
+    }
+    return true;
+}
+
+// One line per sample: <key> TAB <divisionSize> TAB <MB/s>
+void TransferTuner::load()
+{
+    if (m_loaded) return;
+    m_loaded = true;
+    std::basic_ifstream<text_char> file(m_path);
+    text line;
+    while (std::getline(file, line)) {
+        auto tab1 = line.find(TEXT('\t'));
+        auto tab2 = (tab1 == text::npos) ? text::npos : line.find(TEXT('\t'), tab1 + 1);
+        if (tab2 == text::npos) continue;
+        text_stringstream ss(line.substr(tab1 + 1));
+        CrInt32u size = 0;
+        double mbps = 0.0;
+        ss >> size >> mbps;
+        if (size > 0 && mbps > 0.0) {
+            m_rates[line.substr(0, tab1)][size] = mbps;
+        }
+    }
+}
+
+void TransferTuner::save() const
+{
+    std::basic_ofstream<text_char> file(m_path, std::ios::out | std::ios::trunc);
+    if (!file) return;
+    for (auto const& key : m_rates) {
+        for (auto const& rate : key.second) {
+            file << key.first << TEXT('\t') << rate.first << TEXT('\t') << rate.second << TEXT('\n');
+        }
+    }
+}
+
+} // namespace cli
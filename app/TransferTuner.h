@@ -0,0 +1,42 @@
+﻿#ifndef TRANSFERTUNER_H
+#define TRANSFERTUNER_H
+
+#include <map>
+#include <mutex>
+#include <vector>
+#include "CrTypes.h"
+#include "Text.h"
+
+namespace cli
+{
+
+// Picks the remote transfer division size per camera model and connection type.
+// divisionSize is fixed for the whole of one transfer request, so the first
+// transfers on a new key each try one untried candidate; once every candidate
+// has a measured rate the fastest one is used. Rates are kept in a small text
+// file so later sessions start from the settled size.
+class TransferTuner
+{
+public:
+    explicit TransferTuner(text path);
+
+    // Division size for the next transfer on this key
+    CrInt32u division_size(text const& key, std::vector<CrInt32u> const& candidates);
+    // Measured rate of a finished transfer; samples of a size already known are averaged in
+    void record(text const& key, CrInt32u divisionSize, double mbps);
+    // True once every candidate has been measured for this key
+    bool settled(text const& key, std::vector<CrInt32u> const& candidates);
+
+private:
+    void load();
+    void save() const;
+
+    text m_path;
+    bool m_loaded;
+    std::mutex m_mtx;
+    std::map<text, std::map<CrInt32u, double>> m_rates; // key -> divisionSize -> MB/s
+};
+
+} // namespace cli
+
+#endif // !TRANSFERTUNER_H
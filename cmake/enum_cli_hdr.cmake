@@ -10,6 +10,13 @@ set(__cli_hdrs
     ${__cli_hdr_dir}/Text.h
     ${__cli_hdr_dir}/MessageDefine.h
     ${__cli_hdr_dir}/OpenCVWrapper.h
+    ${__cli_hdr_dir}/RemoteTransferSink.h
+    ${__cli_hdr_dir}/TransferTuner.h
+    ${__cli_hdr_dir}/RemoteTransferEngine.h
+    ${__cli_hdr_dir}/RemoteTransferIngest.h
+    ${__cli_hdr_dir}/ThumbnailCache.h
+    ${__cli_hdr_dir}/Metrics.h
+    ${__cli_hdr_dir}/Logger.h
 )
 
 ## Use cli_srcs in project CMakeLists
@@ -12,6 +12,13 @@ set(__cli_srcs
     ${__cli_src_dir}/MessageDefine.cpp
     ${__cli_src_dir}/OpenCVWrapper.cpp
     ${__cli_src_dir}/CrDebugString.cpp
+    ${__cli_src_dir}/RemoteTransferSink.cpp
+    ${__cli_src_dir}/TransferTuner.cpp
+    ${__cli_src_dir}/RemoteTransferEngine.cpp
+    ${__cli_src_dir}/RemoteTransferIngest.cpp
+    ${__cli_src_dir}/ThumbnailCache.cpp
+    ${__cli_src_dir}/Metrics.cpp
+    ${__cli_src_dir}/Logger.cpp
 )
 
 ## Use cli_srcs in project CMakeLists
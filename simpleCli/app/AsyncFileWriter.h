@@ -0,0 +1,331 @@
+/* Asynchronous, batched file writer for data produced on SDK callback threads */
+
+#ifndef ASYNCFILEWRITER_H
+#define ASYNCFILEWRITER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#if defined(_WIN32) || defined(_WIN64)
+  #include <fcntl.h>
+  #include <io.h>
+  #include <malloc.h>
+  #include <share.h>
+  #include <sys/stat.h>
+#else
+  #include <fcntl.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+// The producer (one SDK callback thread) copies each unit into a lock-free
+// single-producer/single-consumer ring and returns. A writer thread drains
+// the ring in large block-aligned chunks, so disk latency never reaches the
+// callback. If the ring fills up the producer waits rather than dropping
+// data, and the stall is counted. close() may run while a producer is still
+// inside write(): the writer thread keeps going until every such call has
+// returned, so the ring is never freed under a copy.
+class AsyncFileWriter
+{
+public:
+    enum SyncPolicy {
+        Sync_None,      // leave it to the OS
+        Sync_OnClose,   // fdatasync once the stream ends
+        Sync_EveryChunk // fdatasync after every chunk written
+    };
+
+    struct Options {
+        size_t bufferSize = 64 * 1024 * 1024; // ring size, rounded up to a power of two
+        size_t chunkSize = 4 * 1024 * 1024;   // preferred write size
+        bool directIO = false;                // O_DIRECT (Linux) / F_NOCACHE (macOS)
+        SyncPolicy sync = Sync_OnClose;
+        std::chrono::milliseconds flushInterval{200}; // write a partial chunk after this long
+    };
+
+    struct Stats {
+        uint64_t bytesWritten = 0;
+        uint64_t writes = 0;
+        uint64_t producerStalls = 0; // times write() found the ring full
+        uint64_t maxFill = 0;        // high-water mark of the ring
+    };
+
+    AsyncFileWriter() {}
+    ~AsyncFileWriter() { close(); }
+
+    AsyncFileWriter(const AsyncFileWriter&) = delete;
+    AsyncFileWriter& operator=(const AsyncFileWriter&) = delete;
+
+#if defined(_WIN32) || defined(_WIN64)
+    bool open(const std::wstring& path) { return open(path, Options()); }
+    bool open(const std::wstring& path, const Options& options)
+    {
+        close();
+        int fd = -1;
+        if (_wsopen_s(&fd, path.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _SH_DENYWR, _S_IREAD | _S_IWRITE) != 0) return false;
+        return start(fd, options);
+    }
+#else
+    bool open(const std::string& path) { return open(path, Options()); }
+    bool open(const std::string& path, const Options& options)
+    {
+        close();
+        int flags = O_WRONLY | O_CREAT | O_TRUNC;
+  #if defined(O_DIRECT)
+        if (options.directIO) flags |= O_DIRECT;
+  #endif
+        int fd = ::open(path.c_str(), flags, 0644);
+  #if defined(O_DIRECT)
+        // Some filesystems (tmpfs, network mounts) refuse O_DIRECT; fall back to buffered
+        if (fd < 0 && options.directIO) fd = ::open(path.c_str(), flags & ~O_DIRECT, 0644);
+  #endif
+        if (fd < 0) return false;
+  #if defined(__APPLE__)
+        if (options.directIO) fcntl(fd, F_NOCACHE, 1);
+  #endif
+        return start(fd, options);
+    }
+#endif
+
+    bool isOpen() const { return m_open.load(std::memory_order_acquire); }
+    bool failed() const { return m_failed.load(std::memory_order_acquire); }
+
+    // Producer side. Copies the data into the ring; only blocks if the ring is full.
+    bool write(const void* data, size_t size)
+    {
+        if (!m_open.load(std::memory_order_acquire)) return false;
+        InFlight inFlight(m_writers);
+        // After announcing ourselves: either finish() is seen here, or the writer thread sees us
+        if (m_finishing.load(std::memory_order_seq_cst)) return false;
+
+        const uint8_t* src = (const uint8_t*)data;
+        uint64_t head = m_head.load(std::memory_order_relaxed);
+        while (size > 0) {
+            uint64_t tail = m_tail.load(std::memory_order_acquire);
+            size_t space = m_capacity - (size_t)(head - tail);
+            if (space == 0) {
+                if (m_failed.load(std::memory_order_relaxed)) return false;
+                m_stats.producerStalls++;
+                m_cond.notify_one();
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+                continue;
+            }
+
+            size_t n = size < space ? size : space;
+            size_t pos = (size_t)(head & (m_capacity - 1));
+            size_t first = n < m_capacity - pos ? n : m_capacity - pos;
+            memcpy(m_buf + pos, src, first);
+            memcpy(m_buf, src + first, n - first);
+
+            head += n;
+            src += n;
+            size -= n;
+            m_head.store(head, std::memory_order_release);
+
+            uint64_t fill = head - tail;
+            if (fill > m_stats.maxFill) m_stats.maxFill = fill;
+            if (fill >= m_chunkSize) m_cond.notify_one();
+        }
+        return true;
+    }
+
+    // Mark the end of the stream without waiting. Safe to call from a callback.
+    void finish()
+    {
+        if (!m_open.load(std::memory_order_acquire)) return;
+        m_finishing.store(true, std::memory_order_seq_cst);
+        m_cond.notify_one();
+    }
+
+    // Flush everything, sync per policy and close the file. Returns false if any write failed.
+    bool close()
+    {
+        if (!m_thread.joinable()) return !failed();
+        finish();
+        m_thread.join();
+        m_open.store(false, std::memory_order_release);
+        freeBuffer();
+        return !failed();
+    }
+
+    // Valid after close()
+    Stats stats() const { return m_stats; }
+
+private:
+    static const size_t kBlockSize = 4096;
+
+    int m_fd = -1;
+    uint8_t* m_buf = nullptr;
+    size_t m_capacity = 0;
+    size_t m_chunkSize = 0;
+    Options m_options;
+    Stats m_stats;
+
+    // Monotonic byte counters; the ring position is counter & (capacity - 1)
+    alignas(64) std::atomic<uint64_t> m_head{0};
+    alignas(64) std::atomic<uint64_t> m_tail{0};
+
+    std::atomic<bool> m_open{false};
+    std::atomic<bool> m_finishing{false};
+    std::atomic<bool> m_failed{false};
+    std::atomic<int> m_writers{0}; // producers inside write()
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::thread m_thread;
+
+    struct InFlight {
+        std::atomic<int>& count;
+        explicit InFlight(std::atomic<int>& c) : count(c) { count.fetch_add(1, std::memory_order_seq_cst); }
+        ~InFlight() { count.fetch_sub(1, std::memory_order_release); }
+    };
+
+    static size_t roundUpPow2(size_t v)
+    {
+        size_t p = kBlockSize;
+        while (p < v) p <<= 1;
+        return p;
+    }
+
+    bool start(int fd, const Options& options)
+    {
+        m_options = options;
+        m_capacity = roundUpPow2(options.bufferSize);
+        m_chunkSize = (options.chunkSize + kBlockSize - 1) / kBlockSize * kBlockSize;
+        if (m_chunkSize == 0 || m_chunkSize > m_capacity / 2) m_chunkSize = m_capacity / 2;
+#if defined(_WIN32) || defined(_WIN64)
+        m_buf = (uint8_t*)_aligned_malloc(m_capacity, kBlockSize);
+#else
+        void* p = nullptr;
+        m_buf = (posix_memalign(&p, kBlockSize, m_capacity) == 0) ? (uint8_t*)p : nullptr;
+#endif
+        if (!m_buf) {
+            closeFd(fd);
+            return false;
+        }
+
+        m_fd = fd;
+        m_stats = Stats();
+        m_head.store(0);
+        m_tail.store(0);
+        m_failed.store(false);
+        m_finishing.store(false);
+        m_open.store(true, std::memory_order_release);
+        m_thread = std::thread([this]() { run(); });
+        return true;
+    }
+
+    void freeBuffer()
+    {
+#if defined(_WIN32) || defined(_WIN64)
+        _aligned_free(m_buf);
+#else
+        free(m_buf);
+#endif
+        m_buf = nullptr;
+    }
+
+    static void closeFd(int fd)
+    {
+#if defined(_WIN32) || defined(_WIN64)
+        _close(fd);
+#else
+        ::close(fd);
+#endif
+    }
+
+    void syncFd()
+    {
+#if defined(_WIN32) || defined(_WIN64)
+        _commit(m_fd);
+#elif defined(__APPLE__)
+        fsync(m_fd);
+#else
+        fdatasync(m_fd);
+#endif
+    }
+
+    bool writeFully(const uint8_t* p, size_t n)
+    {
+        while (n > 0) {
+#if defined(_WIN32) || defined(_WIN64)
+            int w = _write(m_fd, p, (unsigned int)n);
+#else
+            ssize_t w = ::write(m_fd, p, n);
+#endif
+            if (w <= 0) return false;
+            p += w;
+            n -= (size_t)w;
+        }
+        m_stats.writes++;
+        return true;
+    }
+
+    // Direct I/O needs block-sized writes; the unaligned tail is written buffered at the end
+    void dropDirectIO()
+    {
+#if defined(O_DIRECT)
+        int flags = fcntl(m_fd, F_GETFL);
+        if (flags >= 0 && (flags & O_DIRECT)) fcntl(m_fd, F_SETFL, flags & ~O_DIRECT);
+#endif
+    }
+
+    void run()
+    {
+        auto lastWrite = std::chrono::steady_clock::now();
+        for (;;) {
+            bool finishing = m_finishing.load(std::memory_order_seq_cst);
+            // Producers that got into write() before finish() still complete their copy
+            bool drained = finishing && m_writers.load(std::memory_order_seq_cst) == 0;
+            // Read after the flags so nothing published before them is missed
+            uint64_t tail = m_tail.load(std::memory_order_relaxed);
+            uint64_t avail = m_head.load(std::memory_order_acquire) - tail;
+
+            bool stale = avail > 0 && std::chrono::steady_clock::now() - lastWrite >= m_options.flushInterval;
+            size_t n = 0;
+            if (avail >= m_chunkSize || finishing || stale) {
+                size_t pos = (size_t)(tail & (m_capacity - 1));
+                n = (size_t)avail;
+                if (n > m_chunkSize) n = m_chunkSize;
+                if (n > m_capacity - pos) n = m_capacity - pos;
+                if (m_options.directIO && n % kBlockSize != 0) {
+                    if (n >= kBlockSize) n -= n % kBlockSize;
+                    else if (finishing) dropDirectIO();
+                    else n = 0;
+                }
+            }
+
+            if (n > 0) {
+                size_t pos = (size_t)(tail & (m_capacity - 1));
+                if (!m_failed.load(std::memory_order_relaxed)) {
+                    if (!writeFully(m_buf + pos, n)) {
+                        m_failed.store(true, std::memory_order_release);
+                    } else {
+                        m_stats.bytesWritten += n;
+                        if (m_options.sync == Sync_EveryChunk) syncFd();
+                    }
+                }
+                // On failure keep consuming so the producer never blocks forever
+                m_tail.store(tail + n, std::memory_order_release);
+                lastWrite = std::chrono::steady_clock::now();
+                continue;
+            }
+
+            if (drained && avail == 0) break;
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cond.wait_for(lock, std::chrono::milliseconds(20));
+        }
+
+        if (!m_failed.load() && m_options.sync != Sync_None) syncFd();
+        closeFd(m_fd);
+        m_fd = -1;
+    }
+};
+
+#endif // ASYNCFILEWRITER_H
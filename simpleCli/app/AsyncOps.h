@@ -0,0 +1,182 @@
+/* Per-device tracker that matches SDK callbacks to pending operations */
+
+#ifndef ASYNCOPS_H
+#define ASYNCOPS_H
+
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// Every wait on a callback (OnConnected, OnDisconnected,
+// OnPropertyChangedCodes, OnNotifyContentsTransfer, ...) is registered here
+// as its own operation, keyed by kind and by a property code or content
+// handle, and gets its own future. Any number of operations can be pending
+// at once: a callback completes every operation that matches it, and a
+// caller that gives up only drops its own entry.
+class AsyncOps
+{
+public:
+    enum class Kind { Connect, Disconnect, PropertyChange, ContentsTransfer };
+    static constexpr uint64_t kAnyKey = ~0ULL;
+
+    struct Result {
+        bool ok = false;
+        bool timedOut = false;
+        uint32_t code = 0; // error, warning or notify code from the callback
+    };
+
+    // Pending operation. Destroying or cancelling it before completion
+    // removes it from the tracker.
+    class Op
+    {
+    public:
+        Op() = default;
+        Op(Op&& other) noexcept { *this = std::move(other); }
+        Op& operator=(Op&& other) noexcept
+        {
+            if (this != &other) {
+                cancel();
+                m_ops = other.m_ops;
+                m_id = other.m_id;
+                m_future = std::move(other.m_future);
+                other.m_ops = nullptr;
+            }
+            return *this;
+        }
+        Op(const Op&) = delete;
+        Op& operator=(const Op&) = delete;
+        ~Op() { cancel(); }
+
+        bool valid() const { return m_future.valid(); }
+        std::future<Result>& future() { return m_future; }
+
+        Result wait()
+        {
+            if (!m_future.valid()) return Result{};
+            Result r = m_future.get();
+            m_ops = nullptr;
+            return r;
+        }
+
+        // On timeout the operation is cancelled
+        Result waitFor(std::chrono::steady_clock::duration timeout)
+        {
+            return waitUntil(std::chrono::steady_clock::now() + timeout);
+        }
+
+        Result waitUntil(std::chrono::steady_clock::time_point deadline)
+        {
+            if (!m_future.valid()) return Result{};
+            if (m_future.wait_until(deadline) != std::future_status::ready) {
+                cancel();
+                Result r;
+                r.timedOut = true;
+                return r;
+            }
+            return wait();
+        }
+
+        void cancel()
+        {
+            if (m_ops) m_ops->remove(m_id);
+            m_ops = nullptr;
+            m_future = std::future<Result>();
+        }
+
+    private:
+        friend class AsyncOps;
+        Op(AsyncOps* ops, uint64_t id, std::future<Result> future)
+            : m_ops(ops), m_id(id), m_future(std::move(future)) {}
+
+        AsyncOps* m_ops = nullptr;
+        uint64_t m_id = 0;
+        std::future<Result> m_future;
+    };
+
+    AsyncOps() = default;
+    AsyncOps(const AsyncOps&) = delete;
+    AsyncOps& operator=(const AsyncOps&) = delete;
+
+    // Register before issuing the request, so an early callback is not missed
+    Op expect(Kind kind, uint64_t key = kAnyKey)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        uint64_t id = m_nextId++;
+        m_pending.push_back(Pending{ id, kind, key, std::promise<Result>() });
+        return Op(this, id, m_pending.back().promise.get_future());
+    }
+
+    // Complete every pending operation of this kind whose key matches
+    // (kAnyKey on either side matches all). Returns how many were completed.
+    size_t complete(Kind kind, uint64_t key, bool ok, uint32_t code = 0)
+    {
+        std::vector<std::promise<Result>> done;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (size_t i = 0; i < m_pending.size();) {
+                Pending& p = m_pending[i];
+                if (p.kind == kind && (p.key == kAnyKey || key == kAnyKey || p.key == key)) {
+                    done.push_back(std::move(p.promise));
+                    if (i + 1 != m_pending.size()) m_pending[i] = std::move(m_pending.back());
+                    m_pending.pop_back();
+                }
+                else {
+                    i++;
+                }
+            }
+        }
+        Result result;
+        result.ok = ok;
+        result.code = code;
+        for (auto& promise : done) promise.set_value(result);
+        return done.size();
+    }
+
+    size_t pending() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_pending.size();
+    }
+
+    // Wait for all operations against one deadline; the ones still pending
+    // are cancelled. Invalid (already cancelled) operations are skipped.
+    static bool waitAll(std::vector<Op>& ops, std::chrono::steady_clock::duration timeout)
+    {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        bool allOk = true;
+        for (auto& op : ops) {
+            if (!op.valid()) continue;
+            if (!op.waitUntil(deadline).ok) allOk = false;
+        }
+        return allOk;
+    }
+
+private:
+    struct Pending {
+        uint64_t id;
+        Kind kind;
+        uint64_t key;
+        std::promise<Result> promise;
+    };
+
+    mutable std::mutex m_mutex;
+    std::vector<Pending> m_pending;
+    uint64_t m_nextId = 1;
+
+    void remove(uint64_t id)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (size_t i = 0; i < m_pending.size(); i++) {
+            if (m_pending[i].id == id) {
+                if (i + 1 != m_pending.size()) m_pending[i] = std::move(m_pending.back());
+                m_pending.pop_back();
+                return;
+            }
+        }
+    }
+};
+
+#endif // ASYNCOPS_H
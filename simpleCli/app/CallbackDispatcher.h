@@ -0,0 +1,356 @@
+/* Queue SDK device callbacks and run them on an application-owned thread */
+
+#ifndef CALLBACKDISPATCHER_H
+#define CALLBACKDISPATCHER_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#include "IDeviceCallback.h"
+#include "Metrics.h"
+
+// Bounded multi-producer / single-consumer ring (Vyukov's sequence-numbered
+// cells). Producers never take a lock; tryPush fails when the ring is full.
+template <typename T, size_t N>
+class BoundedMpscQueue
+{
+    static_assert((N & (N - 1)) == 0, "capacity must be a power of two");
+
+public:
+    BoundedMpscQueue()
+    {
+        for (size_t i = 0; i < N; i++) m_cells[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    bool tryPush(const T& value)
+    {
+        size_t pos = m_enqueue.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = m_cells[pos & (N - 1)];
+            size_t seq = cell.seq.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+            if (diff == 0) {
+                if (m_enqueue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = value;
+                    cell.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0) {
+                return false; // full
+            }
+            else {
+                pos = m_enqueue.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Consumer thread only
+    bool tryPop(T& value)
+    {
+        size_t pos = m_dequeue.load(std::memory_order_relaxed);
+        Cell& cell = m_cells[pos & (N - 1)];
+        size_t seq = cell.seq.load(std::memory_order_acquire);
+        if ((intptr_t)seq - (intptr_t)(pos + 1) < 0) return false; // empty
+        value = cell.value;
+        cell.seq.store(pos + N, std::memory_order_release);
+        m_dequeue.store(pos + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    size_t size() const
+    {
+        size_t enq = m_enqueue.load(std::memory_order_relaxed);
+        size_t deq = m_dequeue.load(std::memory_order_relaxed);
+        return enq > deq ? enq - deq : 0;
+    }
+
+    static constexpr size_t capacity() { return N; }
+
+private:
+    struct Cell {
+        std::atomic<size_t> seq;
+        T value;
+    };
+
+    Cell m_cells[N];
+    alignas(64) std::atomic<size_t> m_enqueue{0};
+    alignas(64) std::atomic<size_t> m_dequeue{0};
+};
+
+// One IDeviceCallback event, copied out of the SDK's arguments
+struct DeviceEvent {
+    enum class Type : uint8_t {
+        Connected, Disconnected, Error, Warning, WarningExt,
+        PropertyChanged, PropertyChangedCodes, LvPropertyChanged, LvPropertyChangedCodes,
+        CompleteDownload, NotifyContentsTransfer, NotifyFTPTransferResult, RemoteTransferContentsListChanged,
+    };
+    static const int kMaxCodes = 32;   // longer code lists are split over several events
+    static const int kMaxName = 256;   // file names are truncated to this
+
+    Type type;
+    SCRSDK::IDeviceCallback* target;
+    std::chrono::steady_clock::time_point queuedAt;
+    CrInt32u value;      // version, error, warning, notify, ...
+    CrInt32 params[3];   // OnWarningExt params, other callbacks' extra arguments
+    CrInt32u count;
+    CrInt32u codes[kMaxCodes];
+    CrChar name[kMaxName];
+};
+
+// Every callback returns after one copy into the queue; a dispatcher thread
+// replays the events, in order, on the real handlers. Handlers may then log,
+// take locks or call the SDK without holding up the SDK's own thread.
+// Connection events (Connected, Disconnected, Error), warnings and transfer
+// notifications wait for room when the queue is full; anything else is
+// dropped and counted. Warnings carry reconnect and transfer state the
+// handlers act on, so losing one would leave a camera in the wrong state.
+class CallbackDispatcher
+{
+public:
+    static const size_t kCapacity = 1024;
+
+    static CallbackDispatcher& instance()
+    {
+        static CallbackDispatcher dispatcher;
+        return dispatcher;
+    }
+
+    void start()
+    {
+        if (m_thread.joinable()) return;
+        m_stop = false;
+        m_thread = std::thread([this]() { run(); });
+    }
+
+    // Handles what is already queued, then stops
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_cond.notify_one();
+        if (m_thread.joinable()) m_thread.join();
+    }
+
+    // Wait until everything queued so far has been handled (not from a handler)
+    void drain()
+    {
+        if (!m_thread.joinable() || std::this_thread::get_id() == m_thread.get_id()) return;
+        uint64_t target = m_queued.load();
+        while (m_handled.load() < target) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    void post(DeviceEvent& event, bool mustDeliver)
+    {
+        event.queuedAt = std::chrono::steady_clock::now();
+        if (!m_thread.joinable()) {
+            dispatch(event); // not started: behave like a direct callback
+            return;
+        }
+        while (!m_queue.tryPush(event)) {
+            if (!mustDeliver) {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            std::this_thread::yield();
+        }
+        m_queued.fetch_add(1);
+        size_t depth = m_queue.size();
+        size_t high = m_highWater.load(std::memory_order_relaxed);
+        while (depth > high && !m_highWater.compare_exchange_weak(high, depth, std::memory_order_relaxed)) {}
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_sleeping.load()) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_cond.notify_one();
+        }
+    }
+
+    size_t depth() const { return m_queue.size(); }
+    size_t highWater() const { return m_highWater.load(std::memory_order_relaxed); }
+    uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+    uint64_t handled() const { return m_handled.load(std::memory_order_relaxed); }
+
+    // Time from the SDK callback to the end of its handler
+    void setLatencyHistogram(MetricHistogram* histogram) { m_latency = histogram; }
+
+private:
+    BoundedMpscQueue<DeviceEvent, kCapacity> m_queue;
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::atomic<bool> m_sleeping{false};
+    bool m_stop = false;
+    std::atomic<uint64_t> m_queued{0};
+    std::atomic<uint64_t> m_handled{0};
+    std::atomic<uint64_t> m_dropped{0};
+    std::atomic<size_t> m_highWater{0};
+    MetricHistogram* m_latency = nullptr;
+
+    CallbackDispatcher() = default;
+    ~CallbackDispatcher() { stop(); }
+
+    void run()
+    {
+        DeviceEvent event;
+        while (true) {
+            while (m_queue.tryPop(event)) {
+                dispatch(event);
+                m_handled.fetch_add(1);
+            }
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (m_stop) {
+                lock.unlock();
+                while (m_queue.tryPop(event)) {
+                    dispatch(event);
+                    m_handled.fetch_add(1);
+                }
+                break;
+            }
+            m_sleeping = true;
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (m_queue.size() == 0) {
+                // The timeout only covers a push racing with this check
+                m_cond.wait_for(lock, std::chrono::milliseconds(50));
+            }
+            m_sleeping = false;
+        }
+    }
+
+    void dispatch(DeviceEvent& e)
+    {
+        SCRSDK::IDeviceCallback* t = e.target;
+        switch (e.type) {
+        case DeviceEvent::Type::Connected:              t->OnConnected((SCRSDK::DeviceConnectionVersioin)e.value); break;
+        case DeviceEvent::Type::Disconnected:           t->OnDisconnected(e.value); break;
+        case DeviceEvent::Type::Error:                  t->OnError(e.value); break;
+        case DeviceEvent::Type::Warning:                t->OnWarning(e.value); break;
+        case DeviceEvent::Type::WarningExt:             t->OnWarningExt(e.value, e.params[0], e.params[1], e.params[2]); break;
+        case DeviceEvent::Type::PropertyChanged:        t->OnPropertyChanged(); break;
+        case DeviceEvent::Type::PropertyChangedCodes:   t->OnPropertyChangedCodes(e.count, e.codes); break;
+        case DeviceEvent::Type::LvPropertyChanged:      t->OnLvPropertyChanged(); break;
+        case DeviceEvent::Type::LvPropertyChangedCodes: t->OnLvPropertyChangedCodes(e.count, e.codes); break;
+        case DeviceEvent::Type::CompleteDownload:       t->OnCompleteDownload(e.name, e.value); break;
+        case DeviceEvent::Type::NotifyContentsTransfer:
+            t->OnNotifyContentsTransfer(e.value, (SCRSDK::CrContentHandle)e.params[0], e.name[0] ? e.name : nullptr);
+            break;
+        case DeviceEvent::Type::NotifyFTPTransferResult:
+            t->OnNotifyFTPTransferResult(e.value, (CrInt32u)e.params[0], (CrInt32u)e.params[1]);
+            break;
+        case DeviceEvent::Type::RemoteTransferContentsListChanged:
+            t->OnNotifyRemoteTransferContentsListChanged(e.value, (CrInt32u)e.params[0], (CrInt32u)e.params[1]);
+            break;
+        }
+        if (m_latency) m_latency->observe(std::chrono::steady_clock::now() - e.queuedAt);
+    }
+};
+
+// Pass this to SCRSDK::Connect in place of the real callback object. Callbacks
+// that hand over a data buffer (remote transfer data, playback data) are not
+// queued; the target does not get them.
+class QueuedDeviceCallback : public SCRSDK::IDeviceCallback
+{
+public:
+    explicit QueuedDeviceCallback(SCRSDK::IDeviceCallback* target) : m_target(target) {}
+
+    void OnConnected(SCRSDK::DeviceConnectionVersioin version) override { post(DeviceEvent::Type::Connected, (CrInt32u)version, true); }
+    void OnDisconnected(CrInt32u error) override { post(DeviceEvent::Type::Disconnected, error, true); }
+    void OnError(CrInt32u error) override { post(DeviceEvent::Type::Error, error, true); }
+    void OnWarning(CrInt32u warning) override { post(DeviceEvent::Type::Warning, warning, true); }
+
+    void OnWarningExt(CrInt32u warning, CrInt32 param1, CrInt32 param2, CrInt32 param3) override
+    {
+        DeviceEvent e = make(DeviceEvent::Type::WarningExt, warning);
+        e.params[0] = param1;
+        e.params[1] = param2;
+        e.params[2] = param3;
+        CallbackDispatcher::instance().post(e, false);
+    }
+
+    void OnPropertyChanged() override { post(DeviceEvent::Type::PropertyChanged, 0, false); }
+    void OnLvPropertyChanged() override { post(DeviceEvent::Type::LvPropertyChanged, 0, false); }
+    void OnPropertyChangedCodes(CrInt32u num, CrInt32u* codes) override { postCodes(DeviceEvent::Type::PropertyChangedCodes, num, codes); }
+    void OnLvPropertyChangedCodes(CrInt32u num, CrInt32u* codes) override { postCodes(DeviceEvent::Type::LvPropertyChangedCodes, num, codes); }
+
+    void OnCompleteDownload(CrChar* filename, CrInt32u type) override
+    {
+        DeviceEvent e = make(DeviceEvent::Type::CompleteDownload, type);
+        copyName(e, filename);
+        CallbackDispatcher::instance().post(e, true);
+    }
+
+    void OnNotifyContentsTransfer(CrInt32u notify, SCRSDK::CrContentHandle handle, CrChar* filename) override
+    {
+        DeviceEvent e = make(DeviceEvent::Type::NotifyContentsTransfer, notify);
+        e.params[0] = (CrInt32)handle;
+        copyName(e, filename);
+        CallbackDispatcher::instance().post(e, true);
+    }
+
+    void OnNotifyFTPTransferResult(CrInt32u notify, CrInt32u numOfSuccess, CrInt32u numOfFail) override
+    {
+        DeviceEvent e = make(DeviceEvent::Type::NotifyFTPTransferResult, notify);
+        e.params[0] = (CrInt32)numOfSuccess;
+        e.params[1] = (CrInt32)numOfFail;
+        CallbackDispatcher::instance().post(e, false);
+    }
+
+    void OnNotifyRemoteTransferContentsListChanged(CrInt32u notify, CrInt32u slotNumber, CrInt32u addSize) override
+    {
+        DeviceEvent e = make(DeviceEvent::Type::RemoteTransferContentsListChanged, notify);
+        e.params[0] = (CrInt32)slotNumber;
+        e.params[1] = (CrInt32)addSize;
+        CallbackDispatcher::instance().post(e, false);
+    }
+
+private:
+    SCRSDK::IDeviceCallback* m_target;
+
+    DeviceEvent make(DeviceEvent::Type type, CrInt32u value)
+    {
+        DeviceEvent e;
+        e.type = type;
+        e.target = m_target;
+        e.value = value;
+        e.params[0] = e.params[1] = e.params[2] = 0;
+        e.count = 0;
+        e.name[0] = 0;
+        return e;
+    }
+
+    void post(DeviceEvent::Type type, CrInt32u value, bool mustDeliver)
+    {
+        DeviceEvent e = make(type, value);
+        CallbackDispatcher::instance().post(e, mustDeliver);
+    }
+
+    void postCodes(DeviceEvent::Type type, CrInt32u num, const CrInt32u* codes)
+    {
+        // Property changes confirm settings being waited on, so they are kept too
+        for (CrInt32u done = 0; done < num;) {
+            DeviceEvent e = make(type, 0);
+            e.count = std::min<CrInt32u>(num - done, DeviceEvent::kMaxCodes);
+            std::copy(codes + done, codes + done + e.count, e.codes);
+            done += e.count;
+            CallbackDispatcher::instance().post(e, true);
+        }
+    }
+
+    static void copyName(DeviceEvent& e, const CrChar* name)
+    {
+        int i = 0;
+        if (name) {
+            for (; i < DeviceEvent::kMaxName - 1 && name[i]; i++) e.name[i] = name[i];
+        }
+        e.name[i] = 0;
+    }
+};
+
+#endif // CALLBACKDISPATCHER_H
@@ -5,6 +5,7 @@
 #include <fstream>
 #include <future>
 #include <iostream>
+#include <map>
 #include <mutex>
 #include <sstream>
 #include <stdexcept>
@@ -57,6 +58,8 @@ int64_t  m_device_handle = 0;
 std::mutex m_eventPromiseMutex;
 uint32_t m_setDPCode = 0;
 std::promise<void>* m_eventPromise = nullptr;
+// time of CrNotify_ContentsTransfer_Start for the current pull (guarded by m_eventPromiseMutex)
+std::chrono::steady_clock::time_point m_pullStarted;
 void setEventPromise(std::promise<void>* dp)
 {
     std::lock_guard<std::mutex> lock(m_eventPromiseMutex);
@@ -126,6 +129,7 @@ public:
         std::lock_guard<std::mutex> lock(m_eventPromiseMutex);
         switch(notify) {
         case SCRSDK::CrNotify_ContentsTransfer_Start:
+            m_pullStarted = std::chrono::steady_clock::now();
             break;
         case SCRSDK::CrNotify_ContentsTransfer_Complete:
             CrCout << filename;
@@ -199,6 +203,58 @@ CrString _getModelId(const SCRSDK::ICrCameraObjectInfo* objInfo)
     return CrString(objInfo->GetModel()).append(CRSTR(" (")).append(id).append(CRSTR(")"));
 }
 
+#if defined(__linux__)
+// PartialBuffer tuning: the first Original pulls on a model/connection each try one
+// candidate size, then the fastest is kept. Rates are remembered across sessions.
+#define PARTIAL_BUFFER_TUNING_FILE "PartialBufferTuning.txt"
+const CrInt32u _partialBufferCandidates[] = {8, 16, 32, 64}; // MB
+
+// one line per sample: <model> <connection> TAB <MB> TAB <MB/s>
+std::map<CrInt32u, double> _loadPartialBufferRates(const std::string& key)
+{
+    std::map<CrInt32u, double> rates;
+    std::ifstream file(PARTIAL_BUFFER_TUNING_FILE);
+    std::string line;
+    while(std::getline(file, line)) {
+        size_t tab = line.find('\t');
+        if(tab == std::string::npos || line.substr(0, tab) != key) continue;
+        std::istringstream ss(line.substr(tab + 1));
+        CrInt32u size = 0;
+        double mbps = 0;
+        if(ss >> size >> mbps) rates[size] = mbps;
+    }
+    return rates;
+}
+
+void _savePartialBufferRates(const std::string& key, const std::map<CrInt32u, double>& rates)
+{
+    std::vector<std::string> others;
+    {
+        std::ifstream file(PARTIAL_BUFFER_TUNING_FILE);
+        std::string line;
+        while(std::getline(file, line)) {
+            if(line.substr(0, line.find('\t')) != key) others.push_back(line);
+        }
+    }
+    std::ofstream file(PARTIAL_BUFFER_TUNING_FILE, std::ios::trunc);
+    for(auto& line : others) file << line << "\n";
+    for(auto& rate : rates) file << key << '\t' << rate.first << '\t' << rate.second << "\n";
+}
+
+// first untried candidate, then the fastest one
+CrInt32u _nextPartialBuffer(const std::map<CrInt32u, double>& rates)
+{
+    CrInt32u best = 0;
+    double bestRate = 0;
+    for(CrInt32u size : _partialBufferCandidates) {
+        auto it = rates.find(size);
+        if(it == rates.end()) return size;
+        if(it->second > bestRate) { bestRate = it->second; best = size; }
+    }
+    return best;
+}
+#endif
+
 SCRSDK::CrError _getIdPassword(SCRSDK::ICrCameraObjectInfo* objInfo, std::string& fingerprint, std::string& userId, std::string& userPassword)
 {
     char fpBuff[128] = {0};
@@ -262,6 +318,12 @@ int main(void)
     SCRSDK::CrMtpFolderInfo* folderList = nullptr;
     SCRSDK::CrContentHandle* contentsHandleList = nullptr;
     std::string inputLine;
+  #if defined(__linux__)
+    std::string tuningKey;
+    std::map<CrInt32u, double> partialBufferRates; // MB -> MB/s
+    bool partialBufferTuning = false;
+    CrInt32u bufferSize = 0;
+  #endif
 
   #if defined(__APPLE__)
     #define MAC_MAX_PATH 255
@@ -353,11 +415,19 @@ int main(void)
 
     #if defined(__linux__)
     {
-        CrInt32u bufferSize = 0;
+        tuningKey = std::string(objInfo->GetModel()) + " " + objInfo->GetConnectionTypeName();
+        partialBufferRates = _loadPartialBufferRates(tuningKey);
         err = SCRSDK::GetDeviceSetting(m_device_handle, SCRSDK::Setting_Key_PartialBuffer, &bufferSize);
         if(err) GotoError("", err);
-        printf("PartialBuffer %d[MB]->", bufferSize); std::getline(std::cin, inputLine);
-        if(inputLine != "") {
+        // empty input keeps the current value, "a" tunes it from the rates measured so far
+        printf("PartialBuffer %d[MB] (a:auto)->", bufferSize); std::getline(std::cin, inputLine);
+        if(inputLine == "a") {
+            partialBufferTuning = true;
+            bufferSize = _nextPartialBuffer(partialBufferRates);
+            printf("PartialBuffer %d[MB] (%s)\n", bufferSize, partialBufferRates.size() < sizeof(_partialBufferCandidates) / sizeof(CrInt32u) ? "probing" : "tuned");
+            err = SCRSDK::SetDeviceSetting(m_device_handle, SCRSDK::Setting_Key_PartialBuffer, bufferSize);
+            if(err) GotoError("", err);
+        } else if(inputLine != "") {
             try { bufferSize = stoi(inputLine); } catch(const std::exception&) { GotoError("", 0); }
             err = SCRSDK::SetDeviceSetting(m_device_handle, SCRSDK::Setting_Key_PartialBuffer, bufferSize);
             if(err) GotoError("", err);
@@ -369,6 +439,7 @@ int main(void)
         int index = 0;
         SCRSDK::CrFolderHandle folderHandle;
         SCRSDK::CrContentHandle contentHandle;
+        CrInt64u contentSize = 0;
         // select folder
         {
             CrInt32u f_nums = 0;
@@ -407,6 +478,7 @@ int main(void)
             err = SCRSDK::GetContentsDetailInfo(m_device_handle, contentsHandleList[index-1], &contentsDetailInfo);
             if(err) GotoError("", err);
             contentHandle = contentsDetailInfo.handle;
+            contentSize = contentsDetailInfo.contentSize;
             SCRSDK::ReleaseContentsHandleList(m_device_handle, contentsHandleList);
             contentsHandleList = nullptr;
         }
@@ -422,7 +494,11 @@ int main(void)
             } else {
                 std::promise<void> eventPromise;
                 std::future<void> eventFuture = eventPromise.get_future();
-                setEventPromise(&eventPromise);
+                {
+                    std::lock_guard<std::mutex> lock(m_eventPromiseMutex);
+                    m_eventPromise = &eventPromise;
+                    m_pullStarted = std::chrono::steady_clock::time_point();
+                }
                 if(index == 1) {
                     err = SCRSDK::PullContentsFile(m_device_handle, contentHandle, SCRSDK::CrPropertyStillImageTransSize_Original);
                 } else {
@@ -434,6 +510,34 @@ int main(void)
                     eventFuture.get();
                 } catch(const std::exception&) GotoError("", 0);
 
+              #if defined(__linux__)
+                // a file shorter than two buffers mostly measures the per-file overhead;
+                // timed from the transfer start notification, leaving out the request latency
+                std::chrono::steady_clock::time_point started;
+                {
+                    std::lock_guard<std::mutex> lock(m_eventPromiseMutex);
+                    started = m_pullStarted;
+                }
+                if(partialBufferTuning && index == 1 && started != std::chrono::steady_clock::time_point()
+                   && contentSize >= (CrInt64u)bufferSize * 2 * 1024 * 1024) {
+                    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+                    double mbps = contentSize / (1024.0 * 1024.0) / sec;
+                    auto it = partialBufferRates.find(bufferSize);
+                    partialBufferRates[bufferSize] = (it == partialBufferRates.end()) ? mbps : (it->second * 3 + mbps) / 4;
+                    _savePartialBufferRates(tuningKey, partialBufferRates);
+
+                    CrInt32u next = _nextPartialBuffer(partialBufferRates);
+                    printf("PartialBuffer %d[MB]: %.1f[MB/s]", bufferSize, mbps);
+                    if(next != bufferSize) {
+                        printf(" -> %d[MB]", next);
+                        err = SCRSDK::SetDeviceSetting(m_device_handle, SCRSDK::Setting_Key_PartialBuffer, next);
+                        if(err) GotoError("", err);
+                        bufferSize = next;
+                    }
+                    printf("\n");
+                }
+              #endif
+
                 std::this_thread::sleep_for(std::chrono::milliseconds(100));  // workaround for GetDateFolderList error
             }
         }
@@ -0,0 +1,767 @@
+/* Streaming fragmented MP4 muxer for movie playback data (H.264/HEVC + AAC) */
+
+#ifndef FRAGMENTEDMP4MUXER_H
+#define FRAGMENTEDMP4MUXER_H
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+// Takes the Annex-B video access units and AAC frames delivered by
+// OnReceivePlaybackData, together with their pts/dts, and emits an init
+// segment followed by self-contained moof+mdat fragments. Each fragment
+// starts on a video keyframe, so the output is playable while it is being
+// written and can also be served to late joiners starting at any fragment.
+//
+// The pts clock is not documented by the SDK; it is inferred from the frame
+// spacing and the frame rate reported with each video unit (param1), unless
+// Options::ptsClock is set.
+class FragmentedMp4Muxer
+{
+public:
+    enum SegmentType {
+        Segment_Init,       // ftyp+moov; must precede every other segment
+        Segment_KeyFragment,// moof+mdat starting with a video keyframe
+        Segment_Fragment    // moof+mdat continuing the previous one
+    };
+    using Sink = std::function<void(const uint8_t* data, size_t size, SegmentType type)>;
+
+    struct Options {
+        uint32_t fragmentMillis = 1000; // cut at the first keyframe after this long
+        int64_t ptsClock = 0;           // ticks per second of pts/dts, 0 = detect
+    };
+
+    FragmentedMp4Muxer(Sink sink) : m_sink(sink) {}
+    FragmentedMp4Muxer(Sink sink, const Options& options) : m_sink(sink), m_options(options) {}
+
+    FragmentedMp4Muxer(const FragmentedMp4Muxer&) = delete;
+    FragmentedMp4Muxer& operator=(const FragmentedMp4Muxer&) = delete;
+
+    // One access unit per call. frameRate is param1 of OnReceivePlaybackData.
+    void addVideo(const uint8_t* data, size_t size, int64_t pts, int64_t dts, int32_t frameRate)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_finished) return;
+
+        bool key = false;
+        m_frame.clear();
+        forEachNal(data, size, [&](const uint8_t* nal, size_t len) {
+            if (m_codec == Codec_Unknown) detectCodec(nal[0]);
+            int type = nalType(nal[0]);
+            if (isParameterSet(type)) {
+                storeParameterSet(type, nal, len);
+                return; // carried in the sample entry
+            }
+            if (isAccessUnitDelimiter(type)) return;
+            if (isKeyframe(type)) key = true;
+            put32(m_frame, (uint32_t)len);
+            m_frame.insert(m_frame.end(), nal, nal + len);
+        });
+        if (m_frame.empty()) return;
+
+        if (dts < 0) dts = pts;
+        if (!m_videoStarted) {
+            // decoding has to start at a keyframe with known parameter sets
+            if (!key || !parseVideoConfig() || dts < 0) return;
+            m_videoStarted = true;
+            m_baseDts = dts;
+            m_frameRate = frameRate > 1000 ? frameRate / 100.0 : frameRate;
+        } else {
+            if (dts < 0 || dts <= m_held.dts) dts = m_held.dts + m_defaultDuration;
+            if (!m_clockKnown) detectClock(dts - m_held.dts);
+            commitHeldFrame(dts - m_held.dts, key, dts);
+        }
+        if (pts < 0) pts = dts;
+
+        m_held.dts = dts;
+        m_held.cts = (int32_t)(pts - dts);
+        m_held.key = key;
+        m_held.data.swap(m_frame);
+        m_holding = true;
+    }
+
+    // One or more ADTS frames (or a single raw AAC frame) per call.
+    void addAudio(const uint8_t* data, size_t size, int64_t pts, int32_t sampleRate, int32_t channels)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_finished || !m_videoStarted || pts < m_baseDts) return;
+        if (m_initWritten && !m_hasAudio) return;
+
+        if (size >= 7 && data[0] == 0xFF && (data[1] & 0xF0) == 0xF0) {
+            while (size >= 7 && data[0] == 0xFF && (data[1] & 0xF0) == 0xF0) {
+                size_t header = (data[1] & 0x01) ? 7 : 9;
+                size_t frameLen = ((size_t)(data[3] & 0x03) << 11) | ((size_t)data[4] << 3) | (data[5] >> 5);
+                if (frameLen <= header || frameLen > size) break;
+                if (!m_audioConfigured) {
+                    int objectType = (data[2] >> 6) + 1;
+                    int sfIndex = (data[2] >> 2) & 0x0F;
+                    int channelConfig = ((data[2] & 0x01) << 2) | (data[3] >> 6);
+                    configureAudio(objectType, sfIndex, channelConfig, pts);
+                }
+                addAudioSample(data + header, frameLen - header);
+                data += frameLen;
+                size -= frameLen;
+            }
+        } else if (size > 0 && sampleRate > 0) {
+            if (!m_audioConfigured) configureAudio(2 /*AAC LC*/, sampleRateIndex(sampleRate), channels, pts);
+            addAudioSample(data, size);
+        }
+    }
+
+    // Write out everything still pending. No more data is accepted afterwards.
+    void finish()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_finished) return;
+        m_finished = true;
+        if (m_holding) commitHeldFrame(m_lastDuration ? m_lastDuration : m_defaultDuration, false, m_held.dts);
+        flushFragment();
+    }
+
+    uint32_t fragments() const { return m_sequence; }
+    bool hasVideo() const { return m_videoStarted; }
+
+private:
+    enum Codec { Codec_Unknown, Codec_AVC, Codec_HEVC };
+
+    struct Sample {
+        uint32_t size;
+        uint32_t duration;
+        int32_t cts;
+        bool key;
+    };
+
+    struct HeldFrame {
+        std::vector<uint8_t> data;
+        int64_t dts = 0;
+        int32_t cts = 0;
+        bool key = false;
+    };
+
+    Sink m_sink;
+    Options m_options;
+    std::mutex m_mutex;
+    bool m_finished = false;
+
+    // video
+    Codec m_codec = Codec_Unknown;
+    std::vector<uint8_t> m_vps, m_sps, m_pps;
+    uint32_t m_width = 0, m_height = 0;
+    uint8_t m_profileSpace = 0, m_tier = 0, m_profile = 0, m_level = 0;
+    uint32_t m_compat = 0;
+    uint64_t m_constraints = 0;
+    uint32_t m_chromaFormat = 1, m_bitDepthLuma = 8, m_bitDepthChroma = 8;
+    uint32_t m_subLayers = 1;
+    bool m_temporalIdNested = false;
+
+    bool m_videoStarted = false;
+    bool m_clockKnown = false;
+    double m_frameRate = 0;
+    int64_t m_clock = 90000;
+    int64_t m_baseDts = 0;
+    int64_t m_defaultDuration = 3000;
+    int64_t m_lastDuration = 0;
+    HeldFrame m_held;
+    bool m_holding = false;
+    std::vector<uint8_t> m_frame;
+    std::vector<Sample> m_videoSamples;
+    std::vector<uint8_t> m_videoData;
+    int64_t m_fragmentDts = -1; // dts of the first pending video sample
+
+    // audio
+    bool m_audioConfigured = false;
+    bool m_hasAudio = false;
+    uint8_t m_asc[2] = {0, 0};
+    uint32_t m_sampleRate = 0;
+    uint32_t m_channels = 0;
+    int64_t m_firstAudioPts = 0;
+    uint64_t m_audioTime = 0;         // in samples
+    bool m_audioTimeKnown = false;
+    std::vector<Sample> m_audioSamples;
+    std::vector<uint8_t> m_audioData;
+
+    bool m_initWritten = false;
+    uint32_t m_sequence = 0;
+    std::vector<uint8_t> m_out;
+
+    static const uint32_t kVideoTrack = 1;
+    static const uint32_t kAudioTrack = 2;
+
+    // ---------------------------------------------------------------------------
+    // Byte helpers
+    // ---------------------------------------------------------------------------
+
+    static void put8(std::vector<uint8_t>& b, uint32_t v) { b.push_back((uint8_t)v); }
+    static void put16(std::vector<uint8_t>& b, uint32_t v) { put8(b, v >> 8); put8(b, v); }
+    static void put24(std::vector<uint8_t>& b, uint32_t v) { put8(b, v >> 16); put16(b, v); }
+    static void put32(std::vector<uint8_t>& b, uint32_t v) { put16(b, v >> 16); put16(b, v); }
+    static void put64(std::vector<uint8_t>& b, uint64_t v) { put32(b, (uint32_t)(v >> 32)); put32(b, (uint32_t)v); }
+    static void putTag(std::vector<uint8_t>& b, const char* t) { b.insert(b.end(), t, t + 4); }
+    static void putZeros(std::vector<uint8_t>& b, size_t n) { b.insert(b.end(), n, 0); }
+    static void patch32(std::vector<uint8_t>& b, size_t at, uint32_t v)
+    {
+        b[at] = (uint8_t)(v >> 24); b[at + 1] = (uint8_t)(v >> 16); b[at + 2] = (uint8_t)(v >> 8); b[at + 3] = (uint8_t)v;
+    }
+
+    // Boxes are written with a placeholder size that is patched on close
+    static size_t beginBox(std::vector<uint8_t>& b, const char* type)
+    {
+        size_t at = b.size();
+        put32(b, 0);
+        putTag(b, type);
+        return at;
+    }
+    static size_t beginFullBox(std::vector<uint8_t>& b, const char* type, uint8_t version, uint32_t flags)
+    {
+        size_t at = beginBox(b, type);
+        put8(b, version);
+        put24(b, flags);
+        return at;
+    }
+    static void endBox(std::vector<uint8_t>& b, size_t at) { patch32(b, at, (uint32_t)(b.size() - at)); }
+
+    static void putMatrix(std::vector<uint8_t>& b)
+    {
+        const uint32_t m[9] = {0x00010000, 0, 0, 0, 0x00010000, 0, 0, 0, 0x40000000};
+        for (uint32_t v : m) put32(b, v);
+    }
+
+    // ---------------------------------------------------------------------------
+    // Bitstream parsing
+    // ---------------------------------------------------------------------------
+
+    class BitReader
+    {
+    public:
+        // Strips emulation prevention bytes
+        BitReader(const uint8_t* p, size_t n)
+        {
+            m_rbsp.reserve(n);
+            int zeros = 0;
+            for (size_t i = 0; i < n; i++) {
+                if (zeros >= 2 && p[i] == 0x03) { zeros = 0; continue; }
+                zeros = (p[i] == 0) ? zeros + 1 : 0;
+                m_rbsp.push_back(p[i]);
+            }
+        }
+        uint32_t bits(int n)
+        {
+            uint32_t v = 0;
+            while (n-- > 0) {
+                size_t byte = m_pos >> 3;
+                uint32_t bit = byte < m_rbsp.size() ? (m_rbsp[byte] >> (7 - (m_pos & 7))) & 1 : 0;
+                if (byte >= m_rbsp.size()) m_overrun = true;
+                v = (v << 1) | bit;
+                m_pos++;
+            }
+            return v;
+        }
+        void skip(size_t n) { m_pos += n; }
+        uint32_t ue()
+        {
+            int zeros = 0;
+            while (bits(1) == 0 && zeros < 32 && !m_overrun) zeros++;
+            if (zeros >= 32) return 0;
+            return ((1u << zeros) - 1) + bits(zeros);
+        }
+        int32_t se()
+        {
+            uint32_t v = ue();
+            return (v & 1) ? (int32_t)((v + 1) / 2) : -(int32_t)(v / 2);
+        }
+        bool ok() const { return !m_overrun; }
+    private:
+        std::vector<uint8_t> m_rbsp;
+        size_t m_pos = 0;
+        bool m_overrun = false;
+    };
+
+    template <typename F>
+    static void forEachNal(const uint8_t* p, size_t n, F f)
+    {
+        size_t i = 0, start = SIZE_MAX;
+        while (i + 3 <= n) {
+            if (p[i] == 0 && p[i + 1] == 0 && p[i + 2] == 1) {
+                if (start != SIZE_MAX) {
+                    size_t end = i;
+                    while (end > start && p[end - 1] == 0) end--;
+                    if (end > start) f(p + start, end - start);
+                }
+                i += 3;
+                start = i;
+            } else {
+                i++;
+            }
+        }
+        if (start != SIZE_MAX && start < n) f(p + start, n - start);
+    }
+
+    void detectCodec(uint8_t header)
+    {
+        // first unit of an access unit: AUD/VPS/SPS for HEVC, AUD/SPS for AVC
+        int hevcType = (header >> 1) & 0x3F;
+        if (hevcType == 32 || hevcType == 33 || hevcType == 35) m_codec = Codec_HEVC;
+        else if ((header & 0x1F) == 7 || (header & 0x1F) == 9) m_codec = Codec_AVC;
+    }
+    int nalType(uint8_t header) const { return m_codec == Codec_HEVC ? (header >> 1) & 0x3F : header & 0x1F; }
+    bool isParameterSet(int t) const { return m_codec == Codec_HEVC ? (t >= 32 && t <= 34) : (t == 7 || t == 8); }
+    bool isAccessUnitDelimiter(int t) const { return m_codec == Codec_HEVC ? t == 35 : t == 9; }
+    bool isKeyframe(int t) const { return m_codec == Codec_HEVC ? (t >= 16 && t <= 21) : t == 5; }
+
+    void storeParameterSet(int type, const uint8_t* nal, size_t len)
+    {
+        std::vector<uint8_t>& dst = (m_codec == Codec_HEVC) ? (type == 32 ? m_vps : type == 33 ? m_sps : m_pps)
+                                                            : (type == 7 ? m_sps : m_pps);
+        if (dst.empty()) dst.assign(nal, nal + len);
+    }
+
+    bool parseVideoConfig()
+    {
+        if (m_sps.size() < 4 || m_pps.empty()) return false;
+        if (m_codec == Codec_HEVC) return !m_vps.empty() && parseHevcSps();
+        if (m_codec == Codec_AVC) return parseAvcSps();
+        return false;
+    }
+
+    bool parseHevcSps()
+    {
+        BitReader r(m_sps.data() + 2, m_sps.size() - 2);
+        r.bits(4); // sps_video_parameter_set_id
+        uint32_t maxSubLayersMinus1 = r.bits(3);
+        m_temporalIdNested = r.bits(1) != 0;
+        m_subLayers = maxSubLayersMinus1 + 1;
+        m_profileSpace = (uint8_t)r.bits(2);
+        m_tier = (uint8_t)r.bits(1);
+        m_profile = (uint8_t)r.bits(5);
+        m_compat = r.bits(32);
+        m_constraints = ((uint64_t)r.bits(16) << 32) | r.bits(32);
+        m_level = (uint8_t)r.bits(8);
+        bool profilePresent[8] = {}, levelPresent[8] = {};
+        for (uint32_t i = 0; i < maxSubLayersMinus1; i++) {
+            profilePresent[i] = r.bits(1) != 0;
+            levelPresent[i] = r.bits(1) != 0;
+        }
+        if (maxSubLayersMinus1 > 0) {
+            for (uint32_t i = maxSubLayersMinus1; i < 8; i++) r.bits(2);
+        }
+        for (uint32_t i = 0; i < maxSubLayersMinus1; i++) {
+            if (profilePresent[i]) r.skip(88);
+            if (levelPresent[i]) r.skip(8);
+        }
+        r.ue(); // sps_seq_parameter_set_id
+        m_chromaFormat = r.ue();
+        if (m_chromaFormat == 3) r.bits(1);
+        uint32_t width = r.ue(), height = r.ue();
+        if (r.bits(1)) { // conformance_window_flag
+            uint32_t subW = (m_chromaFormat == 1 || m_chromaFormat == 2) ? 2 : 1;
+            uint32_t subH = (m_chromaFormat == 1) ? 2 : 1;
+            uint32_t left = r.ue(), right = r.ue(), top = r.ue(), bottom = r.ue();
+            width -= subW * (left + right);
+            height -= subH * (top + bottom);
+        }
+        m_bitDepthLuma = r.ue() + 8;
+        m_bitDepthChroma = r.ue() + 8;
+        m_width = width;
+        m_height = height;
+        return r.ok() && width && height;
+    }
+
+    bool parseAvcSps()
+    {
+        BitReader r(m_sps.data() + 1, m_sps.size() - 1);
+        m_profile = (uint8_t)r.bits(8);
+        m_compat = r.bits(8);
+        m_level = (uint8_t)r.bits(8);
+        r.ue(); // seq_parameter_set_id
+        m_chromaFormat = 1;
+        bool separateColourPlane = false;
+        if (m_profile == 100 || m_profile == 110 || m_profile == 122 || m_profile == 244 || m_profile == 44 ||
+            m_profile == 83 || m_profile == 86 || m_profile == 118 || m_profile == 128 || m_profile == 138 ||
+            m_profile == 139 || m_profile == 134 || m_profile == 135) {
+            m_chromaFormat = r.ue();
+            if (m_chromaFormat == 3) separateColourPlane = r.bits(1) != 0;
+            m_bitDepthLuma = r.ue() + 8;
+            m_bitDepthChroma = r.ue() + 8;
+            r.bits(1); // qpprime_y_zero_transform_bypass_flag
+            if (r.bits(1)) { // seq_scaling_matrix_present_flag
+                for (int i = 0; i < ((m_chromaFormat != 3) ? 8 : 12); i++) {
+                    if (!r.bits(1)) continue;
+                    int size = i < 6 ? 16 : 64, last = 8, next = 8;
+                    for (int j = 0; j < size; j++) {
+                        if (next != 0) next = (last + r.se() + 256) % 256;
+                        last = (next == 0) ? last : next;
+                    }
+                }
+            }
+        }
+        r.ue(); // log2_max_frame_num_minus4
+        uint32_t pocType = r.ue();
+        if (pocType == 0) {
+            r.ue();
+        } else if (pocType == 1) {
+            r.bits(1);
+            r.se();
+            r.se();
+            uint32_t n = r.ue();
+            for (uint32_t i = 0; i < n && r.ok(); i++) r.se();
+        }
+        r.ue(); // max_num_ref_frames
+        r.bits(1);
+        uint32_t width = (r.ue() + 1) * 16;
+        uint32_t heightUnits = r.ue() + 1;
+        uint32_t frameMbsOnly = r.bits(1);
+        if (!frameMbsOnly) r.bits(1);
+        r.bits(1); // direct_8x8_inference_flag
+        uint32_t height = heightUnits * 16 * (2 - frameMbsOnly);
+        if (r.bits(1)) { // frame_cropping_flag
+            uint32_t chroma = separateColourPlane ? 0 : m_chromaFormat;
+            uint32_t cropX = (chroma == 0 || chroma == 3) ? 1 : 2;
+            uint32_t cropY = ((chroma == 1) ? 2 : 1) * (2 - frameMbsOnly);
+            uint32_t left = r.ue(), right = r.ue(), top = r.ue(), bottom = r.ue();
+            width -= cropX * (left + right);
+            height -= cropY * (top + bottom);
+        }
+        m_width = width;
+        m_height = height;
+        return r.ok() && width && height;
+    }
+
+    // Snap the observed frame spacing to the nearest common media clock
+    void detectClock(int64_t delta)
+    {
+        if (delta <= 0) return;
+        m_clockKnown = true;
+        if (m_options.ptsClock > 0) {
+            m_clock = m_options.ptsClock;
+        } else {
+            const int64_t clocks[] = {1000, 90000, 1000000, 10000000};
+            double fps = m_frameRate > 0 ? m_frameRate : 30;
+            double est = delta * fps;
+            double best = 1e300;
+            for (int64_t c : clocks) {
+                double d = std::fabs(std::log(est / (double)c));
+                if (d < best) { best = d; m_clock = c; }
+            }
+        }
+        if (m_frameRate > 0) m_defaultDuration = (int64_t)(m_clock / m_frameRate + 0.5);
+        else m_defaultDuration = delta;
+    }
+
+    static int sampleRateIndex(int32_t rate)
+    {
+        const int32_t rates[] = {96000, 88200, 64000, 48000, 44100, 32000, 24000, 22050, 16000, 12000, 11025, 8000, 7350};
+        for (int i = 0; i < 13; i++) {
+            if (rates[i] == rate) return i;
+        }
+        return 3;
+    }
+
+    void configureAudio(int objectType, int sfIndex, int channelConfig, int64_t pts)
+    {
+        const uint32_t rates[] = {96000, 88200, 64000, 48000, 44100, 32000, 24000, 22050, 16000, 12000, 11025, 8000, 7350};
+        if (sfIndex > 12 || channelConfig <= 0) return;
+        m_sampleRate = rates[sfIndex];
+        m_channels = (uint32_t)channelConfig;
+        m_asc[0] = (uint8_t)((objectType << 3) | (sfIndex >> 1));
+        m_asc[1] = (uint8_t)(((sfIndex & 1) << 7) | (channelConfig << 3));
+        m_firstAudioPts = pts;
+        m_audioConfigured = true;
+    }
+
+    void addAudioSample(const uint8_t* p, size_t n)
+    {
+        if (!m_audioConfigured) return;
+        m_audioSamples.push_back({(uint32_t)n, 1024, 0, true});
+        m_audioData.insert(m_audioData.end(), p, p + n);
+    }
+
+    // The held frame's duration is only known once the next frame arrives
+    void commitHeldFrame(int64_t duration, bool nextIsKey, int64_t nextDts)
+    {
+        if (duration <= 0) duration = m_defaultDuration;
+        m_lastDuration = duration;
+        if (m_fragmentDts < 0) m_fragmentDts = m_held.dts;
+        m_videoSamples.push_back({(uint32_t)m_held.data.size(), (uint32_t)duration, m_held.cts, m_held.key});
+        m_videoData.insert(m_videoData.end(), m_held.data.begin(), m_held.data.end());
+        m_holding = false;
+
+        int64_t pending = nextDts - m_fragmentDts;
+        int64_t target = (int64_t)m_options.fragmentMillis * m_clock / 1000;
+        if ((nextIsKey && pending >= target) || pending >= 4 * target) flushFragment();
+    }
+
+    // ---------------------------------------------------------------------------
+    // Segment writers
+    // ---------------------------------------------------------------------------
+
+    void writeInit()
+    {
+        m_hasAudio = m_audioConfigured;
+        std::vector<uint8_t>& b = m_out;
+        b.clear();
+
+        size_t ftyp = beginBox(b, "ftyp");
+        putTag(b, "isom");
+        put32(b, 0x200);
+        putTag(b, "isom");
+        putTag(b, "iso6");
+        putTag(b, "mp41");
+        putTag(b, m_codec == Codec_HEVC ? "hvc1" : "avc1");
+        endBox(b, ftyp);
+
+        size_t moov = beginBox(b, "moov");
+        size_t mvhd = beginFullBox(b, "mvhd", 0, 0);
+        put32(b, 0); put32(b, 0);      // creation/modification time
+        put32(b, 1000); put32(b, 0);   // timescale, duration
+        put32(b, 0x00010000); put16(b, 0x0100);
+        putZeros(b, 10);
+        putMatrix(b);
+        putZeros(b, 24);
+        put32(b, m_hasAudio ? 3 : 2);  // next_track_ID
+        endBox(b, mvhd);
+
+        writeTrack(b, true);
+        if (m_hasAudio) writeTrack(b, false);
+
+        size_t mvex = beginBox(b, "mvex");
+        for (uint32_t id = kVideoTrack; id <= (m_hasAudio ? kAudioTrack : kVideoTrack); id++) {
+            size_t trex = beginFullBox(b, "trex", 0, 0);
+            put32(b, id); put32(b, 1); put32(b, 0); put32(b, 0); put32(b, 0);
+            endBox(b, trex);
+        }
+        endBox(b, mvex);
+        endBox(b, moov);
+
+        m_initWritten = true;
+        m_sink(b.data(), b.size(), Segment_Init);
+    }
+
+    void writeTrack(std::vector<uint8_t>& b, bool video)
+    {
+        size_t trak = beginBox(b, "trak");
+        size_t tkhd = beginFullBox(b, "tkhd", 0, 0x3);
+        put32(b, 0); put32(b, 0);
+        put32(b, video ? kVideoTrack : kAudioTrack);
+        put32(b, 0); put32(b, 0);      // reserved, duration
+        putZeros(b, 8);
+        put16(b, 0); put16(b, video ? 0 : 1); // layer, alternate_group
+        put16(b, video ? 0 : 0x0100); put16(b, 0);
+        putMatrix(b);
+        put32(b, video ? m_width << 16 : 0);
+        put32(b, video ? m_height << 16 : 0);
+        endBox(b, tkhd);
+
+        size_t mdia = beginBox(b, "mdia");
+        size_t mdhd = beginFullBox(b, "mdhd", 0, 0);
+        put32(b, 0); put32(b, 0);
+        put32(b, video ? (uint32_t)m_clock : m_sampleRate);
+        put32(b, 0);
+        put16(b, 0x55C4); put16(b, 0); // "und"
+        endBox(b, mdhd);
+
+        size_t hdlr = beginFullBox(b, "hdlr", 0, 0);
+        put32(b, 0);
+        putTag(b, video ? "vide" : "soun");
+        putZeros(b, 12);
+        const char* name = video ? "VideoHandler" : "SoundHandler";
+        b.insert(b.end(), name, name + strlen(name) + 1);
+        endBox(b, hdlr);
+
+        size_t minf = beginBox(b, "minf");
+        if (video) {
+            size_t vmhd = beginFullBox(b, "vmhd", 0, 1);
+            putZeros(b, 8);
+            endBox(b, vmhd);
+        } else {
+            size_t smhd = beginFullBox(b, "smhd", 0, 0);
+            putZeros(b, 4);
+            endBox(b, smhd);
+        }
+        size_t dinf = beginBox(b, "dinf");
+        size_t dref = beginFullBox(b, "dref", 0, 0);
+        put32(b, 1);
+        size_t url = beginFullBox(b, "url ", 0, 1);
+        endBox(b, url);
+        endBox(b, dref);
+        endBox(b, dinf);
+
+        size_t stbl = beginBox(b, "stbl");
+        size_t stsd = beginFullBox(b, "stsd", 0, 0);
+        put32(b, 1);
+        if (video) writeVideoSampleEntry(b);
+        else writeAudioSampleEntry(b);
+        endBox(b, stsd);
+        const char* empty[] = {"stts", "stsc", "stco"};
+        for (const char* t : empty) {
+            size_t box = beginFullBox(b, t, 0, 0);
+            put32(b, 0);
+            endBox(b, box);
+        }
+        size_t stsz = beginFullBox(b, "stsz", 0, 0);
+        put32(b, 0); put32(b, 0);
+        endBox(b, stsz);
+        endBox(b, stbl);
+        endBox(b, minf);
+        endBox(b, mdia);
+        endBox(b, trak);
+    }
+
+    void writeVideoSampleEntry(std::vector<uint8_t>& b)
+    {
+        size_t entry = beginBox(b, m_codec == Codec_HEVC ? "hvc1" : "avc1");
+        putZeros(b, 6); put16(b, 1);   // data_reference_index
+        putZeros(b, 16);
+        put16(b, m_width); put16(b, m_height);
+        put32(b, 0x00480000); put32(b, 0x00480000);
+        put32(b, 0); put16(b, 1);      // frame_count
+        putZeros(b, 32);               // compressorname
+        put16(b, 0x0018); put16(b, 0xFFFF);
+
+        if (m_codec == Codec_HEVC) {
+            size_t hvcC = beginBox(b, "hvcC");
+            put8(b, 1);
+            put8(b, (m_profileSpace << 6) | (m_tier << 5) | m_profile);
+            put32(b, m_compat);
+            put16(b, (uint32_t)(m_constraints >> 32)); put32(b, (uint32_t)m_constraints);
+            put8(b, m_level);
+            put16(b, 0xF000); put8(b, 0xFC);
+            put8(b, 0xFC | m_chromaFormat);
+            put8(b, 0xF8 | (m_bitDepthLuma - 8));
+            put8(b, 0xF8 | (m_bitDepthChroma - 8));
+            put16(b, 0);
+            put8(b, ((m_subLayers & 7) << 3) | ((m_temporalIdNested ? 1 : 0) << 2) | 3);
+            put8(b, 3);
+            const std::vector<uint8_t>* sets[] = {&m_vps, &m_sps, &m_pps};
+            const uint8_t types[] = {32, 33, 34};
+            for (int i = 0; i < 3; i++) {
+                put8(b, 0x80 | types[i]);
+                put16(b, 1);
+                put16(b, (uint32_t)sets[i]->size());
+                b.insert(b.end(), sets[i]->begin(), sets[i]->end());
+            }
+            endBox(b, hvcC);
+        } else {
+            size_t avcC = beginBox(b, "avcC");
+            put8(b, 1);
+            put8(b, m_profile); put8(b, m_compat); put8(b, m_level);
+            put8(b, 0xFF); put8(b, 0xE1);
+            put16(b, (uint32_t)m_sps.size());
+            b.insert(b.end(), m_sps.begin(), m_sps.end());
+            put8(b, 1);
+            put16(b, (uint32_t)m_pps.size());
+            b.insert(b.end(), m_pps.begin(), m_pps.end());
+            if (m_profile == 100 || m_profile == 110 || m_profile == 122 || m_profile == 144) {
+                put8(b, 0xFC | m_chromaFormat);
+                put8(b, 0xF8 | (m_bitDepthLuma - 8));
+                put8(b, 0xF8 | (m_bitDepthChroma - 8));
+                put8(b, 0);
+            }
+            endBox(b, avcC);
+        }
+        endBox(b, entry);
+    }
+
+    void writeAudioSampleEntry(std::vector<uint8_t>& b)
+    {
+        size_t entry = beginBox(b, "mp4a");
+        putZeros(b, 6); put16(b, 1);
+        putZeros(b, 8);
+        put16(b, m_channels); put16(b, 16);
+        put16(b, 0); put16(b, 0);
+        put32(b, m_sampleRate << 16);
+
+        size_t esds = beginFullBox(b, "esds", 0, 0);
+        put8(b, 0x03); put8(b, 3 + 2 + 13 + 2 + 2 + 3);     // ES_Descriptor
+        put16(b, 0); put8(b, 0);
+        put8(b, 0x04); put8(b, 13 + 2 + 2);                  // DecoderConfigDescriptor
+        put8(b, 0x40); put8(b, 0x15);
+        put24(b, 0); put32(b, 0); put32(b, 0);
+        put8(b, 0x05); put8(b, 2);                           // DecoderSpecificInfo
+        put8(b, m_asc[0]); put8(b, m_asc[1]);
+        put8(b, 0x06); put8(b, 1); put8(b, 0x02);            // SLConfigDescriptor
+        endBox(b, esds);
+        endBox(b, entry);
+    }
+
+    static void writeTraf(std::vector<uint8_t>& b, uint32_t trackId, uint64_t decodeTime,
+                          const std::vector<Sample>& samples, bool video, size_t& dataOffsetAt)
+    {
+        size_t traf = beginBox(b, "traf");
+        size_t tfhd = beginFullBox(b, "tfhd", 0, 0x020000); // default-base-is-moof
+        put32(b, trackId);
+        endBox(b, tfhd);
+
+        size_t tfdt = beginFullBox(b, "tfdt", 1, 0);
+        put64(b, decodeTime);
+        endBox(b, tfdt);
+
+        uint32_t flags = 0x000001 | 0x000100 | 0x000200 | (video ? 0x000400 | 0x000800 : 0);
+        size_t trun = beginFullBox(b, "trun", 1, flags);
+        put32(b, (uint32_t)samples.size());
+        dataOffsetAt = b.size();
+        put32(b, 0);
+        for (const Sample& s : samples) {
+            put32(b, s.duration);
+            put32(b, s.size);
+            if (video) {
+                put32(b, s.key ? 0x02000000 : 0x01010000);
+                put32(b, (uint32_t)s.cts);
+            }
+        }
+        endBox(b, trun);
+        endBox(b, traf);
+    }
+
+    void flushFragment()
+    {
+        if (m_videoSamples.empty() && m_audioSamples.empty()) return;
+        if (!m_initWritten) writeInit();
+        if (!m_hasAudio) {
+            m_audioSamples.clear();
+            m_audioData.clear();
+        }
+        if (m_hasAudio && !m_audioTimeKnown && !m_audioSamples.empty()) {
+            double offset = (double)(m_firstAudioPts - m_baseDts) * m_sampleRate / (double)m_clock;
+            m_audioTime = offset > 0 ? (uint64_t)(offset + 0.5) : 0;
+            m_audioTimeKnown = true;
+        }
+
+        std::vector<uint8_t>& b = m_out;
+        b.clear();
+        size_t moof = beginBox(b, "moof");
+        size_t mfhd = beginFullBox(b, "mfhd", 0, 0);
+        put32(b, ++m_sequence);
+        endBox(b, mfhd);
+
+        size_t videoOffsetAt = 0, audioOffsetAt = 0;
+        if (!m_videoSamples.empty())
+            writeTraf(b, kVideoTrack, (uint64_t)(m_fragmentDts - m_baseDts), m_videoSamples, true, videoOffsetAt);
+        if (!m_audioSamples.empty())
+            writeTraf(b, kAudioTrack, m_audioTime, m_audioSamples, false, audioOffsetAt);
+        endBox(b, moof);
+
+        size_t mdatHeader = 8;
+        uint64_t mdatSize = mdatHeader + m_videoData.size() + m_audioData.size();
+        if (videoOffsetAt) patch32(b, videoOffsetAt, (uint32_t)(b.size() - moof + mdatHeader));
+        if (audioOffsetAt) patch32(b, audioOffsetAt, (uint32_t)(b.size() - moof + mdatHeader + m_videoData.size()));
+        put32(b, (uint32_t)mdatSize);
+        putTag(b, "mdat");
+        b.insert(b.end(), m_videoData.begin(), m_videoData.end());
+        b.insert(b.end(), m_audioData.begin(), m_audioData.end());
+
+        bool key = !m_videoSamples.empty() && m_videoSamples.front().key;
+        m_audioTime += 1024 * m_audioSamples.size();
+        m_videoSamples.clear();
+        m_videoData.clear();
+        m_audioSamples.clear();
+        m_audioData.clear();
+        m_fragmentDts = -1;
+
+        m_sink(b.data(), b.size(), key ? Segment_KeyFragment : Segment_Fragment);
+    }
+};
+
+#endif // FRAGMENTEDMP4MUXER_H
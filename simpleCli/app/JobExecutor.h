@@ -0,0 +1,297 @@
+/* Bounded executor for background jobs started from the HTTP API */
+
+#ifndef JOBEXECUTOR_H
+#define JOBEXECUTOR_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Jobs go into named queues (scan, download, ...), each with a fixed number
+// of workers and a limit on pending jobs, so a burst of requests queues up
+// or is refused instead of starting a thread per request. Submitting a job
+// whose queue already holds a pending job with the same key returns that
+// job instead of adding another. Jobs poll Context::cancelled() at safe
+// points; a job cancelled before it starts never runs.
+class JobExecutor
+{
+    struct Job;
+
+public:
+    enum class State { Queued, Running, Done, Failed, Cancelled };
+
+    static const char* stateName(State s)
+    {
+        static const char* const names[] = { "queued", "running", "done", "failed", "cancelled" };
+        return names[(int)s];
+    }
+
+    struct Info {
+        uint64_t id = 0;
+        std::string queue;
+        std::string key;
+        State state = State::Queued;
+        std::string status;   // progress or result text set by the job
+        double queuedSecs = 0; // time spent waiting for a worker
+        double runSecs = 0;    // time running so far, or in total
+    };
+
+    class Context
+    {
+    public:
+        bool cancelled() const { return m_job->cancel.load(std::memory_order_relaxed); }
+        void setStatus(std::string status)
+        {
+            std::lock_guard<std::mutex> lock(m_exec->m_mutex);
+            m_job->info.status = std::move(status);
+        }
+        // Marks the job failed when it returns
+        void fail(std::string reason)
+        {
+            setStatus(std::move(reason));
+            m_failed = true;
+        }
+
+    private:
+        friend class JobExecutor;
+        Context(JobExecutor* exec, Job* job) : m_exec(exec), m_job(job) {}
+        JobExecutor* m_exec;
+        Job* m_job;
+        bool m_failed = false;
+    };
+
+    using Fn = std::function<void(Context&)>;
+
+    struct Submitted {
+        uint64_t id = 0;        // 0 if rejected
+        bool coalesced = false; // an identical pending job was returned
+    };
+
+    JobExecutor() = default;
+    ~JobExecutor() { stop(); }
+    JobExecutor(const JobExecutor&) = delete;
+    JobExecutor& operator=(const JobExecutor&) = delete;
+
+    // Before start(). Returns the queue's index for submit().
+    size_t addQueue(std::string name, size_t workers, size_t maxPending)
+    {
+        auto q = std::make_unique<Queue>();
+        q->name = std::move(name);
+        q->workers = workers ? workers : 1;
+        q->maxPending = maxPending;
+        m_queues.push_back(std::move(q));
+        return m_queues.size() - 1;
+    }
+
+    // threadInit runs on each worker first, with the queue name
+    void start(std::function<void(const std::string&)> threadInit = nullptr)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = false;
+        for (auto& q : m_queues) {
+            for (size_t i = 0; i < q->workers; i++) {
+                Queue* queue = q.get();
+                m_threads.emplace_back([this, queue, threadInit]() {
+                    if (threadInit) threadInit(queue->name);
+                    run(*queue);
+                });
+            }
+        }
+    }
+
+    // Cancels pending and running jobs and waits for the running ones
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+            for (auto& q : m_queues) {
+                for (auto& job : q->pending) finish(*job, State::Cancelled);
+                q->pending.clear();
+                for (auto& job : q->running) job->cancel = true;
+            }
+        }
+        m_cond.notify_all();
+        for (auto& t : m_threads) {
+            if (t.joinable()) t.join();
+        }
+        m_threads.clear();
+    }
+
+    Submitted submit(size_t queue, std::string key, Fn fn)
+    {
+        Submitted result;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_stop || queue >= m_queues.size()) return result;
+            Queue& q = *m_queues[queue];
+            for (auto& job : q.pending) {
+                if (job->info.key == key) {
+                    result.id = job->info.id;
+                    result.coalesced = true;
+                    return result;
+                }
+            }
+            if (q.pending.size() >= q.maxPending) return result;
+            auto job = std::make_shared<Job>();
+            job->info.id = m_nextId++;
+            job->info.queue = q.name;
+            job->info.key = std::move(key);
+            job->fn = std::move(fn);
+            job->queuedAt = Clock::now();
+            q.pending.push_back(job);
+            m_jobs.push_back(job);
+            result.id = job->info.id;
+        }
+        m_cond.notify_all();
+        return result;
+    }
+
+    // Returns false if the job is unknown or already finished
+    bool cancel(uint64_t id)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& q : m_queues) {
+            for (auto it = q->pending.begin(); it != q->pending.end(); ++it) {
+                if ((*it)->info.id == id) {
+                    finish(**it, State::Cancelled);
+                    q->pending.erase(it);
+                    return true;
+                }
+            }
+            for (auto& job : q->running) {
+                if (job->info.id == id) {
+                    job->cancel = true;
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    // A job of this queue is pending or running
+    bool busy(size_t queue) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (queue >= m_queues.size()) return false;
+        return !m_queues[queue]->pending.empty() || !m_queues[queue]->running.empty();
+    }
+
+    // Active jobs and the most recent finished ones, oldest first
+    std::vector<Info> jobs() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto now = Clock::now();
+        std::vector<Info> out;
+        for (auto& job : m_jobs) {
+            Info info = job->info;
+            auto started = job->state() == State::Queued ? now : job->startedAt;
+            info.queuedSecs = seconds(started - job->queuedAt);
+            if (job->state() != State::Queued) {
+                auto ended = job->finished() ? job->finishedAt : now;
+                info.runSecs = seconds(ended - job->startedAt);
+            }
+            out.push_back(std::move(info));
+        }
+        return out;
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+    static const size_t kHistory = 32; // finished jobs kept for jobs()
+
+    struct Job {
+        Info info;
+        Fn fn;
+        std::atomic<bool> cancel{false};
+        Clock::time_point queuedAt, startedAt, finishedAt;
+
+        State state() const { return info.state; }
+        bool finished() const
+        {
+            return info.state == State::Done || info.state == State::Failed || info.state == State::Cancelled;
+        }
+    };
+
+    struct Queue {
+        std::string name;
+        size_t workers = 1;
+        size_t maxPending = 1;
+        std::deque<std::shared_ptr<Job>> pending;
+        std::vector<std::shared_ptr<Job>> running;
+    };
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::vector<std::unique_ptr<Queue>> m_queues;
+    std::deque<std::shared_ptr<Job>> m_jobs; // all active jobs plus recent history
+    std::vector<std::thread> m_threads;
+    uint64_t m_nextId = 1;
+    bool m_stop = false;
+
+    static double seconds(Clock::duration d) { return std::chrono::duration<double>(d).count(); }
+
+    // With m_mutex held
+    void finish(Job& job, State state)
+    {
+        job.info.state = state;
+        job.finishedAt = Clock::now();
+        if (job.startedAt == Clock::time_point()) job.startedAt = job.finishedAt;
+        job.fn = nullptr;
+        size_t finished = 0;
+        for (auto& j : m_jobs) {
+            if (j->finished()) finished++;
+        }
+        for (auto it = m_jobs.begin(); finished > kHistory && it != m_jobs.end();) {
+            if ((*it)->finished()) {
+                it = m_jobs.erase(it);
+                finished--;
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+
+    void run(Queue& q)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true) {
+            m_cond.wait(lock, [&]() { return m_stop || !q.pending.empty(); });
+            if (m_stop) break;
+            std::shared_ptr<Job> job = q.pending.front();
+            q.pending.pop_front();
+            q.running.push_back(job);
+            job->info.state = State::Running;
+            job->startedAt = Clock::now();
+            lock.unlock();
+
+            Context ctx(this, job.get());
+            bool threw = false;
+            try {
+                job->fn(ctx);
+            }
+            catch (const std::exception& e) {
+                ctx.fail(e.what());
+                threw = true;
+            }
+
+            lock.lock();
+            q.running.erase(std::find(q.running.begin(), q.running.end(), job));
+            if (job->cancel && !threw) finish(*job, State::Cancelled);
+            else finish(*job, ctx.m_failed ? State::Failed : State::Done);
+        }
+    }
+};
+
+#endif // JOBEXECUTOR_H
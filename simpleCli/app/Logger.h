@@ -0,0 +1,375 @@
+/* Asynchronous, level-filtered logfmt logger */
+
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Usage:
+//   logInfo("connected").kv("camera", cam->m_modelId).kv("attempt", attempt);
+// prints
+//   ts=2026-01-01T10:00:00.123Z level=info thread=3 msg=connected camera="ILME-FX30 (D10F3000123)" attempt=1
+//
+// A line below the current level costs one atomic load. Otherwise it is
+// built in a fixed buffer on the caller's stack and copied into a ring owned
+// by the calling thread; a background thread merges the rings in time order
+// and writes them out in batches. Callers never wait on the output stream,
+// and a full ring drops the line (counted) instead of blocking. A thread's
+// ring is freed once the thread has exited and its lines are written.
+
+enum class LogLevel { Debug, Info, Warn, Error, Off };
+
+struct LogRecord {
+    static const size_t kTextSize = 232; // msg and fields; longer lines are cut
+
+    int64_t timeUs;    // system_clock, for the timestamp
+    uint32_t thread;
+    uint16_t length;
+    LogLevel level;
+    char text[kTextSize];
+};
+
+class LogThreadBuffer
+{
+public:
+    static const uint64_t kCapacity = 256;
+
+    explicit LogThreadBuffer(uint32_t thread) : m_thread(thread), m_records(kCapacity) {}
+
+    // Owning thread only
+    bool push(const LogRecord& record)
+    {
+        uint64_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) >= kCapacity) return false;
+        m_records[head % kCapacity] = record;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Flusher thread only
+    void drain(std::vector<LogRecord>& out)
+    {
+        uint64_t tail = m_tail.load(std::memory_order_relaxed);
+        uint64_t head = m_head.load(std::memory_order_acquire);
+        for (; tail < head; tail++) out.push_back(m_records[tail % kCapacity]);
+        m_tail.store(tail, std::memory_order_release);
+    }
+
+    uint32_t thread() const { return m_thread; }
+
+    bool retired = false; // owning thread exited; Logger::m_mutex held
+
+private:
+    uint32_t m_thread;
+    std::vector<LogRecord> m_records;
+    std::atomic<uint64_t> m_head{0};
+    std::atomic<uint64_t> m_tail{0};
+};
+
+class Logger
+{
+public:
+    static Logger& instance()
+    {
+        static Logger logger;
+        return logger;
+    }
+
+    void setLevel(LogLevel level) { m_level.store(level, std::memory_order_relaxed); }
+    bool enabled(LogLevel level) const { return level >= m_level.load(std::memory_order_relaxed); }
+
+    // Where lines go (stdout by default); call before logging starts
+    void setOutput(FILE* out) { m_out = out; }
+
+    // Flush every interval, and right away after an error
+    void start(std::chrono::milliseconds interval = std::chrono::milliseconds(100))
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_thread.joinable()) return;
+        m_stop = false;
+        m_interval = interval;
+        m_thread = std::thread([this]() { run(); });
+        m_running = true;
+    }
+
+    // Writes everything logged so far, then stops; later lines are written directly
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_cond.notify_one();
+        if (m_thread.joinable()) m_thread.join();
+        m_running = false;
+        flushNow();
+    }
+
+    void commit(LogRecord& record)
+    {
+        LogThreadBuffer& buffer = threadBuffer();
+        record.thread = buffer.thread();
+        if (!m_running.load(std::memory_order_acquire)) {
+            std::lock_guard<std::mutex> lock(m_flushMutex);
+            m_text.clear();
+            format(record, m_text);
+            fwrite(m_text.data(), 1, m_text.size(), m_out);
+            fflush(m_out);
+            return;
+        }
+        if (!buffer.push(record)) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        if (record.level >= LogLevel::Error) m_cond.notify_one();
+    }
+
+    uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<LogLevel> m_level{LogLevel::Info};
+    FILE* m_out = stdout;
+    std::mutex m_mutex;              // buffers list, thread start/stop
+    std::mutex m_flushMutex;         // one writer at a time
+    std::condition_variable m_cond;
+    std::vector<std::shared_ptr<LogThreadBuffer>> m_buffers;
+    uint32_t m_nextThread = 1;       // 0 is the logger itself
+    std::thread m_thread;
+    std::atomic<bool> m_running{false};
+    bool m_stop = false;
+    std::chrono::milliseconds m_interval{100};
+    std::atomic<uint64_t> m_dropped{0};
+    uint64_t m_reportedDropped = 0;
+    std::vector<LogRecord> m_batch;
+    std::string m_text;
+
+    Logger() = default;
+    ~Logger() { stop(); }
+
+    LogThreadBuffer& threadBuffer()
+    {
+        // Marks the ring retired when the thread exits; the next flush frees it
+        struct Owner {
+            Logger* logger = nullptr;
+            LogThreadBuffer* buffer = nullptr;
+            ~Owner()
+            {
+                if (!buffer) return;
+                std::lock_guard<std::mutex> lock(logger->m_mutex);
+                buffer->retired = true;
+            }
+        };
+        static thread_local Owner owner;
+        if (!owner.buffer) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_buffers.push_back(std::make_shared<LogThreadBuffer>(m_nextThread++));
+            owner.logger = this;
+            owner.buffer = m_buffers.back().get();
+        }
+        return *owner.buffer;
+    }
+
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (!m_stop) {
+            m_cond.wait_for(lock, m_interval);
+            lock.unlock();
+            flushNow();
+            lock.lock();
+        }
+    }
+
+    // One write per batch, so an unbuffered stdout still costs one syscall
+    void flushNow()
+    {
+        std::lock_guard<std::mutex> flushLock(m_flushMutex);
+        m_batch.clear();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (auto& b : m_buffers) b->drain(m_batch);
+            // A retired ring got its last line before it was marked, so it is empty now
+            m_buffers.erase(std::remove_if(m_buffers.begin(), m_buffers.end(),
+                                           [](const std::shared_ptr<LogThreadBuffer>& b) { return b->retired; }),
+                            m_buffers.end());
+        }
+        std::stable_sort(m_batch.begin(), m_batch.end(),
+                         [](const LogRecord& a, const LogRecord& b) { return a.timeUs < b.timeUs; });
+        m_text.clear();
+        for (const auto& r : m_batch) format(r, m_text);
+        uint64_t dropped = m_dropped.load(std::memory_order_relaxed);
+        if (dropped != m_reportedDropped) {
+            format(droppedRecord(dropped - m_reportedDropped), m_text);
+            m_reportedDropped = dropped;
+        }
+        if (m_text.empty()) return;
+        fwrite(m_text.data(), 1, m_text.size(), m_out);
+        fflush(m_out);
+    }
+
+    // The logger's own notice, formatted like any other line; thread 0 is the logger itself
+    static LogRecord droppedRecord(uint64_t count)
+    {
+        LogRecord r;
+        r.timeUs = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        r.thread = 0;
+        r.level = LogLevel::Warn;
+        int n = snprintf(r.text, sizeof(r.text), "msg=\"log lines dropped\" count=%llu", (unsigned long long)count);
+        r.length = (uint16_t)std::min((size_t)n, sizeof(r.text) - 1);
+        return r;
+    }
+
+    static void format(const LogRecord& r, std::string& out)
+    {
+        static const char* const names[] = { "debug", "info", "warn", "error" };
+        std::time_t seconds = (std::time_t)(r.timeUs / 1000000);
+        std::tm tm;
+#if defined(_WIN32) || defined(_WIN64)
+        gmtime_s(&tm, &seconds);
+#else
+        gmtime_r(&seconds, &tm);
+#endif
+        char ts[32];
+        strftime(ts, sizeof(ts), "%Y-%m-%dT%H:%M:%S", &tm);
+        char prefix[96];
+        int n = snprintf(prefix, sizeof(prefix), "ts=%s.%03dZ level=%s thread=%u ", ts,
+                         (int)(r.timeUs / 1000 % 1000), names[(int)r.level], r.thread);
+        out.append(prefix, (size_t)n);
+        out.append(r.text, r.length);
+        out += '\n';
+    }
+};
+
+// One log line under construction; written when it goes out of scope
+class LogLine
+{
+public:
+    LogLine(LogLevel level, std::string_view msg) : m_active(Logger::instance().enabled(level))
+    {
+        if (!m_active) return;
+        m_record.timeUs = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        m_record.level = level;
+        m_record.length = 0;
+        append("msg=");
+        appendValue(msg);
+    }
+
+    ~LogLine()
+    {
+        if (m_active) Logger::instance().commit(m_record);
+    }
+
+    LogLine(const LogLine&) = delete;
+    LogLine& operator=(const LogLine&) = delete;
+
+    LogLine& kv(const char* key, std::string_view value)
+    {
+        if (!m_active) return *this;
+        appendKey(key);
+        appendValue(value);
+        return *this;
+    }
+
+    LogLine& kv(const char* key, const char* value) { return kv(key, std::string_view(value ? value : "")); }
+    LogLine& kv(const char* key, const std::string& value) { return kv(key, std::string_view(value)); }
+
+    // CrString on Windows; ASCII is all the SDK puts in model names and ids
+    LogLine& kv(const char* key, const std::wstring& value)
+    {
+        if (!m_active) return *this;
+        char narrow[LogRecord::kTextSize];
+        size_t n = 0;
+        for (wchar_t c : value) {
+            if (n == sizeof(narrow)) break;
+            narrow[n++] = (c < 0x80) ? (char)c : '?';
+        }
+        return kv(key, std::string_view(narrow, n));
+    }
+
+    LogLine& kv(const char* key, bool value) { return kv(key, std::string_view(value ? "true" : "false")); }
+
+    template <typename T, typename std::enable_if<std::is_arithmetic<T>::value, int>::type = 0>
+    LogLine& kv(const char* key, T value)
+    {
+        if (!m_active) return *this;
+        char buf[32];
+        if (std::is_floating_point<T>::value) snprintf(buf, sizeof(buf), "%.3f", (double)value);
+        else if (std::is_signed<T>::value) snprintf(buf, sizeof(buf), "%lld", (long long)value);
+        else snprintf(buf, sizeof(buf), "%llu", (unsigned long long)value);
+        appendKey(key);
+        append(buf);
+        return *this;
+    }
+
+private:
+    bool m_active;
+    LogRecord m_record;
+
+    void append(std::string_view s)
+    {
+        size_t room = LogRecord::kTextSize - m_record.length;
+        size_t n = std::min(room, s.size());
+        memcpy(m_record.text + m_record.length, s.data(), n);
+        m_record.length += (uint16_t)n;
+    }
+
+    void appendKey(const char* key)
+    {
+        append(" ");
+        append(key);
+        append("=");
+    }
+
+    // Quoted only when needed, as logfmt does
+    void appendValue(std::string_view v)
+    {
+        bool quote = v.empty() || v.find_first_of(" =\"\n\t") != std::string_view::npos;
+        if (!quote) {
+            append(v);
+            return;
+        }
+        append("\"");
+        for (char c : v) {
+            if (c == '"' || c == '\\') append("\\");
+            if (c == '\n') append("\\n");
+            else append(std::string_view(&c, 1));
+        }
+        append("\"");
+    }
+};
+
+// "debug", "info", "warn", "error" or "off"
+inline bool parseLogLevel(std::string_view name, LogLevel& level)
+{
+    static const char* const names[] = { "debug", "info", "warn", "error", "off" };
+    for (int i = 0; i < 5; i++) {
+        if (name == names[i]) {
+            level = (LogLevel)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+inline LogLine logDebug(std::string_view msg) { return LogLine(LogLevel::Debug, msg); }
+inline LogLine logInfo(std::string_view msg) { return LogLine(LogLevel::Info, msg); }
+inline LogLine logWarn(std::string_view msg) { return LogLine(LogLevel::Warn, msg); }
+inline LogLine logError(std::string_view msg) { return LogLine(LogLevel::Error, msg); }
+
+#endif // LOGGER_H
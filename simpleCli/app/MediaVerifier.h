@@ -0,0 +1,402 @@
+/* Background checksum verification of offloaded media files */
+
+#ifndef MEDIAVERIFIER_H
+#define MEDIAVERIFIER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32) || defined(_WIN64)
+  #include <fcntl.h>
+  #include <io.h>
+  #include <share.h>
+  #include <sys/stat.h>
+#else
+  #include <fcntl.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+// Streaming XXH64, fed in file order
+class Xxh64
+{
+public:
+    explicit Xxh64(uint64_t seed = 0) : m_seed(seed) { reset(); }
+
+    void reset()
+    {
+        m_acc[0] = m_seed + kPrime1 + kPrime2;
+        m_acc[1] = m_seed + kPrime2;
+        m_acc[2] = m_seed;
+        m_acc[3] = m_seed - kPrime1;
+        m_bufSize = 0;
+        m_total = 0;
+    }
+
+    void update(const uint8_t* data, size_t size)
+    {
+        m_total += size;
+        if (m_bufSize + size < 32) {
+            memcpy(m_buf + m_bufSize, data, size);
+            m_bufSize += (uint32_t)size;
+            return;
+        }
+        if (m_bufSize > 0) {
+            uint32_t fill = 32 - m_bufSize;
+            memcpy(m_buf + m_bufSize, data, fill);
+            for (int i = 0; i < 4; ++i) m_acc[i] = round(m_acc[i], read64(m_buf + i * 8));
+            data += fill;
+            size -= fill;
+            m_bufSize = 0;
+        }
+        while (size >= 32) {
+            for (int i = 0; i < 4; ++i) m_acc[i] = round(m_acc[i], read64(data + i * 8));
+            data += 32;
+            size -= 32;
+        }
+        memcpy(m_buf, data, size);
+        m_bufSize = (uint32_t)size;
+    }
+
+    // Known answers from the reference implementation; HashTransferSink::self_test
+    // in app/RemoteTransferSink.cpp checks the same vectors
+    static bool selfTest()
+    {
+        static const struct { const char* input; uint64_t hash; } vectors[] = {
+            { "", 0xEF46DB3751D8E999ULL },
+            { "abc", 0x44BC2CF5AD770999ULL },
+            { "Nobody inspects the spammish repetition", 0xFBCEA83C8A378BF1ULL },
+        };
+        for (const auto& v : vectors) {
+            size_t len = strlen(v.input);
+            Xxh64 whole;
+            whole.update((const uint8_t*)v.input, len);
+            // and fed in two pieces, through the partial-stripe buffer
+            Xxh64 split;
+            split.update((const uint8_t*)v.input, len / 3);
+            split.update((const uint8_t*)v.input + len / 3, len - len / 3);
+            if (whole.digest() != v.hash || split.digest() != v.hash) return false;
+        }
+        return true;
+    }
+
+    uint64_t digest() const
+    {
+        uint64_t h;
+        if (m_total >= 32) {
+            h = rotl(m_acc[0], 1) + rotl(m_acc[1], 7) + rotl(m_acc[2], 12) + rotl(m_acc[3], 18);
+            for (int i = 0; i < 4; ++i) {
+                h ^= round(0, m_acc[i]);
+                h = h * kPrime1 + kPrime4;
+            }
+        }
+        else {
+            h = m_seed + kPrime5;
+        }
+        h += m_total;
+
+        const uint8_t* p = m_buf;
+        uint32_t len = m_bufSize;
+        for (; len >= 8; p += 8, len -= 8) {
+            h ^= round(0, read64(p));
+            h = rotl(h, 27) * kPrime1 + kPrime4;
+        }
+        if (len >= 4) {
+            h ^= (uint64_t)read32(p) * kPrime1;
+            h = rotl(h, 23) * kPrime2 + kPrime3;
+            p += 4;
+            len -= 4;
+        }
+        for (; len > 0; ++p, --len) {
+            h ^= (*p) * kPrime5;
+            h = rotl(h, 11) * kPrime1;
+        }
+        h ^= h >> 33;
+        h *= kPrime2;
+        h ^= h >> 29;
+        h *= kPrime3;
+        h ^= h >> 32;
+        return h;
+    }
+
+private:
+    static const uint64_t kPrime1 = 0x9E3779B185EBCA87ULL;
+    static const uint64_t kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+    static const uint64_t kPrime3 = 0x165667B19E3779F9ULL;
+    static const uint64_t kPrime4 = 0x85EBCA77C2B2AE63ULL;
+    static const uint64_t kPrime5 = 0x27D4EB2F165667C5ULL;
+
+    static uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+    static uint64_t round(uint64_t acc, uint64_t input) { return rotl(acc + input * kPrime2, 31) * kPrime1; }
+    static uint64_t read64(const uint8_t* p)
+    {
+        uint64_t v = 0;
+        for (int i = 7; i >= 0; --i) v = (v << 8) | p[i];
+        return v;
+    }
+    static uint32_t read32(const uint8_t* p)
+    {
+        return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+
+    uint64_t m_seed;
+    uint64_t m_acc[4];
+    uint8_t m_buf[32];
+    uint32_t m_bufSize;
+    uint64_t m_total;
+};
+
+// Files are queued as soon as they land and hashed by a small worker pool
+// with large sequential reads, so verification overlaps the next download
+// instead of re-reading everything at the end. Each result goes into an
+// MHL-style manifest (one <hash> per file, xxhash64be) written next to the
+// media by writeManifest().
+class MediaVerifier
+{
+public:
+    struct Counts {
+        uint32_t queued = 0;
+        uint32_t verified = 0;
+        uint32_t failed = 0; // unreadable or size mismatch
+        uint32_t pending() const { return queued - verified - failed; }
+    };
+
+    explicit MediaVerifier(int threads = 2, size_t readSize = 8 * 1024 * 1024)
+        : m_readSize(readSize), m_hashOk(Xxh64::selfTest())
+    {
+        if (threads < 1) threads = 1;
+        for (int i = 0; i < threads; i++) {
+            m_workers.emplace_back([this]() { run(); });
+        }
+    }
+
+    ~MediaVerifier() { stop(); }
+
+    MediaVerifier(const MediaVerifier&) = delete;
+    MediaVerifier& operator=(const MediaVerifier&) = delete;
+
+    // name is recorded in the manifest as given (relative to the manifest)
+    void add(const std::string& path, const std::string& name, uint64_t expectedSize)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobs.push_back(Job{ path, name, expectedSize });
+        m_counts.queued++;
+        m_cond.notify_one();
+    }
+
+    Counts counts() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_counts;
+    }
+
+    // Block until every queued file has been hashed
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_idle.wait(lock, [this]() { return m_jobs.empty() && m_active == 0; });
+    }
+
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+            m_cond.notify_all();
+        }
+        for (auto& worker : m_workers) {
+            if (worker.joinable()) worker.join();
+        }
+        m_workers.clear();
+    }
+
+    // Write the results collected so far; returns false if the file could not be written
+    bool writeManifest(const std::string& path, const std::string& creator) const
+    {
+        std::vector<Result> results;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            results = m_results;
+        }
+        std::ofstream out(path, std::ios::out | std::ios::trunc);
+        if (!out) return false;
+        out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+            << "<hashlist version=\"1.1\">\n"
+            << "  <creatorinfo>\n"
+            << "    <tool>" << escape(creator) << "</tool>\n"
+            << "    <startdate>" << utcTime(m_startedAt) << "</startdate>\n"
+            << "    <finishdate>" << utcTime(std::time(nullptr)) << "</finishdate>\n"
+            << "  </creatorinfo>\n";
+        for (const auto& r : results) {
+            out << "  <hash>\n"
+                << "    <file>" << escape(r.name) << "</file>\n"
+                << "    <size>" << r.size << "</size>\n";
+            if (r.ok) {
+                char hex[17];
+                snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)r.hash);
+                out << "    <xxhash64be>" << hex << "</xxhash64be>\n"
+                    << "    <hashdate>" << utcTime(r.hashedAt) << "</hashdate>\n";
+            }
+            else {
+                out << "    <!-- not verified: " << escape(r.error) << " -->\n";
+            }
+            out << "  </hash>\n";
+        }
+        out << "</hashlist>\n";
+        return (bool)out;
+    }
+
+private:
+    struct Job {
+        std::string path;
+        std::string name;
+        uint64_t expectedSize;
+    };
+
+    struct Result {
+        std::string name;
+        uint64_t size = 0;
+        uint64_t hash = 0;
+        std::time_t hashedAt = 0;
+        bool ok = false;
+        std::string error;
+    };
+
+    size_t m_readSize;
+    bool m_hashOk; // a hash that fails its known answers verifies nothing
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::condition_variable m_idle;
+    std::deque<Job> m_jobs;
+    std::vector<Result> m_results;
+    std::vector<std::thread> m_workers;
+    Counts m_counts;
+    int m_active = 0;
+    bool m_stop = false;
+    std::time_t m_startedAt = std::time(nullptr);
+
+    void run()
+    {
+        std::vector<uint8_t> buf(m_readSize);
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true) {
+            m_cond.wait(lock, [this]() { return m_stop || !m_jobs.empty(); });
+            if (m_stop) break;
+            Job job = m_jobs.front();
+            m_jobs.pop_front();
+            m_active++;
+            lock.unlock();
+
+            Result result;
+            if (m_hashOk) {
+                result = hashFile(job, buf);
+            }
+            else {
+                result.name = job.name;
+                result.error = "XXH64 self-test failed";
+            }
+
+            lock.lock();
+            m_active--;
+            if (result.ok) m_counts.verified++;
+            else m_counts.failed++;
+            m_results.push_back(result);
+            if (m_jobs.empty() && m_active == 0) m_idle.notify_all();
+        }
+        m_idle.notify_all();
+    }
+
+    static Result hashFile(const Job& job, std::vector<uint8_t>& buf)
+    {
+        Result result;
+        result.name = job.name;
+#if defined(_WIN32) || defined(_WIN64)
+        int fd = -1;
+        if (_sopen_s(&fd, job.path.c_str(), _O_RDONLY | _O_BINARY | _O_SEQUENTIAL, _SH_DENYNO, 0) != 0) fd = -1;
+#else
+        int fd = ::open(job.path.c_str(), O_RDONLY);
+  #if defined(POSIX_FADV_SEQUENTIAL)
+        if (fd >= 0) posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+  #endif
+#endif
+        if (fd < 0) {
+            result.error = "open failed";
+            return result;
+        }
+
+        Xxh64 xxh;
+        uint64_t total = 0;
+        bool readError = false;
+        while (true) {
+#if defined(_WIN32) || defined(_WIN64)
+            int n = _read(fd, buf.data(), (unsigned int)buf.size());
+#else
+            ssize_t n = ::read(fd, buf.data(), buf.size());
+#endif
+            if (n < 0) { readError = true; break; }
+            if (n == 0) break;
+            xxh.update(buf.data(), (size_t)n);
+            total += (uint64_t)n;
+        }
+#if defined(_WIN32) || defined(_WIN64)
+        _close(fd);
+#else
+        ::close(fd);
+#endif
+
+        result.size = total;
+        if (readError) {
+            result.error = "read failed";
+        }
+        else if (job.expectedSize != 0 && total != job.expectedSize) {
+            result.error = "size " + std::to_string(total) + " != " + std::to_string(job.expectedSize);
+        }
+        else {
+            result.hash = xxh.digest();
+            result.hashedAt = std::time(nullptr);
+            result.ok = true;
+        }
+        return result;
+    }
+
+    static std::string utcTime(std::time_t t)
+    {
+        std::tm tm;
+#if defined(_WIN32) || defined(_WIN64)
+        gmtime_s(&tm, &t);
+#else
+        gmtime_r(&t, &tm);
+#endif
+        char buf[32];
+        strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%SZ", &tm);
+        return buf;
+    }
+
+    static std::string escape(const std::string& s)
+    {
+        std::string out;
+        for (char c : s) {
+            switch (c) {
+            case '&': out += "&amp;"; break;
+            case '<': out += "&lt;"; break;
+            case '>': out += "&gt;"; break;
+            case '"': out += "&quot;"; break;
+            default: out += c; break;
+            }
+        }
+        return out;
+    }
+};
+
+#endif // MEDIAVERIFIER_H
@@ -0,0 +1,226 @@
+/* Prometheus-style counters, gauges and histograms for the /metrics endpoint */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Metrics are registered once, which allocates under the registry lock, and
+// are then updated with relaxed atomics only: the SDK wrappers and callbacks
+// record without locking or allocating. render() produces the Prometheus
+// text exposition format (version 0.0.4).
+
+class MetricCounter
+{
+public:
+    void inc(uint64_t n = 1) { m_value.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t value() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> m_value{0};
+};
+
+class MetricGauge
+{
+public:
+    void set(int64_t v) { m_value.store(v, std::memory_order_relaxed); }
+    void add(int64_t n) { m_value.fetch_add(n, std::memory_order_relaxed); }
+    int64_t value() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> m_value{0};
+};
+
+// Fixed buckets in seconds, from 1 ms to 5 min
+class MetricHistogram
+{
+public:
+    static constexpr int kBucketCount = 16;
+    static constexpr double kBuckets[kBucketCount] = {
+        0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10, 30, 60, 300
+    };
+
+    void observe(double seconds)
+    {
+        int i = 0;
+        while (i < kBucketCount && seconds > kBuckets[i]) i++;
+        m_buckets[i].fetch_add(1, std::memory_order_relaxed);
+        m_count.fetch_add(1, std::memory_order_relaxed);
+        m_sumMicros.fetch_add((uint64_t)(seconds > 0 ? seconds * 1e6 : 0), std::memory_order_relaxed);
+    }
+
+    void observe(std::chrono::steady_clock::duration d) { observe(std::chrono::duration<double>(d).count()); }
+
+    uint64_t count() const { return m_count.load(std::memory_order_relaxed); }
+    double sum() const { return m_sumMicros.load(std::memory_order_relaxed) / 1e6; }
+    uint64_t bucket(int i) const { return m_buckets[i].load(std::memory_order_relaxed); } // not cumulative
+
+private:
+    std::atomic<uint64_t> m_buckets[kBucketCount + 1] = {}; // last one is +Inf
+    std::atomic<uint64_t> m_count{0};
+    std::atomic<uint64_t> m_sumMicros{0};
+};
+
+class MetricsRegistry
+{
+public:
+    MetricsRegistry() = default;
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    // Returns the existing metric for the same name and labels.
+    // labels is the inside of the braces, e.g. api="Connect"
+    MetricCounter& counter(const std::string& name, const std::string& help, const std::string& labels = "")
+    {
+        return *static_cast<MetricCounter*>(findOrAdd(name, help, labels, Type::Counter));
+    }
+
+    MetricGauge& gauge(const std::string& name, const std::string& help, const std::string& labels = "")
+    {
+        return *static_cast<MetricGauge*>(findOrAdd(name, help, labels, Type::Gauge));
+    }
+
+    MetricHistogram& histogram(const std::string& name, const std::string& help, const std::string& labels = "")
+    {
+        return *static_cast<MetricHistogram*>(findOrAdd(name, help, labels, Type::Histogram));
+    }
+
+    std::string render() const
+    {
+        static const char* const typeNames[] = { "counter", "gauge", "histogram" };
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::string out;
+        char buf[64];
+        std::vector<bool> done(m_entries.size(), false);
+        // Samples of one family have to stay together under a single HELP/TYPE
+        for (size_t i = 0; i < m_entries.size(); i++) {
+            if (done[i]) continue;
+            const Entry& head = m_entries[i];
+            out += "# HELP " + head.name + ' ' + head.help + '\n';
+            out += "# TYPE " + head.name + ' ' + typeNames[(int)head.type] + '\n';
+            for (size_t j = i; j < m_entries.size(); j++) {
+                const Entry& e = m_entries[j];
+                if (done[j] || e.name != head.name) continue;
+                done[j] = true;
+                switch (e.type) {
+                case Type::Counter:
+                    snprintf(buf, sizeof(buf), " %llu\n", (unsigned long long)static_cast<MetricCounter*>(e.metric)->value());
+                    out += sample(e.name, e.labels) + buf;
+                    break;
+                case Type::Gauge:
+                    snprintf(buf, sizeof(buf), " %lld\n", (long long)static_cast<MetricGauge*>(e.metric)->value());
+                    out += sample(e.name, e.labels) + buf;
+                    break;
+                case Type::Histogram: {
+                    const MetricHistogram& h = *static_cast<MetricHistogram*>(e.metric);
+                    uint64_t cumulative = 0;
+                    for (int b = 0; b <= MetricHistogram::kBucketCount; b++) {
+                        cumulative += h.bucket(b);
+                        if (b < MetricHistogram::kBucketCount) snprintf(buf, sizeof(buf), "le=\"%g\"", MetricHistogram::kBuckets[b]);
+                        else snprintf(buf, sizeof(buf), "le=\"+Inf\"");
+                        out += sample(e.name + "_bucket", e.labels, buf);
+                        snprintf(buf, sizeof(buf), " %llu\n", (unsigned long long)cumulative);
+                        out += buf;
+                    }
+                    snprintf(buf, sizeof(buf), " %.6f\n", h.sum());
+                    out += sample(e.name + "_sum", e.labels) + buf;
+                    snprintf(buf, sizeof(buf), " %llu\n", (unsigned long long)h.count());
+                    out += sample(e.name + "_count", e.labels) + buf;
+                    break;
+                }
+                }
+            }
+        }
+        return out;
+    }
+
+private:
+    enum class Type { Counter, Gauge, Histogram };
+
+    struct Entry {
+        std::string name;
+        std::string help;
+        std::string labels;
+        Type type;
+        void* metric;
+    };
+
+    mutable std::mutex m_mutex;
+    std::deque<Entry> m_entries;
+    std::deque<MetricCounter> m_counters;
+    std::deque<MetricGauge> m_gauges;
+    std::deque<MetricHistogram> m_histograms;
+
+    void* findOrAdd(const std::string& name, const std::string& help, const std::string& labels, Type type)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const auto& e : m_entries) {
+            if (e.name == name && e.labels == labels && e.type == type) return e.metric;
+        }
+        void* metric = nullptr;
+        switch (type) {
+        case Type::Counter:   m_counters.emplace_back();   metric = &m_counters.back();   break;
+        case Type::Gauge:     m_gauges.emplace_back();     metric = &m_gauges.back();     break;
+        case Type::Histogram: m_histograms.emplace_back(); metric = &m_histograms.back(); break;
+        }
+        m_entries.push_back(Entry{ name, help, labels, type, metric });
+        return metric;
+    }
+
+    static std::string sample(const std::string& name, const std::string& labels, const std::string& extra = "")
+    {
+        if (labels.empty() && extra.empty()) return name;
+        std::string s = name + '{' + labels;
+        if (!labels.empty() && !extra.empty()) s += ',';
+        return s + extra + '}';
+    }
+};
+
+inline MetricsRegistry& metrics()
+{
+    static MetricsRegistry registry;
+    return registry;
+}
+
+// Latency histogram and error counter of one SDK API
+struct SdkCallMetrics {
+    MetricHistogram& seconds;
+    MetricCounter& errors;
+};
+
+// Look the pair up once and keep the reference, e.g.
+//   static SdkCallMetrics& m = sdkCallMetrics("Connect");
+inline SdkCallMetrics& sdkCallMetrics(const char* api)
+{
+    static std::mutex mutex;
+    static std::deque<std::pair<std::string, SdkCallMetrics>> calls;
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& c : calls) {
+        if (c.first == api) return c.second;
+    }
+    std::string labels = std::string("api=\"") + api + '"';
+    calls.emplace_back(api, SdkCallMetrics{
+        metrics().histogram("fx30_sdk_call_seconds", "Latency of Camera Remote SDK calls", labels),
+        metrics().counter("fx30_sdk_call_errors_total", "Camera Remote SDK calls that returned an error", labels) });
+    return calls.back().second;
+}
+
+// Run one SDK call and record its latency, and its result if it failed
+template <typename F>
+inline auto timedSdkCall(SdkCallMetrics& m, F&& call) -> decltype(call())
+{
+    auto start = std::chrono::steady_clock::now();
+    auto result = call();
+    m.seconds.observe(std::chrono::steady_clock::now() - start);
+    if (result != 0) m.errors.inc();
+    return result;
+}
+
+#endif // METRICS_H
@@ -1,10 +1,14 @@
 // "pull/delete/playback contents in RemoteTransferMode" sample
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <cstdint>
 #include <cstdlib>
+#include <deque>
 #include <fstream>
 #include <future>
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <sstream>
 #include <stdexcept>
@@ -46,6 +50,9 @@
 #include "CameraRemote_SDK.h"
 #include "IDeviceCallback.h"
 #include "CrDebugString.h"   // use CrDebugString.cpp
+#include "AsyncFileWriter.h"
+#include "FragmentedMp4Muxer.h"
+#include "httplib.h"
 
 #define PrintError(msg, err) { fprintf(stderr, "Error in %s(%d):" msg ",%s\n", __FUNCTION__, __LINE__, (err ? CrErrorString(err).c_str():"")); }
 #define GotoError(msg, err) { PrintError(msg, err); goto Error; }
@@ -65,8 +72,215 @@ void setEventPromise(std::promise<void>* dp)
     m_eventPromise = dp;
 }
 
-std::ofstream* m_fileVideo = nullptr;
-std::ofstream* m_fileAudio = nullptr;
+// Keeps the init segment and the latest fragments of the current playback so
+// any number of HTTP viewers can follow the one stream coming from the camera.
+// A viewer joins at the newest keyframe fragment; one that falls out of the
+// ring skips ahead to the newest keyframe instead of holding the ring back.
+class PlaybackBroadcast
+{
+public:
+    using Segment = std::shared_ptr<const std::vector<uint8_t>>;
+
+    struct Cursor {
+        bool started = false;
+        uint64_t generation = 0;
+        bool sentInit = false;
+        bool needKey = true;
+        uint64_t next = 0;
+    };
+
+    void beginStream()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_generation++;
+        m_init.reset();
+        m_fragments.clear();
+        m_bytes = 0;
+        m_ended = false;
+        m_cond.notify_all();
+    }
+
+    void endStream()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_ended = true;
+        m_cond.notify_all();
+    }
+
+    // Ends every current viewer and forgets the buffered fragments, but keeps
+    // the init segment and the stream state, so viewers of a server started
+    // later in the same playback still get the init segment first.
+    void dropViewers()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_generation++;
+        m_fragments.clear();
+        m_bytes = 0;
+        m_cond.notify_all();
+    }
+
+    void publish(const uint8_t* data, size_t size, FragmentedMp4Muxer::SegmentType type)
+    {
+        Segment seg = std::make_shared<const std::vector<uint8_t>>(data, data + size);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(type == FragmentedMp4Muxer::Segment_Init) {
+            m_init = seg;
+        } else {
+            m_fragments.push_back({m_nextSeq++, type == FragmentedMp4Muxer::Segment_KeyFragment, seg});
+            m_bytes += size;
+            // never drop the newest keyframe fragment, late joiners start there
+            size_t newestKey = m_fragments.size() - 1;
+            while(newestKey > 0 && !m_fragments[newestKey].key) newestKey--;
+            while(m_bytes > kMaxBytes && newestKey > 0) {
+                m_bytes -= m_fragments.front().data->size();
+                m_fragments.pop_front();
+                newestKey--;
+            }
+        }
+        m_cond.notify_all();
+    }
+
+    // Next segment for a viewer. Returns false once the stream is over;
+    // returns true with an empty segment if nothing arrived within timeout.
+    bool next(Cursor& c, Segment& out, std::chrono::milliseconds timeout)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if(!c.started) {
+            c.started = true;
+            c.generation = m_generation;
+        }
+        out.reset();
+        m_cond.wait_for(lock, timeout, [&]() { return m_generation != c.generation || m_ended || _ready(c); });
+        if(m_generation != c.generation) return false;
+        if(!_ready(c)) return !m_ended;
+
+        if(!c.sentInit) {
+            out = m_init;
+            c.sentInit = true;
+            c.next = m_nextSeq;
+            for(size_t i = m_fragments.size(); i-- > 0;) {
+                if(m_fragments[i].key) { c.next = m_fragments[i].seq; break; }
+            }
+            return true;
+        }
+        if(c.next < m_fragments.front().seq) {
+            c.needKey = true; // fell behind the ring
+            c.next = m_fragments.front().seq;
+        }
+        for(; c.next <= m_fragments.back().seq; c.next++) {
+            const Fragment& f = m_fragments[(size_t)(c.next - m_fragments.front().seq)];
+            if(c.needKey && !f.key) continue;
+            c.needKey = false;
+            out = f.data;
+            c.next++;
+            break;
+        }
+        return true;
+    }
+
+private:
+    static const size_t kMaxBytes = 64 * 1024 * 1024;
+
+    struct Fragment {
+        uint64_t seq;
+        bool key;
+        Segment data;
+    };
+
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    uint64_t m_generation = 0;
+    Segment m_init;
+    std::deque<Fragment> m_fragments;
+    size_t m_bytes = 0;
+    uint64_t m_nextSeq = 0;
+    bool m_ended = false;
+
+    bool _ready(const Cursor& c) const
+    {
+        if(!m_init) return false;
+        if(!c.sentInit) return true;
+        return !m_fragments.empty() && c.next <= m_fragments.back().seq;
+    }
+};
+
+// Playback data is muxed into fragmented MP4 on the callback thread and handed to
+// a writer thread, so the SDK callback never waits on the disk
+AsyncFileWriter m_fileMovie;
+AsyncFileWriter::Options m_writerOptions;
+std::shared_ptr<FragmentedMp4Muxer> m_muxer; // accessed with std::atomic_load/store
+
+PlaybackBroadcast m_broadcast;
+std::atomic<bool> m_streaming(false);
+httplib::Server* m_streamServer = nullptr;
+std::thread m_streamThread;
+#define STREAM_VIEWERS 8
+
+void _closePlaybackFiles()
+{
+    std::shared_ptr<FragmentedMp4Muxer> muxer = std::atomic_exchange(&m_muxer, std::shared_ptr<FragmentedMp4Muxer>());
+    if(muxer) muxer->finish();
+    m_broadcast.endStream();
+    if(m_fileMovie.isOpen()) {
+        bool ok = m_fileMovie.close();
+        AsyncFileWriter::Stats st = m_fileMovie.stats();
+        std::cout << "movie:" << st.bytesWritten << " bytes," << (muxer ? muxer->fragments() : 0) << " fragments," << st.writes << " writes,stalls=" << st.producerStalls << ",peak=" << st.maxFill << (ok ? "" : ",write error") << "\n";
+    }
+}
+
+void _onMuxedSegment(const uint8_t* data, size_t size, FragmentedMp4Muxer::SegmentType type)
+{
+    m_fileMovie.write(data, size);
+    // the init segment is kept even with no server running, for viewers joining mid-playback
+    if(m_streaming || type == FragmentedMp4Muxer::Segment_Init) m_broadcast.publish(data, size, type);
+}
+
+// Serves the playback being captured as one progressive fMP4 stream per viewer
+bool _startStreamServer(int port)
+{
+    if(m_streamServer) return true;
+    m_streamServer = new httplib::Server();
+    m_streamServer->new_task_queue = [] { return new httplib::ThreadPool(STREAM_VIEWERS + 2); };
+
+    m_streamServer->Get("/", [](const httplib::Request&, httplib::Response& res) {
+        res.set_content("<!DOCTYPE html><html><body style=\"margin:0;background:#000\">"
+                        "<video src=\"/playback.mp4\" autoplay controls muted style=\"width:100%;height:100vh\"></video>"
+                        "</body></html>", "text/html");
+    });
+    m_streamServer->Get("/playback.mp4", [](const httplib::Request&, httplib::Response& res) {
+        std::shared_ptr<PlaybackBroadcast::Cursor> cursor = std::make_shared<PlaybackBroadcast::Cursor>();
+        res.set_header("Cache-Control", "no-cache");
+        res.set_chunked_content_provider("video/mp4", [cursor](size_t, httplib::DataSink& sink) {
+            PlaybackBroadcast::Segment seg;
+            if(!m_broadcast.next(*cursor, seg, std::chrono::milliseconds(500))) {
+                sink.done();
+                return true;
+            }
+            if(seg && !sink.write((const char*)seg->data(), seg->size())) return false;
+            return true;
+        });
+    });
+
+    if(!m_streamServer->bind_to_port("0.0.0.0", port)) {
+        delete m_streamServer;
+        m_streamServer = nullptr;
+        return false;
+    }
+    m_streaming = true;
+    m_streamThread = std::thread([]() { m_streamServer->listen_after_bind(); });
+    return true;
+}
+
+void _stopStreamServer()
+{
+    if(!m_streamServer) return;
+    m_streaming = false;
+    m_broadcast.dropViewers();
+    m_streamServer->stop();
+    m_streamThread.join();
+    delete m_streamServer;
+    m_streamServer = nullptr;
+}
 
 SCRSDK::CrError _getDeviceProperty(int64_t device_handle, uint32_t code, SCRSDK::CrDeviceProperty* devProp)
 {
@@ -177,12 +391,14 @@ public:
     void OnReceivePlaybackData(CrInt8u mediaType, CrInt32 dataSize, CrInt8u* data, CrInt64 pts, CrInt64 dts, CrInt32 param1, CrInt32 param2)
     {
     //  std::cout << "OnReceivePlaybackData:\n";
+        std::shared_ptr<FragmentedMp4Muxer> muxer = std::atomic_load(&m_muxer);
+        if(!muxer || dataSize <= 0) return;
         switch(mediaType) {
         case SCRSDK::CrMoviePlaybackDataType_Video:
-            if(m_fileVideo) m_fileVideo->write((char*)data, dataSize);
+            muxer->addVideo(data, dataSize, pts, dts, param1/*frameRate*/);
             break;
         case SCRSDK::CrMoviePlaybackDataType_Audio:
-            if(m_fileAudio) m_fileAudio->write((char*)data, dataSize);
+            muxer->addAudio(data, dataSize, pts, param1/*sampleRate*/, param2/*channel*/);
             break;
         }
     }
@@ -201,14 +417,13 @@ public:
         std::lock_guard<std::mutex> lock(m_eventPromiseMutex);
         switch(warning) {
         case SCRSDK::CrNotify_Playback_Result_StopComplete:
-            if(m_fileVideo) {
-                m_fileVideo->close();
-                m_fileVideo = nullptr;
-            }
-            if(m_fileAudio) {
-                m_fileAudio->close();
-                m_fileAudio = nullptr;
+            // flushing is left to the writer thread; the file is closed on the next start or exit
+            {
+                std::shared_ptr<FragmentedMp4Muxer> muxer = std::atomic_load(&m_muxer);
+                if(muxer) muxer->finish();
             }
+            m_fileMovie.finish();
+            m_broadcast.endStream();
             [[fallthrough]];
         case SCRSDK::CrNotify_Playback_StatusChanged:
             if(m_eventPromise) {
@@ -559,25 +774,17 @@ SCRSDK::CrError _playbackStart(int64_t device_handle, SCRSDK::CrSlotNumber slotN
     err = _controlMoviePlayback(device_handle, SCRSDK::CrMoviePlaybackControlType_Start);
     if(err) goto Error;
 
-    m_fileVideo = new std::ofstream(path + CrString(DELIMITER CRSTR("temp.hevc")), std::ios::out | std::ios::binary);
-    if (m_fileVideo->bad()) GotoError("", 0);
-
-    m_fileAudio = new std::ofstream(path + CrString(DELIMITER CRSTR("temp.aac")), std::ios::out | std::ios::binary);
-    if (m_fileAudio->bad()) GotoError("", 0);
-    CrCout << "write files to:" << path.data() << "\n" "Please convert files with \"ffmpeg -i temp.hevc -i temp.aac -c copy output.mp4\"\n";
+    _closePlaybackFiles();
+    if(!m_fileMovie.open(path + CrString(DELIMITER CRSTR("playback.mp4")), m_writerOptions)) GotoError("", 0);
+    m_broadcast.beginStream();
+    std::atomic_store(&m_muxer, std::make_shared<FragmentedMp4Muxer>(_onMuxedSegment));
+    CrCout << "write file to:" << path.data() << DELIMITER << "playback.mp4\n";
 
     err = _controlMoviePlayback(device_handle, SCRSDK::CrMoviePlaybackControlType_Play);
     if(err) goto Error;
     return 0;
 Error:
-    if(m_fileVideo) {
-        m_fileVideo->close();
-        m_fileVideo = nullptr;
-    }
-    if(m_fileAudio) {
-        m_fileAudio->close();
-        m_fileAudio = nullptr;
-    }
+    _closePlaybackFiles();
     return SCRSDK::CrError_Generic_Unknown;
 }
 
@@ -696,6 +903,8 @@ int main(void)
         std::cout << "  d                                         - Delete content\n"; \
         std::cout << "  ip <192.168.1.2(ip of this PC)>           - set ip of this PC\n"; \
         std::cout << "  p [1(start),2(stop),4(resume),5(pause),6(seek)] - Playback content\n"; \
+        std::cout << "  writer <0(no sync),1(sync on close),2(sync every chunk)> [1(direct I/O)] - playback file writing\n"; \
+        std::cout << "  serve <8080(port),0(stop)>                - re-stream playback at http://<ip>:<port>/playback.mp4\n"; \
         std::cout << "\n"; \
         std::cout << "  shot                                      - Shutter Release\n"; \
         std::cout << "  postview <1(enable),0(disable)> <0(legacy),0x8000(file),0x8001(ram)>\n"; \
@@ -779,11 +988,27 @@ int main(void)
                 }
                 //if(err) goto Error;
 
+            } else if(args[0] == "writer" && args.size() >= 2) { // playback file write policy
+                if(args2 < AsyncFileWriter::Sync_None || args2 > AsyncFileWriter::Sync_EveryChunk) {
+                    std::cout << "sync must be 0(no sync), 1(sync on close) or 2(sync every chunk)\n";
+                } else {
+                    m_writerOptions.sync = (AsyncFileWriter::SyncPolicy)args2;
+                    m_writerOptions.directIO = (args.size() >= 3 && args[2] == "1");
+                    std::cout << "sync=" << m_writerOptions.sync << ",directIO=" << m_writerOptions.directIO << "\n";
+                }
+
+            } else if(args[0] == "serve" && args.size() >= 2) { // live re-streaming of playback
+                _stopStreamServer();
+                if(args2 > 0 && !_startStreamServer(args2)) {
+                    std::cout << "cannot listen on port " << args2 << "\n";
+                } else if(args2 > 0) {
+                    std::cout << "streaming at http://" << (ipAddress.empty() ? "localhost" : ipAddress) << ":" << args2 << "/playback.mp4\n";
+                }
+
             } else if (args[0] == "shot" || args[0] == "SHOT") { // Shutter Release
                 err = _shooting(m_device_handle);
                 //if (err) goto Error;
 
-                // ffmpeg -i temp.hevc -i temp.aac -c copy output.mp4
             } else if(args[0] == "postview" && args.size() >= 3) {
                 int data = 0;
                 try { data = (int)_stoll(args[1]); } catch(const std::exception&) { GotoError("", 0); }
@@ -836,14 +1061,8 @@ Error:
     if(m_device_handle) SCRSDK::ReleaseDevice(m_device_handle);
     SCRSDK::Release();
 
-    if(m_fileVideo) {
-        m_fileVideo->close();
-        m_fileVideo = nullptr;
-    }
-    if(m_fileAudio) {
-        m_fileAudio->close();
-        m_fileAudio = nullptr;
-    }
+    _closePlaybackFiles();
+    _stopStreamServer();
 
     return result;
 }
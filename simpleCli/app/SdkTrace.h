@@ -0,0 +1,393 @@
+/* Per-thread trace of Camera Remote SDK calls, dumped as Chrome trace-event JSON */
+
+#ifndef SDKTRACE_H
+#define SDKTRACE_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "CameraRemote_SDK.h"
+#include "CrDebugString.h"
+
+// Each thread appends to its own fixed ring of events, so recording a call
+// takes no lock and allocates nothing after the first call on a thread. The
+// ring keeps the latest kCapacity calls; the error code is stored as is and
+// only turned into a name (CrErrorString) when the trace is written. A ring
+// outlives its thread until the next dump, then goes to the next new thread;
+// at most kMaxRetired rings of exited threads are kept, so short-lived
+// threads do not add up.
+// Open the output in chrome://tracing or https://ui.perfetto.dev.
+namespace SdkTrace {
+
+struct Event {
+    const char* api;  // string literal
+    int64_t device;   // CrDeviceHandle, 0 before Connect
+    int64_t startNs;  // since the trace epoch
+    int64_t endNs;
+    SCRSDK::CrError error;
+};
+
+class ThreadBuffer
+{
+public:
+    static constexpr uint64_t kCapacity = 4096;
+
+    explicit ThreadBuffer(uint32_t tid) : m_tid(tid), m_events(kCapacity) {}
+
+    // Owning thread only
+    void push(const Event& e)
+    {
+        uint64_t head = m_head.load(std::memory_order_relaxed);
+        m_events[head % kCapacity] = e;
+        m_head.store(head + 1, std::memory_order_release);
+    }
+
+    // Any thread. Slots the owner may have overwritten during the copy are dropped.
+    void snapshot(std::vector<Event>& out) const
+    {
+        uint64_t end = m_head.load(std::memory_order_acquire);
+        uint64_t begin = end > kCapacity ? end - kCapacity : 0;
+        size_t first = out.size();
+        for (uint64_t i = begin; i < end; i++) out.push_back(m_events[i % kCapacity]);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t now = m_head.load(std::memory_order_relaxed);
+        uint64_t valid = now >= kCapacity ? now - kCapacity + 1 : 0;
+        if (valid > begin) {
+            size_t stale = (size_t)std::min<uint64_t>(valid - begin, end - begin);
+            out.erase(out.begin() + first, out.begin() + first + stale);
+        }
+    }
+
+    void clear() { m_head.store(0, std::memory_order_release); }
+    bool empty() const { return m_head.load(std::memory_order_acquire) == 0; }
+
+    // Registry mutex held, no thread owning the ring
+    void reset(uint32_t tid)
+    {
+        m_tid = tid;
+        name.clear();
+        clear();
+    }
+
+    uint32_t tid() const { return m_tid; }
+
+    // Registry mutex held for these
+    std::string name;
+    bool live = true;        // a running thread records into it
+    bool dumped = false;     // its thread has exited and the events were written out since
+    uint64_t retiredSeq = 0; // order in which threads exited
+
+private:
+    uint32_t m_tid;
+    std::vector<Event> m_events;
+    std::atomic<uint64_t> m_head{0};
+};
+
+struct Registry {
+    static constexpr size_t kMaxRetired = 8;
+
+    std::mutex mutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers; // live and retired
+    uint32_t nextTid = 1;
+    uint64_t retiredSeq = 0;
+    std::atomic<bool> enabled{true};
+    std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+};
+
+inline Registry& registry()
+{
+    static Registry r;
+    return r;
+}
+
+// A retired ring that was dumped or is empty, else the oldest one once
+// kMaxRetired are kept, else a new ring
+inline ThreadBuffer* acquireBuffer()
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    ThreadBuffer* reuse = nullptr;
+    ThreadBuffer* oldest = nullptr;
+    size_t retired = 0;
+    for (auto& b : r.buffers) {
+        if (b->live) continue;
+        retired++;
+        if (!reuse && (b->dumped || b->empty())) reuse = b.get();
+        if (!oldest || b->retiredSeq < oldest->retiredSeq) oldest = b.get();
+    }
+    if (!reuse && retired >= Registry::kMaxRetired) reuse = oldest;
+    if (reuse) {
+        reuse->reset(r.nextTid++);
+        reuse->live = true;
+        return reuse;
+    }
+    r.buffers.push_back(std::make_shared<ThreadBuffer>(r.nextTid++));
+    return r.buffers.back().get();
+}
+
+// Keeps the events for the next dump
+inline void releaseBuffer(ThreadBuffer* buffer)
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    buffer->live = false;
+    buffer->dumped = false;
+    buffer->retiredSeq = ++r.retiredSeq;
+}
+
+inline ThreadBuffer& threadBuffer()
+{
+    // Hands the ring back when the thread exits
+    struct Owner {
+        ThreadBuffer* buffer = nullptr;
+        ~Owner() { if (buffer) releaseBuffer(buffer); }
+    };
+    static thread_local Owner owner;
+    if (!owner.buffer) owner.buffer = acquireBuffer();
+    return *owner.buffer;
+}
+
+inline int64_t nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - registry().epoch).count();
+}
+
+inline void setEnabled(bool enabled) { registry().enabled.store(enabled, std::memory_order_relaxed); }
+
+// Label the calling thread in the trace viewer
+inline void setThreadName(const std::string& name)
+{
+    ThreadBuffer& buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock(registry().mutex);
+    buffer.name = name;
+}
+
+// Drops the events recorded so far (threads that are recording may keep a few)
+inline void clear()
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (auto& b : r.buffers) b->clear();
+}
+
+template <typename F>
+inline SCRSDK::CrError traced(const char* api, int64_t device, F&& call)
+{
+    if (!registry().enabled.load(std::memory_order_relaxed)) return call();
+    int64_t start = nowNs();
+    SCRSDK::CrError error = call();
+    threadBuffer().push(Event{ api, device, start, nowNs(), error });
+    return error;
+}
+
+inline void writeChromeTrace(std::string& out)
+{
+    struct Span {
+        uint32_t tid;
+        Event event;
+    };
+    std::vector<Span> spans;
+    std::vector<std::pair<uint32_t, std::string>> names;
+    {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        std::vector<Event> events;
+        for (auto& b : r.buffers) {
+            events.clear();
+            b->snapshot(events);
+            for (const auto& e : events) spans.push_back(Span{ b->tid(), e });
+            if (!b->name.empty()) names.emplace_back(b->tid(), b->name);
+            if (!b->live) b->dumped = true;
+        }
+    }
+
+    char buf[512];
+    out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    for (const auto& n : names) {
+        snprintf(buf, sizeof(buf), "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"",
+                 first ? "" : ",", n.first);
+        out += buf;
+        for (char c : n.second) {
+            if (c == '"' || c == '\\') out += '\\';
+            if ((unsigned char)c >= 0x20) out += c;
+        }
+        out += "\"}}";
+        first = false;
+    }
+    for (const auto& s : spans) {
+        const Event& e = s.event;
+        snprintf(buf, sizeof(buf),
+                 "%s{\"name\":\"%s\",\"cat\":\"sdk\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,"
+                 "\"args\":{\"device\":\"0x%llx\",\"error\":\"%s\"}}",
+                 first ? "" : ",", e.api, s.tid, e.startNs / 1000.0, (e.endNs - e.startNs) / 1000.0,
+                 (unsigned long long)e.device, e.error ? CrErrorString(e.error).c_str() : "None");
+        out += buf;
+        first = false;
+    }
+    out += "]}\n";
+}
+
+inline bool writeChromeTraceFile(const std::string& path)
+{
+    std::string json;
+    writeChromeTrace(json);
+    std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file) return false;
+    file.write(json.data(), json.size());
+    return (bool)file;
+}
+
+} // namespace SdkTrace
+
+// Same names and arguments as SCRSDK, each call recorded in the trace
+namespace SdkCall {
+
+#define SDKCALL_TRACED(api, device, ...) SdkTrace::traced(api, (int64_t)(device), [&]() { return SCRSDK::__VA_ARGS__; })
+
+inline SCRSDK::CrError EnumCameraObjects(SCRSDK::ICrEnumCameraObjectInfo** ppEnumCameraObjectInfo, CrInt8u timeInSec = 3)
+{
+    return SDKCALL_TRACED("EnumCameraObjects", 0, EnumCameraObjects(ppEnumCameraObjectInfo, timeInSec));
+}
+
+inline SCRSDK::CrError CreateCameraObjectInfoUSBConnection(SCRSDK::ICrCameraObjectInfo** pCameraObjectInfo, SCRSDK::CrCameraDeviceModelList model, CrInt8u* usbSerialNumber)
+{
+    return SDKCALL_TRACED("CreateCameraObjectInfoUSBConnection", 0, CreateCameraObjectInfoUSBConnection(pCameraObjectInfo, model, usbSerialNumber));
+}
+
+inline SCRSDK::CrError CreateCameraObjectInfoEthernetConnection(SCRSDK::ICrCameraObjectInfo** pCameraObjectInfo, SCRSDK::CrCameraDeviceModelList model, CrInt32u ipAddress, CrInt8u* macAddress, CrInt32u sshSupport = 0)
+{
+    return SDKCALL_TRACED("CreateCameraObjectInfoEthernetConnection", 0, CreateCameraObjectInfoEthernetConnection(pCameraObjectInfo, model, ipAddress, macAddress, sshSupport));
+}
+
+inline SCRSDK::CrError GetFingerprint(SCRSDK::ICrCameraObjectInfo* pCameraObjectInfo, char* fingerprint, CrInt32u* fingerprintSize)
+{
+    return SDKCALL_TRACED("GetFingerprint", 0, GetFingerprint(pCameraObjectInfo, fingerprint, fingerprintSize));
+}
+
+// The span ends when Connect returns; OnConnected arrives later
+inline SCRSDK::CrError Connect(SCRSDK::ICrCameraObjectInfo* pCameraObjectInfo, SCRSDK::IDeviceCallback* callback, SCRSDK::CrDeviceHandle* deviceHandle,
+                               SCRSDK::CrSdkControlMode openMode = SCRSDK::CrSdkControlMode_Remote, SCRSDK::CrReconnectingSet reconnect = SCRSDK::CrReconnecting_ON,
+                               const char* userId = 0, const char* userPassword = 0, const char* fingerprint = 0, CrInt32u fingerprintSize = 0)
+{
+    return SDKCALL_TRACED("Connect", 0, Connect(pCameraObjectInfo, callback, deviceHandle, openMode, reconnect, userId, userPassword, fingerprint, fingerprintSize));
+}
+
+inline SCRSDK::CrError Disconnect(SCRSDK::CrDeviceHandle deviceHandle)
+{
+    return SDKCALL_TRACED("Disconnect", deviceHandle, Disconnect(deviceHandle));
+}
+
+inline SCRSDK::CrError ReleaseDevice(SCRSDK::CrDeviceHandle deviceHandle)
+{
+    return SDKCALL_TRACED("ReleaseDevice", deviceHandle, ReleaseDevice(deviceHandle));
+}
+
+inline SCRSDK::CrError GetDeviceProperties(SCRSDK::CrDeviceHandle deviceHandle, SCRSDK::CrDeviceProperty** properties, CrInt32* numOfProperties)
+{
+    return SDKCALL_TRACED("GetDeviceProperties", deviceHandle, GetDeviceProperties(deviceHandle, properties, numOfProperties));
+}
+
+inline SCRSDK::CrError GetSelectDeviceProperties(SCRSDK::CrDeviceHandle deviceHandle, CrInt32u numOfCodes, CrInt32u* codes, SCRSDK::CrDeviceProperty** properties, CrInt32* numOfProperties)
+{
+    return SDKCALL_TRACED("GetSelectDeviceProperties", deviceHandle, GetSelectDeviceProperties(deviceHandle, numOfCodes, codes, properties, numOfProperties));
+}
+
+inline SCRSDK::CrError ReleaseDeviceProperties(SCRSDK::CrDeviceHandle deviceHandle, SCRSDK::CrDeviceProperty* properties)
+{
+    return SDKCALL_TRACED("ReleaseDeviceProperties", deviceHandle, ReleaseDeviceProperties(deviceHandle, properties));
+}
+
+inline SCRSDK::CrError SetDeviceProperty(SCRSDK::CrDeviceHandle deviceHandle, SCRSDK::CrDeviceProperty* pProperty)
+{
+    return SDKCALL_TRACED("SetDeviceProperty", deviceHandle, SetDeviceProperty(deviceHandle, pProperty));
+}
+
+inline SCRSDK::CrError SendCommand(SCRSDK::CrDeviceHandle deviceHandle, CrInt32u commandId, SCRSDK::CrCommandParam commandParam)
+{
+    return SDKCALL_TRACED("SendCommand", deviceHandle, SendCommand(deviceHandle, commandId, commandParam));
+}
+
+inline SCRSDK::CrError ExecuteControlCodeValue(SCRSDK::CrDeviceHandle deviceHandle, SCRSDK::CrControlCode code, CrInt64u value)
+{
+    return SDKCALL_TRACED("ExecuteControlCodeValue", deviceHandle, ExecuteControlCodeValue(deviceHandle, code, value));
+}
+
+inline SCRSDK::CrError GetLiveViewImageInfo(SCRSDK::CrDeviceHandle deviceHandle, SCRSDK::CrImageInfo* info)
+{
+    return SDKCALL_TRACED("GetLiveViewImageInfo", deviceHandle, GetLiveViewImageInfo(deviceHandle, info));
+}
+
+inline SCRSDK::CrError GetLiveViewImage(SCRSDK::CrDeviceHandle deviceHandle, SCRSDK::CrImageDataBlock* imageData)
+{
+    return SDKCALL_TRACED("GetLiveViewImage", deviceHandle, GetLiveViewImage(deviceHandle, imageData));
+}
+
+inline SCRSDK::CrError SetSaveInfo(SCRSDK::CrDeviceHandle deviceHandle, CrChar* path, CrChar* prefix, CrInt32 no)
+{
+    return SDKCALL_TRACED("SetSaveInfo", deviceHandle, SetSaveInfo(deviceHandle, path, prefix, no));
+}
+
+inline SCRSDK::CrError GetDateFolderList(SCRSDK::CrDeviceHandle deviceHandle, SCRSDK::CrMtpFolderInfo** folders, CrInt32u* numOfFolders)
+{
+    return SDKCALL_TRACED("GetDateFolderList", deviceHandle, GetDateFolderList(deviceHandle, folders, numOfFolders));
+}
+
+inline SCRSDK::CrError GetContentsHandleList(SCRSDK::CrDeviceHandle deviceHandle, SCRSDK::CrFolderHandle folderHandle, SCRSDK::CrContentHandle** contentsHandles, CrInt32u* numOfContents)
+{
+    return SDKCALL_TRACED("GetContentsHandleList", deviceHandle, GetContentsHandleList(deviceHandle, folderHandle, contentsHandles, numOfContents));
+}
+
+inline SCRSDK::CrError GetContentsDetailInfo(SCRSDK::CrDeviceHandle deviceHandle, SCRSDK::CrContentHandle contentHandle, SCRSDK::CrMtpContentsInfo* contentsInfo)
+{
+    return SDKCALL_TRACED("GetContentsDetailInfo", deviceHandle, GetContentsDetailInfo(deviceHandle, contentHandle, contentsInfo));
+}
+
+inline SCRSDK::CrError ReleaseDateFolderList(SCRSDK::CrDeviceHandle deviceHandle, SCRSDK::CrMtpFolderInfo* folders)
+{
+    return SDKCALL_TRACED("ReleaseDateFolderList", deviceHandle, ReleaseDateFolderList(deviceHandle, folders));
+}
+
+inline SCRSDK::CrError ReleaseContentsHandleList(SCRSDK::CrDeviceHandle deviceHandle, SCRSDK::CrContentHandle* contentsHandles)
+{
+    return SDKCALL_TRACED("ReleaseContentsHandleList", deviceHandle, ReleaseContentsHandleList(deviceHandle, contentsHandles));
+}
+
+// The span ends when the request is accepted; completion is reported by OnCompleteDownload
+inline SCRSDK::CrError PullContentsFile(SCRSDK::CrDeviceHandle deviceHandle, SCRSDK::CrContentHandle contentHandle,
+                                        SCRSDK::CrPropertyStillImageTransSize size = SCRSDK::CrPropertyStillImageTransSize_Original,
+                                        CrChar* path = 0, CrChar* fileName = 0)
+{
+    return SDKCALL_TRACED("PullContentsFile", deviceHandle, PullContentsFile(deviceHandle, contentHandle, size, path, fileName));
+}
+
+inline SCRSDK::CrError GetContentsThumbnailImage(SCRSDK::CrDeviceHandle deviceHandle, SCRSDK::CrContentHandle contentHandle, SCRSDK::CrImageDataBlock* imageData, SCRSDK::CrFileType* fileType)
+{
+    return SDKCALL_TRACED("GetContentsThumbnailImage", deviceHandle, GetContentsThumbnailImage(deviceHandle, contentHandle, imageData, fileType));
+}
+
+inline SCRSDK::CrError GetRemoteTransferContentsInfoList(SCRSDK::CrDeviceHandle deviceHandle, SCRSDK::CrSlotNumber slotNumber, SCRSDK::CrGetContentsInfoListType type,
+                                                         SCRSDK::CrCaptureDate* captureDate, CrInt32u maxNums, SCRSDK::CrContentsInfo** contentsInfoList, CrInt32u* nums)
+{
+    return SDKCALL_TRACED("GetRemoteTransferContentsInfoList", deviceHandle, GetRemoteTransferContentsInfoList(deviceHandle, slotNumber, type, captureDate, maxNums, contentsInfoList, nums));
+}
+
+inline SCRSDK::CrError GetRemoteTransferContentsDataFile(SCRSDK::CrDeviceHandle deviceHandle, SCRSDK::CrSlotNumber slotNumber, CrInt32u contentsId, CrInt32u fileId,
+                                                         CrInt32u divisionSize, CrChar* path, CrChar* fileName)
+{
+    return SDKCALL_TRACED("GetRemoteTransferContentsDataFile", deviceHandle, GetRemoteTransferContentsDataFile(deviceHandle, slotNumber, contentsId, fileId, divisionSize, path, fileName));
+}
+
+#undef SDKCALL_TRACED
+
+} // namespace SdkCall
+
+#endif // SDKTRACE_H
@@ -39,6 +39,7 @@
 #include "CrDeviceProperty.h"
 #include "CameraRemote_SDK.h"
 #include "IDeviceCallback.h"
+#include "SdkTrace.h"
 
 #define PrintError(msg, err) { fprintf(stderr, "Error in %s(%d):" msg ",0x%x\n", __FUNCTION__, __LINE__, err); }
 #define GotoError(msg, err) { PrintError(msg, err); goto Error; }
@@ -132,7 +133,7 @@ SCRSDK::CrError _getIdPassword(SCRSDK::ICrCameraObjectInfo* objInfo, std::string
 {
     char fpBuff[128] = {0};
     CrInt32u fpLen = 0;
-    SCRSDK::CrError err = SCRSDK::GetFingerprint(objInfo, fpBuff, &fpLen);
+    SCRSDK::CrError err = SdkCall::GetFingerprint(objInfo, fpBuff, &fpLen);
     if(err) GotoError("", err);
     fingerprint = std::string(fpBuff, fpLen);
 
@@ -170,7 +171,7 @@ int main(void)
         uint32_t count = 0;
         uint32_t index = 1;
 
-        err = SCRSDK::EnumCameraObjects(&enumCameraObjectInfo, 3/*timeInSec*/);
+        err = SdkCall::EnumCameraObjects(&enumCameraObjectInfo, 3/*timeInSec*/);
         if(err || !enumCameraObjectInfo) GotoError("no camera", err);
 
         count = enumCameraObjectInfo->GetCount();
@@ -202,7 +203,7 @@ int main(void)
         }
 
         setEventPromise(&eventPromise);
-        err = SCRSDK::Connect(objInfo, &deviceCallback, &m_device_handle,
+        err = SdkCall::Connect(objInfo, &deviceCallback, &m_device_handle,
             SCRSDK::CrSdkControlMode_Remote,
             SCRSDK::CrReconnecting_ON,
             userId.c_str(), userPassword.c_str(), fingerprint.c_str(), (uint32_t)fingerprint.size());
@@ -218,7 +219,7 @@ int main(void)
     // set work directory
     {
         CrCout << "path=" << path.data() << "\n";
-        err = SCRSDK::SetSaveInfo(m_device_handle, const_cast<CrChar*>(path.data()), const_cast<CrChar*>(CRSTR("DSC")), -1/*startNo*/);
+        err = SdkCall::SetSaveInfo(m_device_handle, const_cast<CrChar*>(path.data()), const_cast<CrChar*>(CRSTR("DSC")), -1/*startNo*/);
         if(err) GotoError("", err);
     }
 
@@ -244,10 +245,11 @@ Error:
         std::promise<void> eventPromise;
         std::future<void> eventFuture = eventPromise.get_future();
         setEventPromise(&eventPromise);
-        SCRSDK::Disconnect(m_device_handle);
+        SdkCall::Disconnect(m_device_handle);
         eventFuture.wait_for(std::chrono::milliseconds(3000));
     }
-    if(m_device_handle) SCRSDK::ReleaseDevice(m_device_handle);
+    if(m_device_handle) SdkCall::ReleaseDevice(m_device_handle);
+    SdkTrace::writeChromeTraceFile("connect_trace.json"); // chrome://tracing
     SCRSDK::Release();
 
     return result;
@@ -3,19 +3,26 @@
 // a web-based REST API + embedded HTML dashboard for
 // simultaneous start/stop recording, status monitoring, and file download.
 
+#include <algorithm>
 #include <atomic>
+#include <charconv>
 #include <chrono>
 #include <cinttypes>
+#include <condition_variable>
 #include <cstdint>
 #include <cstdlib>
+#include <cstring>
+#include <deque>
 #include <filesystem>
 #include <fstream>
+#include <functional>
 #include <future>
 #include <iostream>
 #include <memory>
 #include <mutex>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <thread>
 #include <vector>
 
@@ -45,6 +52,13 @@
 #include "IDeviceCallback.h"
 #include "CrDebugString.h"
 #include "httplib.h"
+#include "MediaVerifier.h"
+#include "AsyncOps.h"
+#include "CallbackDispatcher.h"
+#include "JobExecutor.h"
+#include "Metrics.h"
+#include "SdkTrace.h"
+#include "Logger.h"
 
 namespace fs = std::filesystem;
 
@@ -94,10 +108,10 @@ static bool resetUSBDevice(uint16_t vendorId, uint16_t productId)
         (*dev)->Release(dev);
 
         if (kr == KERN_SUCCESS) {
-            std::cout << "  USB device reset successful.\n";
+            logInfo("USB device reset");
             resetOk = true;
         } else {
-            std::cout << "  USB device reset returned: " << kr << "\n";
+            logWarn("USB device reset failed").kv("result", (int)kr);
         }
     }
     IOObjectRelease(iterator);
@@ -129,31 +143,498 @@ static CrString getModelId(const SCRSDK::ICrCameraObjectInfo* objInfo)
     return CrString(objInfo->GetModel()).append(CRSTR(" (")).append(id).append(CRSTR(")"));
 }
 
-// JSON string escaping
-static std::string jsonEscape(const std::string& s)
+// ---------------------------------------------------------------------------
+// JSON Writer
+// ---------------------------------------------------------------------------
+
+// Append-only JSON writer. Escapes strings and formats integers straight into
+// its buffer, so building a response costs no allocation once the buffer has
+// grown to the largest response size. Commas are inserted automatically.
+class JsonWriter
 {
-    std::string out;
-    out.reserve(s.size() + 8);
-    for (unsigned char c : s) {
-        switch (c) {
-            case '"':  out += "\\\""; break;
-            case '\\': out += "\\\\"; break;
-            case '\n': out += "\\n";  break;
-            case '\r': out += "\\r";  break;
-            case '\t': out += "\\t";  break;
-            default:
-                if (c < 0x20) {
+public:
+    void reset()
+    {
+        m_buf.clear();
+        m_depth = 0;
+        m_first[0] = true;
+    }
+
+    const char* data() const { return m_buf.data(); }
+    size_t size() const { return m_buf.size(); }
+
+    JsonWriter& beginObject() { separate(); m_buf += '{'; push(); return *this; }
+    JsonWriter& endObject()   { pop(); m_buf += '}'; return *this; }
+    JsonWriter& beginArray()  { separate(); m_buf += '['; push(); return *this; }
+    JsonWriter& endArray()    { pop(); m_buf += ']'; return *this; }
+
+    JsonWriter& key(std::string_view k)
+    {
+        separate();
+        appendString(k);
+        m_buf += ':';
+        m_afterKey = true;
+        return *this;
+    }
+
+    JsonWriter& value(std::string_view v) { separate(); appendString(v); return *this; }
+    JsonWriter& value(const char* v)      { return value(std::string_view(v)); }
+    JsonWriter& value(bool v)             { separate(); m_buf += v ? "true" : "false"; return *this; }
+    JsonWriter& value(int v)              { return appendInteger((long long)v); }
+    JsonWriter& value(long v)             { return appendInteger((long long)v); }
+    JsonWriter& value(long long v)        { return appendInteger(v); }
+    JsonWriter& value(unsigned v)         { return appendInteger((unsigned long long)v); }
+    JsonWriter& value(unsigned long v)    { return appendInteger((unsigned long long)v); }
+    JsonWriter& value(unsigned long long v) { return appendInteger(v); }
+    JsonWriter& null()                    { separate(); m_buf += "null"; return *this; }
+
+    // Insert already-serialized JSON verbatim (e.g. a preset file's contents)
+    JsonWriter& raw(std::string_view json) { separate(); m_buf.append(json.data(), json.size()); return *this; }
+
+    template <typename T>
+    JsonWriter& kv(std::string_view k, const T& v) { key(k); return value(v); }
+
+private:
+    static const int kMaxDepth = 32;
+
+    std::string m_buf;
+    int  m_depth = 0;
+    bool m_first[kMaxDepth] = { true };
+    bool m_afterKey = false;
+
+    void separate()
+    {
+        if (m_afterKey) { m_afterKey = false; return; }
+        if (!m_first[m_depth]) m_buf += ',';
+        m_first[m_depth] = false;
+    }
+
+    void push() { if (m_depth + 1 < kMaxDepth) m_first[++m_depth] = true; }
+    void pop()  { if (m_depth > 0) m_depth--; }
+
+    template <typename T>
+    JsonWriter& appendInteger(T v)
+    {
+        separate();
+        char tmp[24];
+        auto r = std::to_chars(tmp, tmp + sizeof(tmp), v);
+        m_buf.append(tmp, r.ptr);
+        return *this;
+    }
+
+    void appendString(std::string_view s)
+    {
+        static const char kHex[] = "0123456789abcdef";
+        m_buf += '"';
+        // Copy runs of plain characters in one append; only escapes go char by char
+        size_t run = 0;
+        for (size_t i = 0; i < s.size(); i++) {
+            unsigned char c = (unsigned char)s[i];
+            if (c >= 0x20 && c != '"' && c != '\\') continue;
+            m_buf.append(s.data() + run, i - run);
+            run = i + 1;
+            switch (c) {
+                case '"':  m_buf += "\\\""; break;
+                case '\\': m_buf += "\\\\"; break;
+                case '\n': m_buf += "\\n";  break;
+                case '\r': m_buf += "\\r";  break;
+                case '\t': m_buf += "\\t";  break;
+                default: {
                     // Escape control characters as \u00XX
-                    char buf[8];
-                    snprintf(buf, sizeof(buf), "\\u%04x", c);
-                    out += buf;
-                } else {
-                    out += (char)c;
+                    char esc[6] = { '\\', 'u', '0', '0', kHex[c >> 4], kHex[c & 0xF] };
+                    m_buf.append(esc, sizeof(esc));
+                    break;
                 }
-                break;
+            }
         }
+        m_buf.append(s.data() + run, s.size() - run);
+        m_buf += '"';
     }
-    return out;
+};
+
+// Per-thread writer reused by every /api/* handler (httplib serves requests
+// from a fixed thread pool, so each worker keeps one warmed-up buffer).
+static JsonWriter& jsonWriter()
+{
+    static thread_local JsonWriter w;
+    w.reset();
+    return w;
+}
+
+static void sendJson(httplib::Response& res, const JsonWriter& w)
+{
+    res.set_content(w.data(), w.size(), "application/json");
+}
+
+static void sendError(httplib::Response& res, std::string_view message)
+{
+    JsonWriter& w = jsonWriter();
+    w.beginObject().kv("error", message).endObject();
+    sendJson(res, w);
+}
+
+// ---------------------------------------------------------------------------
+// JSON Reader
+// ---------------------------------------------------------------------------
+
+// Single-pass JSON tokenizer. The document is flattened into one vector of
+// tokens that point back into the source text, so parsing a request body
+// allocates only the token vector; strings are unescaped on demand.
+struct JsonToken
+{
+    enum Type { Null, Bool, Number, String, Array, Object };
+
+    Type type;
+    std::string_view text;  // Raw text; for strings, the contents between the quotes
+    int  count;             // Arrays: element count, objects: member count
+    int  next;              // Index of the token following this value's subtree
+    bool escaped;           // String contains backslash escapes
+};
+
+class JsonDocument;
+
+// Lightweight handle to one value inside a JsonDocument
+class JsonValue
+{
+public:
+    JsonValue() {}
+    JsonValue(const JsonDocument* doc, int index) : m_doc(doc), m_index(index) {}
+
+    bool valid() const { return m_doc != nullptr; }
+    bool isNull() const   { return is(JsonToken::Null); }
+    bool isBool() const   { return is(JsonToken::Bool); }
+    bool isNumber() const { return is(JsonToken::Number); }
+    bool isString() const { return is(JsonToken::String); }
+    bool isArray() const  { return is(JsonToken::Array); }
+    bool isObject() const { return is(JsonToken::Object); }
+
+    int size() const;
+
+    // Object member lookup; returns an invalid value if absent or not an object
+    JsonValue operator[](std::string_view key) const;
+    // Array element; returns an invalid value if out of range or not an array
+    JsonValue at(int i) const;
+
+    // Visit every member of an object as (key, value)
+    template <typename F>
+    void forEachMember(F&& f) const;
+    // Visit every element of an array
+    template <typename F>
+    void forEachElement(F&& f) const;
+
+    bool asBool(bool& out) const;
+    bool asInt(int64_t& out) const;
+    bool asUint(uint64_t& out) const;
+    bool asString(std::string& out) const;
+
+    // String contents without unescaping; only meaningful for plain strings (keys, enum names)
+    std::string_view rawString() const;
+
+private:
+    const JsonDocument* m_doc = nullptr;
+    int m_index = 0;
+
+    const JsonToken& tok() const;
+    bool is(JsonToken::Type t) const { return valid() && tok().type == t; }
+};
+
+class JsonDocument
+{
+public:
+    // Parse the whole text; on failure error() describes the first problem
+    bool parse(std::string_view text)
+    {
+        m_tokens.clear();
+        m_error = nullptr;
+        m_p = text.data();
+        m_end = text.data() + text.size();
+
+        skipSpace();
+        if (!parseValue(0)) return false;
+        skipSpace();
+        if (m_p != m_end) return fail("trailing characters");
+        return true;
+    }
+
+    JsonValue root() const { return m_tokens.empty() ? JsonValue() : JsonValue(this, 0); }
+    const char* error() const { return m_error ? m_error : ""; }
+    const JsonToken& token(int i) const { return m_tokens[i]; }
+
+private:
+    static const int kMaxDepth = 32;
+
+    std::vector<JsonToken> m_tokens;
+    const char* m_p = nullptr;
+    const char* m_end = nullptr;
+    const char* m_error = nullptr;
+
+    bool fail(const char* msg) { if (!m_error) m_error = msg; return false; }
+
+    void skipSpace()
+    {
+        while (m_p < m_end && (*m_p == ' ' || *m_p == '\t' || *m_p == '\n' || *m_p == '\r')) m_p++;
+    }
+
+    int addToken(JsonToken::Type type, std::string_view text)
+    {
+        m_tokens.push_back({ type, text, 0, 0, false });
+        return (int)m_tokens.size() - 1;
+    }
+
+    bool literal(const char* word, JsonToken::Type type)
+    {
+        size_t n = strlen(word);
+        if ((size_t)(m_end - m_p) < n || memcmp(m_p, word, n) != 0) return fail("invalid literal");
+        int t = addToken(type, std::string_view(m_p, n));
+        m_p += n;
+        m_tokens[t].next = t + 1;
+        return true;
+    }
+
+    static bool isDigit(char c) { return c >= '0' && c <= '9'; }
+    static bool isHex(char c) { return isDigit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F'); }
+
+    bool parseValue(int depth)
+    {
+        if (depth >= kMaxDepth) return fail("nesting too deep");
+        if (m_p >= m_end) return fail("unexpected end of input");
+
+        switch (*m_p) {
+        case '{': return parseContainer(depth, '}', JsonToken::Object);
+        case '[': return parseContainer(depth, ']', JsonToken::Array);
+        case '"': return parseString();
+        case 't': return literal("true", JsonToken::Bool);
+        case 'f': return literal("false", JsonToken::Bool);
+        case 'n': return literal("null", JsonToken::Null);
+        default:  return parseNumber();
+        }
+    }
+
+    bool parseContainer(int depth, char close, JsonToken::Type type)
+    {
+        int t = addToken(type, std::string_view());
+        const char* start = m_p++;
+        int count = 0;
+
+        skipSpace();
+        if (m_p < m_end && *m_p == close) {
+            m_p++;
+        } else {
+            for (;;) {
+                if (type == JsonToken::Object) {
+                    if (m_p >= m_end || *m_p != '"') return fail("expected object key");
+                    if (!parseString()) return false;
+                    skipSpace();
+                    if (m_p >= m_end || *m_p != ':') return fail("expected ':'");
+                    m_p++;
+                    skipSpace();
+                }
+                if (!parseValue(depth + 1)) return false;
+                count++;
+                skipSpace();
+                if (m_p < m_end && *m_p == ',') { m_p++; skipSpace(); continue; }
+                if (m_p < m_end && *m_p == close) { m_p++; break; }
+                return fail(type == JsonToken::Object ? "expected ',' or '}'" : "expected ',' or ']'");
+            }
+        }
+
+        JsonToken& tok = m_tokens[t];
+        tok.text = std::string_view(start, m_p - start);
+        tok.count = count;
+        tok.next = (int)m_tokens.size();
+        return true;
+    }
+
+    bool parseString()
+    {
+        const char* start = ++m_p;
+        bool escaped = false;
+        while (m_p < m_end && *m_p != '"') {
+            unsigned char c = (unsigned char)*m_p;
+            if (c < 0x20) return fail("control character in string");
+            if (c == '\\') {
+                escaped = true;
+                if (++m_p >= m_end) break;
+                if (*m_p == 'u') {
+                    for (int i = 0; i < 4; i++) {
+                        if (++m_p >= m_end || !isHex(*m_p)) return fail("invalid \\u escape");
+                    }
+                } else if (!strchr("\"\\/bfnrt", *m_p)) {
+                    return fail("invalid escape");
+                }
+            }
+            m_p++;
+        }
+        if (m_p >= m_end) return fail("unterminated string");
+
+        int t = addToken(JsonToken::String, std::string_view(start, m_p - start));
+        m_tokens[t].escaped = escaped;
+        m_tokens[t].next = t + 1;
+        m_p++;
+        return true;
+    }
+
+    bool parseNumber()
+    {
+        const char* start = m_p;
+        if (m_p < m_end && *m_p == '-') m_p++;
+        if (m_p >= m_end || !isDigit(*m_p)) return fail("invalid value");
+        while (m_p < m_end && isDigit(*m_p)) m_p++;
+        if (m_p < m_end && *m_p == '.') {
+            m_p++;
+            if (m_p >= m_end || !isDigit(*m_p)) return fail("invalid number");
+            while (m_p < m_end && isDigit(*m_p)) m_p++;
+        }
+        if (m_p < m_end && (*m_p == 'e' || *m_p == 'E')) {
+            m_p++;
+            if (m_p < m_end && (*m_p == '+' || *m_p == '-')) m_p++;
+            if (m_p >= m_end || !isDigit(*m_p)) return fail("invalid number");
+            while (m_p < m_end && isDigit(*m_p)) m_p++;
+        }
+        int t = addToken(JsonToken::Number, std::string_view(start, m_p - start));
+        m_tokens[t].next = t + 1;
+        return true;
+    }
+};
+
+const JsonToken& JsonValue::tok() const { return m_doc->token(m_index); }
+
+int JsonValue::size() const
+{
+    return (isArray() || isObject()) ? tok().count : 0;
+}
+
+JsonValue JsonValue::operator[](std::string_view key) const
+{
+    if (!isObject()) return JsonValue();
+    int child = m_index + 1;
+    for (int i = 0; i < tok().count; i++) {
+        const JsonToken& k = m_doc->token(child);
+        if (!k.escaped && k.text == key) return JsonValue(m_doc, child + 1);
+        child = m_doc->token(child + 1).next;
+    }
+    return JsonValue();
+}
+
+JsonValue JsonValue::at(int i) const
+{
+    if (!isArray() || i < 0 || i >= tok().count) return JsonValue();
+    int child = m_index + 1;
+    while (i-- > 0) child = m_doc->token(child).next;
+    return JsonValue(m_doc, child);
+}
+
+template <typename F>
+void JsonValue::forEachMember(F&& f) const
+{
+    if (!isObject()) return;
+    int child = m_index + 1;
+    for (int i = 0; i < tok().count; i++) {
+        f(JsonValue(m_doc, child), JsonValue(m_doc, child + 1));
+        child = m_doc->token(child + 1).next;
+    }
+}
+
+template <typename F>
+void JsonValue::forEachElement(F&& f) const
+{
+    if (!isArray()) return;
+    int child = m_index + 1;
+    for (int i = 0; i < tok().count; i++) {
+        f(JsonValue(m_doc, child));
+        child = m_doc->token(child).next;
+    }
+}
+
+bool JsonValue::asBool(bool& out) const
+{
+    if (!isBool()) return false;
+    out = (tok().text[0] == 't');
+    return true;
+}
+
+bool JsonValue::asInt(int64_t& out) const
+{
+    if (!isNumber()) return false;
+    std::string_view t = tok().text;
+    auto r = std::from_chars(t.data(), t.data() + t.size(), out);
+    return r.ec == std::errc() && r.ptr == t.data() + t.size();
+}
+
+bool JsonValue::asUint(uint64_t& out) const
+{
+    if (!isNumber()) return false;
+    std::string_view t = tok().text;
+    auto r = std::from_chars(t.data(), t.data() + t.size(), out);
+    return r.ec == std::errc() && r.ptr == t.data() + t.size();
+}
+
+std::string_view JsonValue::rawString() const
+{
+    return isString() ? tok().text : std::string_view();
+}
+
+bool JsonValue::asString(std::string& out) const
+{
+    if (!isString()) return false;
+    std::string_view t = tok().text;
+    if (!tok().escaped) {
+        out.assign(t.data(), t.size());
+        return true;
+    }
+
+    // Escapes were validated by the tokenizer; decode them to UTF-8
+    auto hex4 = [](const char* p) {
+        uint32_t v = 0;
+        for (int i = 0; i < 4; i++) {
+            char c = p[i];
+            v = (v << 4) | (uint32_t)(c <= '9' ? c - '0' : (c | 0x20) - 'a' + 10);
+        }
+        return v;
+    };
+    out.clear();
+    out.reserve(t.size());
+    for (size_t i = 0; i < t.size(); i++) {
+        char c = t[i];
+        if (c != '\\') { out += c; continue; }
+        c = t[++i];
+        switch (c) {
+        case 'b': out += '\b'; break;
+        case 'f': out += '\f'; break;
+        case 'n': out += '\n'; break;
+        case 'r': out += '\r'; break;
+        case 't': out += '\t'; break;
+        case 'u': {
+            uint32_t cp = hex4(t.data() + i + 1);
+            i += 4;
+            if (cp >= 0xD800 && cp < 0xDC00 && i + 6 < t.size() && t[i + 1] == '\\' && t[i + 2] == 'u') {
+                uint32_t lo = hex4(t.data() + i + 3);
+                if (lo >= 0xDC00 && lo < 0xE000) {
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                    i += 6;
+                }
+            }
+            if (cp < 0x80) {
+                out += (char)cp;
+            } else if (cp < 0x800) {
+                out += (char)(0xC0 | (cp >> 6));
+                out += (char)(0x80 | (cp & 0x3F));
+            } else if (cp < 0x10000) {
+                out += (char)(0xE0 | (cp >> 12));
+                out += (char)(0x80 | ((cp >> 6) & 0x3F));
+                out += (char)(0x80 | (cp & 0x3F));
+            } else {
+                out += (char)(0xF0 | (cp >> 18));
+                out += (char)(0x80 | ((cp >> 12) & 0x3F));
+                out += (char)(0x80 | ((cp >> 6) & 0x3F));
+                out += (char)(0x80 | (cp & 0x3F));
+            }
+            break;
+        }
+        default: out += c; break;  // '"', '\\', '/'
+        }
+    }
+    return true;
 }
 
 // ---------------------------------------------------------------------------
@@ -328,85 +809,169 @@ struct CameraProperties {
     int heatState = 0; // 0=ok, 1=pre-overheat, 2=overheat
 };
 
+// Wakes the camera management thread; defined with the global state below
+static void notifyHealthChange();
+
+// Registered on first use; served by GET /metrics
+struct AppMetrics {
+    MetricCounter& connectAttempts = metrics().counter("fx30_connect_attempts_total", "Remote and ContentsTransfer connect attempts");
+    MetricCounter& connectFailures = metrics().counter("fx30_connect_failures_total", "Connect attempts that failed or were rejected");
+    // Indexed by CameraDevice::Health
+    MetricCounter* healthTransitions[4] = {
+        &metrics().counter("fx30_health_transitions_total", "Camera health state changes, by new state", "state=\"connected\""),
+        &metrics().counter("fx30_health_transitions_total", "Camera health state changes, by new state", "state=\"reconnecting\""),
+        &metrics().counter("fx30_health_transitions_total", "Camera health state changes, by new state", "state=\"lost\""),
+        &metrics().counter("fx30_health_transitions_total", "Camera health state changes, by new state", "state=\"recovering\""),
+    };
+    MetricCounter& propertyReadFailures = metrics().counter("fx30_property_read_failures_total", "Failed property batch reads");
+    MetricHistogram& downloadSeconds = metrics().histogram("fx30_download_file_seconds", "Time to pull one file in ContentsTransfer mode");
+    MetricCounter& downloadBytes = metrics().counter("fx30_download_bytes_total", "Bytes of files pulled from the cameras");
+    MetricCounter& downloadErrors = metrics().counter("fx30_download_errors_total", "Files that failed or timed out");
+    MetricGauge& camerasConnected = metrics().gauge("fx30_cameras_connected", "Cameras in the connected state");
+    MetricGauge& cameras = metrics().gauge("fx30_cameras", "Cameras known to the controller");
+    MetricGauge& callbackQueueDepth = metrics().gauge("fx30_callback_queue_depth", "SDK callback events waiting for the dispatcher");
+    MetricGauge& callbackQueueHighWater = metrics().gauge("fx30_callback_queue_high_water", "Deepest the callback queue has been");
+    MetricGauge& callbackEventsDropped = metrics().gauge("fx30_callback_events_dropped", "Callback events dropped because the queue was full");
+};
+
+static AppMetrics& appMetrics()
+{
+    static AppMetrics m;
+    return m;
+}
+
 class CameraDevice : public SCRSDK::IDeviceCallback
 {
 public:
+    // Connection health of one camera:
+    //   Connected    - usable
+    //   Reconnecting - the SDK reported CrWarning_Connect_Reconnecting and is retrying itself
+    //   Lost         - disconnected unexpectedly, or the SDK did not get it back in time
+    //   Recovering   - the management thread is reconnecting it with backoff
+    enum class Health { Connected, Reconnecting, Lost, Recovering };
+    // SDK control mode the camera is connected in. Health is only tracked in Remote mode.
+    enum class Mode { Remote, ContentsTransfer };
+
+    // Fields are read by API handlers under g_mutex, by the callback thread,
+    // and by workers holding m_opMutex:
+    //  - m_modelId is set before the camera is shared and never changes after
+    //  - m_device_handle and m_objInfo are only used or replaced under m_opMutex
+    //  - the rest are atomics, since callbacks update them without either lock
     int64_t  m_device_handle = 0;
-    bool     m_connected = false;
-    bool     m_reconnecting = false;
+    std::atomic<bool> m_connected{false};
     CrString m_modelId;
 
-    std::mutex m_eventPromiseMutex;
-    std::promise<void>* m_eventPromise = nullptr;
+    std::atomic<Health> m_health{Health::Connected};
+    std::atomic<int64_t> m_healthSince{0};  // steady_clock ticks of the last change
+    std::atomic<bool> m_closing{false};     // disconnect() in progress, not a loss
+    std::atomic<Mode> m_mode{Mode::Remote};
+    int m_recoveryAttempts = 0;             // owned by the recovery task
+    // Kept to reconnect the same body when it is lost
+    std::shared_ptr<const SCRSDK::ICrCameraObjectInfo> m_objInfo;
+
+    // Held while the SDK handle is used or replaced. Recovery holds it for the
+    // whole reconnect. Code that holds g_mutex only try-locks it and treats a
+    // busy camera as unavailable, so nothing waits for a camera under g_mutex.
+    std::mutex m_opMutex;
+
+    std::unique_lock<std::mutex> tryLockOps() { return std::unique_lock<std::mutex>(m_opMutex, std::try_to_lock); }
+
+    // Connects, disconnects, property changes and file pulls waiting for
+    // their callbacks; any number can be pending at once
+    AsyncOps m_ops;
+
+    // Handed to the SDK instead of this: callbacks are queued and run on the
+    // dispatcher thread, so the handlers below never hold up the SDK's thread
+    QueuedDeviceCallback m_callbacks{this};
 
-    // For contents transfer download completion
-    std::mutex m_downloadMutex;
-    std::promise<void>* m_downloadPromise = nullptr;
+    void setHealth(Health health)
+    {
+        m_healthSince = std::chrono::steady_clock::now().time_since_epoch().count();
+        if (m_health.exchange(health) != health) {
+            appMetrics().healthTransitions[(int)health]->inc();
+            notifyHealthChange();
+        }
+    }
+
+    // Move from one state to another unless a callback changed it meanwhile
+    bool transitionHealth(Health from, Health to)
+    {
+        if (!m_health.compare_exchange_strong(from, to)) return false;
+        m_healthSince = std::chrono::steady_clock::now().time_since_epoch().count();
+        appMetrics().healthTransitions[(int)to]->inc();
+        notifyHealthChange();
+        return true;
+    }
 
-    void setEventPromise(std::promise<void>* p)
+    std::chrono::steady_clock::duration healthAge() const
     {
-        std::lock_guard<std::mutex> lock(m_eventPromiseMutex);
-        m_eventPromise = p;
+        return std::chrono::steady_clock::now().time_since_epoch() - std::chrono::steady_clock::duration(m_healthSince.load());
     }
 
-    void setDownloadPromise(std::promise<void>* p)
+    static const char* healthName(Health health)
     {
-        std::lock_guard<std::mutex> lock(m_downloadMutex);
-        m_downloadPromise = p;
+        switch (health) {
+        case Health::Connected:    return "connected";
+        case Health::Reconnecting: return "reconnecting";
+        case Health::Lost:         return "lost";
+        case Health::Recovering:   return "recovering";
+        }
+        return "";
     }
 
     CameraDevice() {}
-    ~CameraDevice() {}
+    // Events already queued for this camera are handled before it goes away
+    ~CameraDevice() { CallbackDispatcher::instance().drain(); }
 
     // IDeviceCallback overrides
 
     void OnConnected(SCRSDK::DeviceConnectionVersioin version)
     {
         m_connected = true;
-        std::lock_guard<std::mutex> lock(m_eventPromiseMutex);
-        if (m_eventPromise) {
-            m_eventPromise->set_value();
-            m_eventPromise = nullptr;
-        }
+        setHealth(Health::Connected);
+        m_ops.complete(AsyncOps::Kind::Connect, AsyncOps::kAnyKey, true);
     }
 
     void OnDisconnected(CrInt32u error)
     {
         m_connected = false;
-        std::lock_guard<std::mutex> lock(m_eventPromiseMutex);
-        if (m_eventPromise) {
-            m_eventPromise->set_value();
-            m_eventPromise = nullptr;
+        // A failed recovery attempt also ends here; only a live camera becomes Lost
+        Health health = m_health;
+        if (!m_closing && m_mode == Mode::Remote && (health == Health::Connected || health == Health::Reconnecting)) {
+            setHealth(Health::Lost);
         }
+        m_ops.complete(AsyncOps::Kind::Disconnect, AsyncOps::kAnyKey, true, error);
+        m_ops.complete(AsyncOps::Kind::Connect, AsyncOps::kAnyKey, false, error);
+        m_ops.complete(AsyncOps::Kind::ContentsTransfer, AsyncOps::kAnyKey, false, error);
     }
 
     void OnError(CrInt32u error)
     {
-        std::cout << "  Error on " << std::string(m_modelId.begin(), m_modelId.end())
-                  << ": " << CrErrorString(error) << "\n";
-        std::lock_guard<std::mutex> lock(m_eventPromiseMutex);
-        if (m_eventPromise) {
-            m_eventPromise->set_exception(std::make_exception_ptr(std::runtime_error("connection error")));
-            m_eventPromise = nullptr;
-        }
+        logError("camera error").kv("camera", m_modelId).kv("error", CrErrorString(error));
+        m_ops.complete(AsyncOps::Kind::Connect, AsyncOps::kAnyKey, false, error);
+        m_ops.complete(AsyncOps::Kind::Disconnect, AsyncOps::kAnyKey, false, error);
     }
 
     void OnWarning(CrInt32u warning)
     {
         if (warning == SCRSDK::CrWarning_Connect_Reconnecting) {
-            CrCout << "  Reconnecting to " << m_modelId << "\n";
-            m_reconnecting = true;
+            logWarn("reconnecting").kv("camera", m_modelId);
+            if (m_health == Health::Connected && m_mode == Mode::Remote) setHealth(Health::Reconnecting);
+            return;
+        }
+        // The SDK restored the connection itself; recovery must leave it alone
+        if (warning == SCRSDK::CrWarning_Connect_Reconnected) {
+            logInfo("reconnected").kv("camera", m_modelId);
+            if (!transitionHealth(Health::Reconnecting, Health::Connected)) {
+                transitionHealth(Health::Recovering, Health::Connected);
+            }
             return;
         }
-        // ContentsTransfer warnings → fail the download promise
+        // ContentsTransfer warnings → fail every pending pull
         if (warning == SCRSDK::CrWarning_ContentsTransferMode_DeviceBusy ||
             warning == SCRSDK::CrWarning_ContentsTransferMode_StatusError ||
             warning == SCRSDK::CrWarning_ContentsTransferMode_CanceledFromCamera) {
-            std::lock_guard<std::mutex> lock(m_downloadMutex);
-            if (m_downloadPromise) {
-                m_downloadPromise->set_exception(std::make_exception_ptr(std::runtime_error("transfer warning")));
-                m_downloadPromise = nullptr;
-            }
+            m_ops.complete(AsyncOps::Kind::ContentsTransfer, AsyncOps::kAnyKey, false, warning);
         }
     }
 
@@ -414,25 +979,21 @@ public:
 
     void OnCompleteDownload(CrChar* filename, CrInt32u type)
     {
-        CrCout << "  Download complete: " << filename << "\n";
+        logInfo("download complete").kv("camera", m_modelId).kv("file", CrString(filename));
     }
 
     void OnNotifyContentsTransfer(CrInt32u notify, SCRSDK::CrContentHandle contentHandle, CrChar* filename)
     {
-        std::lock_guard<std::mutex> lock(m_downloadMutex);
         switch (notify) {
         case SCRSDK::CrNotify_ContentsTransfer_Start:
             break;
         case SCRSDK::CrNotify_ContentsTransfer_Complete:
-            if (m_downloadPromise) {
-                m_downloadPromise->set_value();
-                m_downloadPromise = nullptr;
-            }
+            m_ops.complete(AsyncOps::Kind::ContentsTransfer, contentHandle, true, notify);
             break;
         default:
-            if (m_downloadPromise) {
-                m_downloadPromise->set_exception(std::make_exception_ptr(std::runtime_error("transfer error")));
-                m_downloadPromise = nullptr;
+            // A failure that does not name a pending pull fails them all
+            if (m_ops.complete(AsyncOps::Kind::ContentsTransfer, contentHandle, false, notify) == 0) {
+                m_ops.complete(AsyncOps::Kind::ContentsTransfer, AsyncOps::kAnyKey, false, notify);
             }
             break;
         }
@@ -441,153 +1002,211 @@ public:
     void OnLvPropertyChanged() {}
     void OnLvPropertyChangedCodes(CrInt32u num, CrInt32u* codes) {}
     void OnPropertyChanged() {}
-    void OnPropertyChangedCodes(CrInt32u num, CrInt32u* codes) {}
+    void OnPropertyChangedCodes(CrInt32u num, CrInt32u* codes)
+    {
+        for (CrInt32u i = 0; i < num; i++) {
+            m_ops.complete(AsyncOps::Kind::PropertyChange, codes[i], true);
+        }
+    }
+
+    // One pending operation per code, in the same order. Register them before
+    // setting the properties so an early callback is not missed.
+    std::vector<AsyncOps::Op> expectPropertyChanges(const std::vector<uint32_t>& codes)
+    {
+        std::vector<AsyncOps::Op> ops;
+        ops.reserve(codes.size());
+        for (uint32_t code : codes) ops.push_back(m_ops.expect(AsyncOps::Kind::PropertyChange, code));
+        return ops;
+    }
 
     // Connect to a camera in Remote mode with retry logic
     bool connect(const SCRSDK::ICrCameraObjectInfo* objInfo, int maxRetries = 3)
     {
-        m_modelId = getModelId(objInfo);
+        // A reconnect keeps the id the camera is already known by
+        if (m_modelId.empty()) m_modelId = getModelId(objInfo);
 
         for (int attempt = 1; attempt <= maxRetries; attempt++) {
-            std::promise<void> eventPromise;
-            std::future<void> eventFuture = eventPromise.get_future();
-            setEventPromise(&eventPromise);
-
-            SCRSDK::CrError err = SCRSDK::Connect(
-                (SCRSDK::ICrCameraObjectInfo*)objInfo, this, &m_device_handle,
-                SCRSDK::CrSdkControlMode_Remote,
-                SCRSDK::CrReconnecting_ON);
+            AsyncOps::Op connected = m_ops.expect(AsyncOps::Kind::Connect);
+
+            static SdkCallMetrics& connectMetrics = sdkCallMetrics("Connect");
+            appMetrics().connectAttempts.inc();
+            SCRSDK::CrError err = timedSdkCall(connectMetrics, [&]() {
+                return SdkCall::Connect(
+                    (SCRSDK::ICrCameraObjectInfo*)objInfo, &m_callbacks, &m_device_handle,
+                    SCRSDK::CrSdkControlMode_Remote,
+                    SCRSDK::CrReconnecting_ON);
+            });
             if (err) {
-                CrCout << "  Attempt " << attempt << "/" << maxRetries
-                       << " failed for " << m_modelId << ": " << CrErrorString(err).c_str() << "\n";
-                setEventPromise(nullptr);
+                appMetrics().connectFailures.inc();
+                logWarn("connect failed").kv("camera", m_modelId).kv("attempt", attempt)
+                    .kv("max", maxRetries).kv("error", CrErrorString(err));
+                connected.cancel();
                 if (m_device_handle) {
-                    SCRSDK::ReleaseDevice(m_device_handle);
+                    SdkCall::ReleaseDevice(m_device_handle);
                     m_device_handle = 0;
                 }
                 if (attempt < maxRetries) {
 #if defined(__APPLE__)
-                    std::cout << "  Resetting USB connection...\n";
+                    logInfo("resetting USB").kv("camera", m_modelId);
                     resetUSBDevice(kSonyVendorId, kFX30ProductId);
                     std::this_thread::sleep_for(std::chrono::milliseconds(4000));
 #else
-                    std::cout << "  Retrying in 3 seconds...\n";
+                    logInfo("connect retry scheduled").kv("camera", m_modelId).kv("in_s", 3);
                     std::this_thread::sleep_for(std::chrono::milliseconds(3000));
 #endif
                 }
                 continue;
             }
 
-            try {
-                eventFuture.get();
-            } catch (const std::exception&) {
-                CrCout << "  Attempt " << attempt << "/" << maxRetries
-                       << " connection error for " << m_modelId << "\n";
+            if (!connected.wait().ok) {
+                appMetrics().connectFailures.inc();
+                logWarn("connection error").kv("camera", m_modelId).kv("attempt", attempt).kv("max", maxRetries);
                 if (m_device_handle) {
-                    SCRSDK::ReleaseDevice(m_device_handle);
+                    SdkCall::ReleaseDevice(m_device_handle);
                     m_device_handle = 0;
                 }
                 if (attempt < maxRetries) {
 #if defined(__APPLE__)
-                    std::cout << "  Resetting USB connection...\n";
+                    logInfo("resetting USB").kv("camera", m_modelId);
                     resetUSBDevice(kSonyVendorId, kFX30ProductId);
                     std::this_thread::sleep_for(std::chrono::milliseconds(4000));
 #else
-                    std::cout << "  Retrying in 3 seconds...\n";
+                    logInfo("connect retry scheduled").kv("camera", m_modelId).kv("in_s", 3);
                     std::this_thread::sleep_for(std::chrono::milliseconds(3000));
 #endif
                 }
                 continue;
             }
 
-            CrCout << "  Connected: " << m_modelId << "\n";
+            logInfo("connected").kv("camera", m_modelId).kv("mode", "remote");
             return true;
         }
 
-        CrCout << "  Failed to connect " << m_modelId << " after " << maxRetries << " attempts.\n";
+        logError("connect gave up").kv("camera", m_modelId).kv("attempts", maxRetries);
         return false;
     }
 
     // Connect in ContentsTransfer mode (for file download)
     bool connectContentsTransfer(const SCRSDK::ICrCameraObjectInfo* objInfo)
     {
-        m_modelId = getModelId(objInfo);
+        if (m_modelId.empty()) m_modelId = getModelId(objInfo);
 
-        std::promise<void> eventPromise;
-        std::future<void> eventFuture = eventPromise.get_future();
-        setEventPromise(&eventPromise);
+        AsyncOps::Op connected = m_ops.expect(AsyncOps::Kind::Connect);
 
-        SCRSDK::CrError err = SCRSDK::Connect(
-            (SCRSDK::ICrCameraObjectInfo*)objInfo, this, &m_device_handle,
-            SCRSDK::CrSdkControlMode_ContentsTransfer,
-            SCRSDK::CrReconnecting_ON);
+        static SdkCallMetrics& connectMetrics = sdkCallMetrics("Connect");
+        appMetrics().connectAttempts.inc();
+        SCRSDK::CrError err = timedSdkCall(connectMetrics, [&]() {
+            return SdkCall::Connect(
+                (SCRSDK::ICrCameraObjectInfo*)objInfo, &m_callbacks, &m_device_handle,
+                SCRSDK::CrSdkControlMode_ContentsTransfer,
+                SCRSDK::CrReconnecting_ON);
+        });
         if (err) {
-            CrCout << "  ContentsTransfer connect failed for " << m_modelId
-                   << ": " << CrErrorString(err).c_str() << "\n";
-            setEventPromise(nullptr);
+            appMetrics().connectFailures.inc();
+            logWarn("connect failed").kv("camera", m_modelId).kv("mode", "contents_transfer")
+                .kv("error", CrErrorString(err));
+            connected.cancel();
             if (m_device_handle) {
-                SCRSDK::ReleaseDevice(m_device_handle);
+                SdkCall::ReleaseDevice(m_device_handle);
                 m_device_handle = 0;
             }
             return false;
         }
 
-        try {
-            eventFuture.get();
-        } catch (const std::exception&) {
-            CrCout << "  ContentsTransfer connection error for " << m_modelId << "\n";
+        if (!connected.wait().ok) {
+            appMetrics().connectFailures.inc();
+            logWarn("connection error").kv("camera", m_modelId).kv("mode", "contents_transfer");
             if (m_device_handle) {
-                SCRSDK::ReleaseDevice(m_device_handle);
+                SdkCall::ReleaseDevice(m_device_handle);
                 m_device_handle = 0;
             }
             return false;
         }
 
-        CrCout << "  ContentsTransfer connected: " << m_modelId << "\n";
+        logInfo("connected").kv("camera", m_modelId).kv("mode", "contents_transfer");
         return true;
     }
 
+    bool isRemote() const { return m_connected && m_mode == Mode::Remote; }
+
+    bool contentsTransferOn()
+    {
+        uint32_t code = SCRSDK::CrDeviceProperty_ContentsTransferStatus;
+        SCRSDK::CrDeviceProperty* prop_list = nullptr;
+        std::int32_t nprop = 0;
+        SCRSDK::CrError err = SdkCall::GetSelectDeviceProperties(m_device_handle, 1, &code, &prop_list, &nprop);
+        if (err || !prop_list) return false;
+        bool on = nprop >= 1 && prop_list[0].GetCurrentValue() == SCRSDK::CrContentsTransfer_ON;
+        SdkCall::ReleaseDeviceProperties(m_device_handle, prop_list);
+        return on;
+    }
+
+    // Reconnect this camera in another control mode. Each step waits for its
+    // callback (OnDisconnected, OnConnected, then ContentsTransferStatus
+    // reported ON) instead of a fixed delay.
+    bool switchMode(Mode mode, const SCRSDK::ICrCameraObjectInfo* objInfo,
+                    std::chrono::milliseconds readyTimeout = std::chrono::milliseconds(10000))
+    {
+        if (!objInfo) return false;
+        disconnect();
+        m_mode = mode;
+        if (mode == Mode::Remote) return connect(objInfo, 1);
+
+        // Registered before connecting so an early status report is not missed
+        AsyncOps::Op ready = m_ops.expect(AsyncOps::Kind::PropertyChange, SCRSDK::CrDeviceProperty_ContentsTransferStatus);
+        if (!connectContentsTransfer(objInfo)) return false;
+        if (contentsTransferOn()) return true;
+        ready.waitFor(readyTimeout);
+        return contentsTransferOn();
+    }
+
     void disconnect()
     {
+        m_closing = true;
         if (m_connected) {
-            std::promise<void> eventPromise;
-            std::future<void> eventFuture = eventPromise.get_future();
-            setEventPromise(&eventPromise);
-            SCRSDK::Disconnect(m_device_handle);
-            eventFuture.wait_for(std::chrono::milliseconds(3000));
+            AsyncOps::Op disconnected = m_ops.expect(AsyncOps::Kind::Disconnect);
+            SdkCall::Disconnect(m_device_handle);
+            disconnected.waitFor(std::chrono::milliseconds(3000));
             m_connected = false;
         }
         if (m_device_handle) {
-            SCRSDK::ReleaseDevice(m_device_handle);
+            SdkCall::ReleaseDevice(m_device_handle);
             m_device_handle = 0;
         }
+        m_closing = false;
     }
 
     bool startRecording()
     {
-        if (!m_connected) return false;
-        SCRSDK::CrError err = SCRSDK::SendCommand(
-            m_device_handle,
-            SCRSDK::CrCommandId_MovieRecord,
-            SCRSDK::CrCommandParam_Down);
+        if (!isRemote()) return false;
+        static SdkCallMetrics& sendMetrics = sdkCallMetrics("SendCommand");
+        SCRSDK::CrError err = timedSdkCall(sendMetrics, [&]() {
+            return SdkCall::SendCommand(
+                m_device_handle,
+                SCRSDK::CrCommandId_MovieRecord,
+                SCRSDK::CrCommandParam_Down);
+        });
         return err == SCRSDK::CrError_None;
     }
 
     bool stopRecording()
     {
-        if (!m_connected) return false;
-        SCRSDK::CrError err = SCRSDK::SendCommand(
-            m_device_handle,
-            SCRSDK::CrCommandId_MovieRecord,
-            SCRSDK::CrCommandParam_Up);
+        if (!isRemote()) return false;
+        static SdkCallMetrics& sendMetrics = sdkCallMetrics("SendCommand");
+        SCRSDK::CrError err = timedSdkCall(sendMetrics, [&]() {
+            return SdkCall::SendCommand(
+                m_device_handle,
+                SCRSDK::CrCommandId_MovieRecord,
+                SCRSDK::CrCommandParam_Up);
+        });
         return err == SCRSDK::CrError_None;
     }
 
     // Format media slot 1 (quick format)
     bool formatSlot1()
     {
-        if (!m_connected) return false;
-        SCRSDK::CrError err = SCRSDK::ExecuteControlCodeValue(
+        if (!isRemote()) return false;
+        SCRSDK::CrError err = SdkCall::ExecuteControlCodeValue(
             m_device_handle,
             SCRSDK::CrControlCode_SelectedMediaFormat,
             SCRSDK::CrMediaFormat_QuickFormatSlot1);
@@ -597,8 +1216,8 @@ public:
     // Format media slot 2 (quick format)
     bool formatSlot2()
     {
-        if (!m_connected) return false;
-        SCRSDK::CrError err = SCRSDK::ExecuteControlCodeValue(
+        if (!isRemote()) return false;
+        SCRSDK::CrError err = SdkCall::ExecuteControlCodeValue(
             m_device_handle,
             SCRSDK::CrControlCode_SelectedMediaFormat,
             SCRSDK::CrMediaFormat_QuickFormatSlot2);
@@ -609,7 +1228,7 @@ public:
     CameraProperties getProperties()
     {
         CameraProperties props;
-        if (!m_connected) return props;
+        if (!isRemote()) return props;
 
         uint32_t codes[] = {
             SCRSDK::CrDeviceProperty_BatteryRemain,
@@ -632,9 +1251,14 @@ public:
         SCRSDK::CrDeviceProperty* prop_list = nullptr;
         std::int32_t nprop = 0;
 
-        SCRSDK::CrError err = SCRSDK::GetSelectDeviceProperties(
-            m_device_handle, numCodes, codes, &prop_list, &nprop);
-        if (err || !prop_list || nprop < 1) return props;
+        static SdkCallMetrics& getMetrics = sdkCallMetrics("GetSelectDeviceProperties");
+        SCRSDK::CrError err = timedSdkCall(getMetrics, [&]() {
+            return SdkCall::GetSelectDeviceProperties(m_device_handle, numCodes, codes, &prop_list, &nprop);
+        });
+        if (err || !prop_list || nprop < 1) {
+            appMetrics().propertyReadFailures.inc();
+            return props;
+        }
 
         for (int32_t i = 0; i < nprop; i++) {
             uint32_t code = prop_list[i].GetCode();
@@ -689,9 +1313,29 @@ public:
             }
         }
 
-        SCRSDK::ReleaseDeviceProperties(m_device_handle, prop_list);
+        SdkCall::ReleaseDeviceProperties(m_device_handle, prop_list);
         return props;
     }
+
+    // Reads RecordingState alone; false if it could not be read
+    bool readRecording(bool& recording)
+    {
+        if (!isRemote()) return false;
+        uint32_t code = SCRSDK::CrDeviceProperty_RecordingState;
+        SCRSDK::CrDeviceProperty* prop_list = nullptr;
+        std::int32_t nprop = 0;
+        static SdkCallMetrics& getMetrics = sdkCallMetrics("GetSelectDeviceProperties");
+        SCRSDK::CrError err = timedSdkCall(getMetrics, [&]() {
+            return SdkCall::GetSelectDeviceProperties(m_device_handle, 1, &code, &prop_list, &nprop);
+        });
+        if (err || !prop_list || nprop < 1) {
+            appMetrics().propertyReadFailures.inc();
+            return false;
+        }
+        recording = prop_list[0].GetCurrentValue() == SCRSDK::CrMovie_Recording_State_Recording;
+        SdkCall::ReleaseDeviceProperties(m_device_handle, prop_list);
+        return true;
+    }
 };
 
 // ---------------------------------------------------------------------------
@@ -699,14 +1343,39 @@ public:
 // ---------------------------------------------------------------------------
 
 static std::mutex g_mutex;
-static std::vector<std::unique_ptr<CameraDevice>> g_cameras;
+// shared_ptr so background connect/preset tasks can keep a camera alive past a reset
+static std::vector<std::shared_ptr<CameraDevice>> g_cameras;
 static std::string g_downloadPath = "/tmp/fx30_downloads";
-static std::atomic<bool> g_downloading{false};
 static std::string g_downloadStatus;
-static std::atomic<bool> g_scanning{false};
+static std::atomic<uint32_t> g_verifiedFiles{0};
+static std::atomic<uint32_t> g_unverifiedFiles{0}; // downloaded but not (yet) verified
+static std::mutex g_scanStatusMutex;    // g_scanStatus is written by several connect workers
 static std::string g_scanStatus;
+// Bumped whenever all cameras are torn down; connect retries from older scans give up
+static std::atomic<uint64_t> g_connectGeneration{0};
+// Model IDs with a connection attempt queued or running, with the generation
+// that queued them; entries from older generations are stale (guarded by g_mutex)
+struct ConnectingId {
+    CrString id;
+    uint64_t generation;
+};
+static std::vector<ConnectingId> g_connectingIds;
 static std::atomic<bool> g_running{true};
+// Signalled by camera health changes and shutdown
+static std::mutex g_healthMutex;
+static std::condition_variable g_healthCond;
+static bool g_healthChanged = false;
 static std::string g_presetPath = "fx30_preset.json";
+static std::string g_registryPath = "fx30_cameras.json";
+
+static void notifyHealthChange()
+{
+    {
+        std::lock_guard<std::mutex> lock(g_healthMutex);
+        g_healthChanged = true;
+    }
+    g_healthCond.notify_one();
+}
 
 // ---------------------------------------------------------------------------
 // Settings Preset (save/restore camera properties)
@@ -725,19 +1394,28 @@ static const uint32_t kPresetCodes[] = {
 };
 static const size_t kPresetCodeCount = sizeof(kPresetCodes) / sizeof(kPresetCodes[0]);
 
+// Preset file keys; a static table so name lookups need no allocation
+struct PresetCodeName {
+    uint32_t code;
+    const char* name;
+};
+static const PresetCodeName kPresetNames[] = {
+    { SCRSDK::CrDeviceProperty_IsoSensitivity,                   "iso" },
+    { SCRSDK::CrDeviceProperty_ShutterSpeed,                     "shutterSpeed" },
+    { SCRSDK::CrDeviceProperty_FNumber,                          "fNumber" },
+    { SCRSDK::CrDeviceProperty_WhiteBalance,                     "whiteBalance" },
+    { SCRSDK::CrDeviceProperty_Colortemp,                        "colorTemp" },
+    { SCRSDK::CrDeviceProperty_Movie_File_Format,                "movieFormat" },
+    { SCRSDK::CrDeviceProperty_Movie_Recording_Setting,          "recSetting" },
+    { SCRSDK::CrDeviceProperty_Movie_Recording_FrameRateSetting, "frameRate" },
+};
+
 static std::string presetCodeName(uint32_t code)
 {
-    switch (code) {
-    case SCRSDK::CrDeviceProperty_IsoSensitivity:                return "iso";
-    case SCRSDK::CrDeviceProperty_ShutterSpeed:                  return "shutterSpeed";
-    case SCRSDK::CrDeviceProperty_FNumber:                       return "fNumber";
-    case SCRSDK::CrDeviceProperty_WhiteBalance:                  return "whiteBalance";
-    case SCRSDK::CrDeviceProperty_Colortemp:                     return "colorTemp";
-    case SCRSDK::CrDeviceProperty_Movie_File_Format:             return "movieFormat";
-    case SCRSDK::CrDeviceProperty_Movie_Recording_Setting:       return "recSetting";
-    case SCRSDK::CrDeviceProperty_Movie_Recording_FrameRateSetting: return "frameRate";
-    default: return "unknown_" + std::to_string(code);
+    for (const auto& p : kPresetNames) {
+        if (p.code == code) return p.name;
     }
+    return "unknown_" + std::to_string(code);
 }
 
 struct PresetEntry {
@@ -748,14 +1426,14 @@ struct PresetEntry {
 // Save current camera properties to JSON file
 static bool savePreset(CameraDevice& cam, const std::string& path)
 {
-    if (!cam.m_connected) return false;
+    if (!cam.isRemote()) return false;
 
     SCRSDK::CrDeviceProperty* prop_list = nullptr;
     std::int32_t nprop = 0;
     uint32_t codes[kPresetCodeCount];
     for (size_t i = 0; i < kPresetCodeCount; i++) codes[i] = kPresetCodes[i];
 
-    SCRSDK::CrError err = SCRSDK::GetSelectDeviceProperties(
+    SCRSDK::CrError err = SdkCall::GetSelectDeviceProperties(
         cam.m_device_handle, (uint32_t)kPresetCodeCount, codes, &prop_list, &nprop);
     if (err || !prop_list || nprop < 1) return false;
 
@@ -771,7 +1449,7 @@ static bool savePreset(CameraDevice& cam, const std::string& path)
     }
     js << "\n}\n";
 
-    SCRSDK::ReleaseDeviceProperties(cam.m_device_handle, prop_list);
+    SdkCall::ReleaseDeviceProperties(cam.m_device_handle, prop_list);
 
     std::ofstream f(path);
     if (!f.is_open()) return false;
@@ -781,6 +1459,54 @@ static bool savePreset(CameraDevice& cam, const std::string& path)
     return true;
 }
 
+// Resolve a property key from a preset file or API request: either one of the
+// preset names above ("iso", "fNumber", ...) or an SDK property name ("IsoSensitivity").
+static bool propertyCodeFromName(std::string_view name, uint32_t& code)
+{
+    for (const auto& p : kPresetNames) {
+        if (name == p.name) {
+            code = p.code;
+            return true;
+        }
+    }
+    CrInt32 sdkCode = CrDevicePropertyCode(name);
+    if (sdkCode <= 0) return false;
+    code = (uint32_t)sdkCode;
+    return true;
+}
+
+// Decode a {"name": value, ...} object into preset entries. With skipUnknown,
+// names this build does not know (a preset saved by a newer build) are
+// reported and left out instead of failing the whole object.
+static bool decodePropertyMap(JsonValue obj, std::vector<PresetEntry>& entries, std::string& error,
+                              bool skipUnknown = false)
+{
+    if (!obj.isObject()) {
+        error = "expected an object of property values";
+        return false;
+    }
+    bool ok = true;
+    obj.forEachMember([&](JsonValue key, JsonValue value) {
+        if (!ok) return;
+        std::string_view name = key.rawString();
+        PresetEntry entry;
+        if (!propertyCodeFromName(name, entry.code)) {
+            if (skipUnknown) {
+                std::cout << "  Skipping unknown preset key: " << name << "\n";
+                return;
+            }
+            error = "unknown property: " + std::string(name);
+            ok = false;
+        } else if (!value.asUint(entry.value)) {
+            error = "property value must be a non-negative integer: " + std::string(name);
+            ok = false;
+        } else {
+            entries.push_back(entry);
+        }
+    });
+    return ok;
+}
+
 // Load preset from JSON file, returns entries
 static std::vector<PresetEntry> loadPreset(const std::string& path)
 {
@@ -791,433 +1517,1082 @@ static std::vector<PresetEntry> loadPreset(const std::string& path)
     std::string content((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
     f.close();
 
-    // Simple parser: find "key": value pairs
-    for (size_t i = 0; i < kPresetCodeCount; i++) {
-        std::string key = "\"" + presetCodeName(kPresetCodes[i]) + "\"";
-        auto pos = content.find(key);
-        if (pos == std::string::npos) continue;
-        pos = content.find(':', pos + key.size());
-        if (pos == std::string::npos) continue;
-        pos++;
-        while (pos < content.size() && (content[pos] == ' ' || content[pos] == '\t')) pos++;
-        uint64_t val = std::strtoull(content.c_str() + pos, nullptr, 10);
-        entries.push_back({kPresetCodes[i], val});
+    JsonDocument doc;
+    std::string error;
+    if (!doc.parse(content)) {
+        std::cout << "Invalid preset " << path << ": " << doc.error() << "\n";
+    } else if (!decodePropertyMap(doc.root(), entries, error, true)) {
+        std::cout << "Invalid preset " << path << ": " << error << "\n";
+        entries.clear();
     }
-
     return entries;
 }
 
-// Apply preset to a camera: read current values, set any that differ
+// How long to wait for the camera to report a batch of sets as applied
+static const std::chrono::milliseconds kPresetConfirmTimeout(3000);
+// A second pass re-reads and re-sets anything the camera did not take on the
+// first one, e.g. a recording setting that depends on the file format set in
+// the same batch.
+static const int kPresetPasses = 2;
+
+// Apply preset to a camera: read all target properties in one call, set only
+// those that differ without waiting in between, then wait for the camera to
+// confirm them through OnPropertyChangedCodes.
 static int applyPreset(CameraDevice& cam, const std::vector<PresetEntry>& entries)
 {
-    if (!cam.m_connected || entries.empty()) return 0;
+    if (!cam.isRemote() || entries.empty()) return 0;
+
+    std::string camName(cam.m_modelId.begin(), cam.m_modelId.end());
+    std::vector<PresetEntry> pending = entries;
+    std::vector<uint32_t> appliedCodes;
+
+    for (int pass = 0; pass < kPresetPasses && !pending.empty(); pass++) {
+        std::vector<uint32_t> codes;
+        for (const auto& entry : pending) codes.push_back(entry.code);
 
-    int applied = 0;
-    for (const auto& entry : entries) {
-        // Read current value
-        uint32_t code = entry.code;
         SCRSDK::CrDeviceProperty* prop_list = nullptr;
         std::int32_t nprop = 0;
-        SCRSDK::CrError err = SCRSDK::GetSelectDeviceProperties(
-            cam.m_device_handle, 1, &code, &prop_list, &nprop);
-        if (err || !prop_list || nprop < 1) continue;
+        SCRSDK::CrError err = SdkCall::GetSelectDeviceProperties(
+            cam.m_device_handle, (uint32_t)codes.size(), codes.data(), &prop_list, &nprop);
+        if (err || !prop_list || nprop < 1) break;
+
+        // Diff against the preset
+        std::vector<SCRSDK::CrDeviceProperty> changes;
+        std::vector<uint32_t> changedCodes;
+        for (int32_t i = 0; i < nprop; i++) {
+            uint32_t code = prop_list[i].GetCode();
+            for (const auto& entry : pending) {
+                if (entry.code != code) continue;
+                uint64_t current = prop_list[i].GetCurrentValue();
+                if (current != entry.value) {
+                    std::cout << "  " << camName << ": setting " << presetCodeName(code)
+                              << ": " << current << " -> " << entry.value << "\n";
+                    SCRSDK::CrDeviceProperty devProp = prop_list[i];
+                    devProp.SetCurrentValue(entry.value);
+                    changes.push_back(devProp);
+                    changedCodes.push_back(code);
+                }
+                break;
+            }
+        }
+        SdkCall::ReleaseDeviceProperties(cam.m_device_handle, prop_list);
 
-        SCRSDK::CrDeviceProperty devProp = prop_list[0];
-        uint64_t current = devProp.GetCurrentValue();
-        SCRSDK::ReleaseDeviceProperties(cam.m_device_handle, prop_list);
+        if (changes.empty()) break;
 
-        if (current == entry.value) continue;
+        // Issue all sets back to back
+        std::vector<AsyncOps::Op> confirmations = cam.expectPropertyChanges(changedCodes);
+        int sent = 0;
+        for (size_t i = 0; i < changes.size(); i++) {
+            SCRSDK::CrDeviceProperty& devProp = changes[i];
+            uint32_t code = devProp.GetCode();
+            err = SdkCall::SetDeviceProperty(cam.m_device_handle, &devProp);
+            if (err) {
+                std::cout << "  " << camName << ": failed to set " << presetCodeName(code)
+                          << ": " << CrErrorString(err) << "\n";
+                confirmations[i].cancel();
+                continue;
+            }
+            sent++;
+            if (std::find(appliedCodes.begin(), appliedCodes.end(), code) == appliedCodes.end()) {
+                appliedCodes.push_back(code);
+            }
+        }
 
-        // Value differs — set it
-        std::string name = presetCodeName(code);
-        std::cout << "  Setting " << name << ": " << current << " -> " << entry.value << "\n";
+        if (sent > 0 && !AsyncOps::waitAll(confirmations, kPresetConfirmTimeout)) {
+            std::cout << "  " << camName << ": not all settings confirmed within "
+                      << kPresetConfirmTimeout.count() << " ms\n";
+        }
 
-        devProp.SetCurrentValue(entry.value);
-        err = SCRSDK::SetDeviceProperty(cam.m_device_handle, &devProp);
-        if (err) {
-            std::cout << "  Failed to set " << name << ": " << CrErrorString(err) << "\n";
-        } else {
-            applied++;
-            std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        // Only what was changed this pass needs another look
+        std::vector<PresetEntry> next;
+        for (const auto& entry : pending) {
+            if (std::find(changedCodes.begin(), changedCodes.end(), entry.code) != changedCodes.end()) {
+                next.push_back(entry);
+            }
         }
+        pending.swap(next);
     }
 
+    return (int)appliedCodes.size();
+}
+
+// Apply a preset to several cameras concurrently. Returns the per-camera
+// number of settings applied, in the order of `cams`. The caller holds each
+// camera's operation lock.
+static std::vector<int> applyPresetParallel(const std::vector<CameraDevice*>& cams,
+                                            const std::vector<PresetEntry>& entries)
+{
+    std::vector<std::future<int>> jobs;
+    for (CameraDevice* cam : cams) {
+        jobs.push_back(std::async(std::launch::async, [cam, &entries]() {
+            return applyPreset(*cam, entries);
+        }));
+    }
+    std::vector<int> applied;
+    for (auto& job : jobs) applied.push_back(job.get());
     return applied;
 }
 
 // ---------------------------------------------------------------------------
-// Scan and Connect
+// Connection Workers
 // ---------------------------------------------------------------------------
 
-// Must be called with g_mutex held. Sets g_scanning/g_scanStatus for UI feedback.
-static void scanAndConnect(bool usbReset = false)
+// Bounded pool of workers for camera connection work. Tasks carry a
+// not-before time, so a camera waiting out its retry backoff does not hold a
+// worker thread.
+class ConnectQueue
 {
-    g_scanning = true;
+public:
+    using Clock = std::chrono::steady_clock;
 
-#if defined(__APPLE__)
-    if (usbReset) {
-        g_scanStatus = "Resetting USB devices...";
-        std::cout << "Resetting USB...\n";
-        resetUSBDevice(kSonyVendorId, kFX30ProductId);
-        g_scanStatus = "Waiting for USB re-enumeration...";
-        std::this_thread::sleep_for(std::chrono::milliseconds(6000));
+    void start(size_t workers)
+    {
+        m_stop = false;
+        for (size_t i = 0; i < workers; i++) {
+            m_workers.emplace_back([this, i]() {
+                SdkTrace::setThreadName("connect-" + std::to_string(i));
+                run();
+            });
+        }
     }
-#endif
 
-    SCRSDK::ICrEnumCameraObjectInfo* enumInfo = nullptr;
-    g_scanStatus = "Enumerating cameras...";
-    std::cout << "Scanning for cameras (3 seconds)...\n";
+    // Drops queued tasks and waits for running ones to finish
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+            m_tasks.clear();
+        }
+        m_cond.notify_all();
+        for (auto& t : m_workers) {
+            if (t.joinable()) t.join();
+        }
+        m_workers.clear();
+    }
 
-    SCRSDK::CrError err = SCRSDK::EnumCameraObjects(&enumInfo, 3);
-    if (err || !enumInfo) {
-        std::cout << "No cameras found.\n";
-        g_scanStatus = "No cameras found.";
-        g_scanning = false;
-        return;
+    // Returns false, without queuing, once the queue has been stopped
+    bool push(std::function<void()> fn, Clock::time_point notBefore = Clock::now())
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_stop) return false;
+            m_tasks.push_back({ notBefore, std::move(fn) });
+        }
+        m_cond.notify_one();
+        return true;
     }
 
-    uint32_t count = enumInfo->GetCount();
-    uint32_t fx30Found = 0;
-    uint32_t fx30Total = 0;
+private:
+    struct Task {
+        Clock::time_point notBefore;
+        std::function<void()> fn;
+    };
+
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::deque<Task> m_tasks;
+    std::vector<std::thread> m_workers;
+    bool m_stop = false;
 
-    // First pass: count FX30 cameras
-    for (uint32_t i = 0; i < count; i++) {
-        if (isFX30Camera(enumInfo->GetCameraObjectInfo(i))) fx30Total++;
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (!m_stop) {
+            if (m_tasks.empty()) {
+                m_cond.wait(lock);
+                continue;
+            }
+            auto next = std::min_element(m_tasks.begin(), m_tasks.end(),
+                [](const Task& a, const Task& b) { return a.notBefore < b.notBefore; });
+            if (next->notBefore > Clock::now()) {
+                m_cond.wait_until(lock, next->notBefore);
+                continue;
+            }
+            std::function<void()> fn = std::move(next->fn);
+            m_tasks.erase(next);
+            lock.unlock();
+            fn();
+            lock.lock();
+        }
     }
+};
 
-    uint32_t fx30Attempted = 0;
-    for (uint32_t i = 0; i < count; i++) {
-        auto* objInfo = enumInfo->GetCameraObjectInfo(i);
-        CrString model = objInfo->GetModel();
+static const size_t kMaxParallelConnects = 4;
+static ConnectQueue g_connectQueue;
 
-        if (!isFX30Camera(objInfo)) {
-            CrCout << "  Skipping non-FX30: " << model << "\n";
-            continue;
-        }
+// Scans, downloads, preset and format runs started from the API. One worker
+// per queue; a queue holds at most two pending jobs (one for format).
+static JobExecutor g_jobs;
+static const size_t kScanJobs = g_jobs.addQueue("scan", 1, 2);
+static const size_t kDownloadJobs = g_jobs.addQueue("download", 1, 2);
+static const size_t kPresetJobs = g_jobs.addQueue("preset", 1, 2);
+static const size_t kFormatJobs = g_jobs.addQueue("format", 1, 1);
+
+static void setScanStatus(const std::string& status)
+{
+    std::lock_guard<std::mutex> lock(g_scanStatusMutex);
+    g_scanStatus = status;
+}
 
-        fx30Attempted++;
-        std::string modelStr(model.begin(), model.end());
+static std::string getScanStatus()
+{
+    std::lock_guard<std::mutex> lock(g_scanStatusMutex);
+    return g_scanStatus;
+}
 
-        // Check if already connected
-        CrString id = getModelId(objInfo);
-        bool alreadyConnected = false;
-        for (auto& cam : g_cameras) {
-            if (cam->m_modelId == id && cam->m_connected) {
-                alreadyConnected = true;
-                break;
-            }
+// Disconnect and drop every camera. Connection retries still pending from
+// earlier scans see the generation change and give up.
+// Must be called WITHOUT g_mutex held: it waits for each camera's current operation.
+static void disconnectAllCameras()
+{
+    std::vector<std::shared_ptr<CameraDevice>> cameras;
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        g_connectGeneration++;
+        g_connectingIds.clear();
+        cameras.swap(g_cameras);
+    }
+    for (auto& cam : cameras) {
+        std::lock_guard<std::mutex> op(cam->m_opMutex);
+        cam->disconnect();
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Camera Registry
+// ---------------------------------------------------------------------------
+
+// Every FX30 that connected once is remembered in g_registryPath, so a fixed
+// rig can be connected straight away with CreateCameraObjectInfo*Connection
+// instead of waiting for a 3 s enumeration first.
+struct RegisteredCamera {
+    std::string id;          // getModelId() form, e.g. "ILME-FX30 (D10F...)"
+    bool ethernet = false;
+    std::string usbSerial;
+    uint32_t ipAddress = 0;  // as returned by GetIPAddress()
+    std::string macAddress;  // "aa:bb:cc:dd:ee:ff"
+    uint32_t sshSupport = 0;
+
+    bool operator==(const RegisteredCamera& o) const
+    {
+        return id == o.id && ethernet == o.ethernet && usbSerial == o.usbSerial &&
+            ipAddress == o.ipAddress && macAddress == o.macAddress && sshSupport == o.sshSupport;
+    }
+};
+
+static std::mutex g_registryMutex;
+static std::vector<RegisteredCamera> g_registry;
+
+static void loadRegistry()
+{
+    std::ifstream f(g_registryPath);
+    if (!f.is_open()) return;
+    std::string content((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+    f.close();
+
+    JsonDocument doc;
+    if (!doc.parse(content) || !doc.root()["cameras"].isArray()) {
+        std::cout << "Invalid camera registry " << g_registryPath << ": " << doc.error() << "\n";
+        return;
+    }
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    g_registry.clear();
+    doc.root()["cameras"].forEachElement([](JsonValue v) {
+        RegisteredCamera reg;
+        std::string connection;
+        uint64_t n = 0;
+        if (!v["id"].asString(reg.id) || !v["connection"].asString(connection)) return;
+        reg.ethernet = (connection == "ip");
+        if (reg.ethernet) {
+            if (!v["ipAddress"].asUint(n) || !v["macAddress"].asString(reg.macAddress)) return;
+            reg.ipAddress = (uint32_t)n;
+            if (v["sshSupport"].asUint(n)) reg.sshSupport = (uint32_t)n;
+        } else if (!v["usbSerial"].asString(reg.usbSerial)) {
+            return;
         }
-        if (alreadyConnected) {
-            CrCout << "  Already connected: " << id << "\n";
-            g_scanStatus = "Already connected: " + modelStr +
-                " (" + std::to_string(fx30Attempted) + "/" + std::to_string(fx30Total) + ")";
-            continue;
+        g_registry.push_back(reg);
+    });
+    std::cout << g_registry.size() << " registered camera(s) in " << g_registryPath << "\n";
+}
+
+// Must be called with g_registryMutex held
+static void saveRegistryLocked()
+{
+    JsonWriter w;
+    w.beginObject().key("cameras").beginArray();
+    for (const auto& reg : g_registry) {
+        w.beginObject().kv("id", reg.id).kv("connection", reg.ethernet ? "ip" : "usb");
+        if (reg.ethernet) {
+            w.kv("ipAddress", reg.ipAddress).kv("macAddress", reg.macAddress).kv("sshSupport", reg.sshSupport);
+        } else {
+            w.kv("usbSerial", reg.usbSerial);
         }
+        w.endObject();
+    }
+    w.endArray().endObject();
 
-        g_scanStatus = "Connecting to " + modelStr +
-            " (" + std::to_string(fx30Attempted) + "/" + std::to_string(fx30Total) + ")...";
+    // Write aside and rename so a crash never leaves a half-written registry
+    std::string temp = g_registryPath + ".tmp";
+    {
+        std::ofstream f(temp, std::ios::out | std::ios::trunc);
+        if (!f.is_open()) return;
+        f.write(w.data(), (std::streamsize)w.size());
+        f << "\n";
+        if (!f) return;
+    }
+    std::error_code ec;
+    fs::rename(temp, g_registryPath, ec);
+}
 
-        auto cam = std::make_unique<CameraDevice>();
-        if (cam->connect(objInfo)) {
-            g_cameras.push_back(std::move(cam));
-            fx30Found++;
+// Record how an enumerated camera was reached
+static void registerCamera(const SCRSDK::ICrCameraObjectInfo* objInfo)
+{
+    RegisteredCamera reg;
+    CrString id = getModelId(objInfo);
+    reg.id = std::string(id.begin(), id.end());
+    reg.ethernet = CrString(objInfo->GetConnectionTypeName()) == CRSTR("IP");
+    if (reg.ethernet) {
+        reg.ipAddress = objInfo->GetIPAddress();
+        const CrInt8u* mac = objInfo->GetMACAddress();
+        char buf[24] = {};
+        if (mac && objInfo->GetMACAddressSize() >= 6) {
+            snprintf(buf, sizeof(buf), "%02x:%02x:%02x:%02x:%02x:%02x", mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
         }
+        reg.macAddress = buf;
+        reg.sshSupport = objInfo->GetSSHsupport();
+    } else {
+        CrString serial((CrChar*)objInfo->GetId());
+        reg.usbSerial = std::string(serial.begin(), serial.end());
     }
 
-    enumInfo->Release();
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    for (auto& known : g_registry) {
+        if (known.id != reg.id) continue;
+        if (known == reg) return;
+        known = reg;
+        saveRegistryLocked();
+        return;
+    }
+    g_registry.push_back(reg);
+    saveRegistryLocked();
+    std::cout << "  Registered " << reg.id << " in " << g_registryPath << "\n";
+}
 
-    if (fx30Found == 0) {
-        std::cout << "No new FX30 cameras found.\n";
-        g_scanStatus = "Scan complete. No new cameras found.";
+// Build a camera object without enumeration. The caller owns the result.
+static SCRSDK::ICrCameraObjectInfo* createRegisteredObjectInfo(const RegisteredCamera& reg)
+{
+    SCRSDK::ICrCameraObjectInfo* objInfo = nullptr;
+    SCRSDK::CrError err;
+    if (reg.ethernet) {
+        CrInt8u mac[6] = {};
+        unsigned int b[6] = {};
+        if (sscanf(reg.macAddress.c_str(), "%x:%x:%x:%x:%x:%x", &b[0], &b[1], &b[2], &b[3], &b[4], &b[5]) == 6) {
+            for (int i = 0; i < 6; i++) mac[i] = (CrInt8u)b[i];
+        }
+        err = SdkCall::CreateCameraObjectInfoEthernetConnection(&objInfo, SCRSDK::CrCameraDeviceModel_ILME_FX30,
+            reg.ipAddress, mac, reg.sshSupport);
     } else {
-        std::cout << fx30Found << " FX30 camera(s) connected. Total: " << g_cameras.size() << "\n";
-        g_scanStatus = "Scan complete. " + std::to_string(fx30Found) + " new camera(s), " +
-            std::to_string(g_cameras.size()) + " total.";
-        std::this_thread::sleep_for(std::chrono::milliseconds(1500));
-
-        // Apply preset if file exists
-        auto preset = loadPreset(g_presetPath);
-        if (!preset.empty()) {
-            g_scanStatus = "Applying preset...";
-            std::cout << "Applying preset from " << g_presetPath << "...\n";
-            for (auto& cam : g_cameras) {
-                if (!cam->m_connected) continue;
-                std::string name(cam->m_modelId.begin(), cam->m_modelId.end());
-                g_scanStatus = "Applying preset to " + name + "...";
-                int n = applyPreset(*cam, preset);
-                std::cout << "  " << name << ": " << n << " setting(s) applied.\n";
-            }
-            g_scanStatus = "Preset applied. " + std::to_string(g_cameras.size()) + " camera(s) ready.";
+        CrString serial(reg.usbSerial.begin(), reg.usbSerial.end());
+        err = SdkCall::CreateCameraObjectInfoUSBConnection(&objInfo, SCRSDK::CrCameraDeviceModel_ILME_FX30,
+            (CrInt8u*)serial.c_str());
+    }
+    if (err || !objInfo) {
+        std::cout << "  Cannot create camera object for " << reg.id << ": " << CrErrorString(err) << "\n";
+        return nullptr;
+    }
+    return objInfo;
+}
+
+// Object info to reconnect a known camera with. A re-plugged USB camera needs
+// a fresh object, so the registry entry wins over the one it connected with.
+static std::shared_ptr<const SCRSDK::ICrCameraObjectInfo> reconnectObjectInfo(const CameraDevice& cam)
+{
+    std::string id(cam.m_modelId.begin(), cam.m_modelId.end());
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    for (const auto& reg : g_registry) {
+        if (reg.id != id) continue;
+        if (SCRSDK::ICrCameraObjectInfo* fresh = createRegisteredObjectInfo(reg)) {
+            return std::shared_ptr<const SCRSDK::ICrCameraObjectInfo>(fresh, [](const SCRSDK::ICrCameraObjectInfo* p) {
+                const_cast<SCRSDK::ICrCameraObjectInfo*>(p)->Release();
+            });
         }
+        break;
     }
+    return cam.m_objInfo;
+}
 
-    g_scanning = false;
+// Move one camera between Remote and ContentsTransfer; the others keep running.
+// A camera that cannot get back to Remote mode is handed to recovery.
+// With the camera's operation lock held.
+static bool switchCameraMode(const std::shared_ptr<CameraDevice>& cam, CameraDevice::Mode mode)
+{
+    auto objInfo = reconnectObjectInfo(*cam);
+    bool ok = cam->switchMode(mode, objInfo.get());
+    if (ok) {
+        cam->m_objInfo = objInfo;
+    } else if (mode == CameraDevice::Mode::Remote) {
+        cam->setHealth(CameraDevice::Health::Lost);
+    }
+    return ok;
 }
 
 // ---------------------------------------------------------------------------
-// Camera management thread
+// Scan and Connect
 // ---------------------------------------------------------------------------
 
-static void cameraManagementThread()
+// Retry schedule for a camera whose connection fails: 2, 4, 8, 16, 30 s
+static const int kMaxConnectAttempts = 6;
+static const int kConnectBackoffMaxSecs = 30;
+// Let a new connection settle before pushing the preset to it
+static const std::chrono::milliseconds kPresetSettleDelay(1500);
+// Upper bound for one first connection attempt (3 tries with resets) when
+// waiting for a session's first round
+static const std::chrono::seconds kFirstAttemptTimeout(60);
+
+// One enumeration (or registry pass) and the connection attempts that came out of it
+struct ScanSession
 {
-    // USB reset on startup to clear stale connections from previous process
+    enum class State { Connecting, Retrying, Connected, Failed, Cancelled };
+
+    struct Camera {
+        // Enumerated objects share ownership of their ICrEnumCameraObjectInfo,
+        // so the pointer stays valid until the last retry is done
+        std::shared_ptr<const SCRSDK::ICrCameraObjectInfo> objInfo;
+        bool registered = false; // created from the registry, not enumerated
+        CrString id;
+        State state = State::Connecting;
+        int attempt = 0;
+        bool firstAttemptDone = false;
+    };
+
+    uint64_t generation = 0;
+
+    std::mutex mutex;
+    std::condition_variable firstRoundCond;
+    std::vector<Camera> cameras;
+    size_t firstRoundPending = 0;
+
+    void update(size_t slot, State state, int attempt)
     {
-        std::lock_guard<std::mutex> lock(g_mutex);
-        scanAndConnect(true);
+        std::lock_guard<std::mutex> lock(mutex);
+        Camera& cam = cameras[slot];
+        cam.state = state;
+        cam.attempt = attempt;
+        if (state != State::Connecting && !cam.firstAttemptDone) {
+            cam.firstAttemptDone = true;
+            if (--firstRoundPending == 0) firstRoundCond.notify_all();
+        }
+        setScanStatus(summaryLocked());
     }
 
-    // Let the initial connection stabilize before monitoring
-    std::this_thread::sleep_for(std::chrono::seconds(15));
-
-    int disconnectedSecs = 0;
-    const int kResetAfterSecs = 20;
-
-    while (g_running) {
-        std::this_thread::sleep_for(std::chrono::seconds(5));
-        if (!g_running || g_downloading || g_scanning) { disconnectedSecs = 0; continue; }
+    // False if some camera had not finished its first attempt within timeout
+    bool waitFirstRound(std::chrono::seconds timeout)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        return firstRoundCond.wait_for(lock, timeout, [this]() { return firstRoundPending == 0; });
+    }
 
-        std::lock_guard<std::mutex> lock(g_mutex);
+    size_t count(State state)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return (size_t)std::count_if(cameras.begin(), cameras.end(),
+            [state](const Camera& c) { return c.state == state; });
+    }
 
-        // Clear reconnecting flags for cameras that recovered
-        for (auto& cam : g_cameras) {
-            if (cam->m_connected && cam->m_reconnecting) {
-                std::cout << "  Reconnected: "
-                          << std::string(cam->m_modelId.begin(), cam->m_modelId.end()) << "\n";
-                cam->m_reconnecting = false;
+    // e.g. "Connecting: 3/8 connected, 2 in progress, 1 retrying [ILME-FX30 (D1) attempt 2]"
+    std::string summaryLocked() const
+    {
+        size_t n[5] = {};
+        std::string retrying;
+        for (const auto& c : cameras) {
+            n[(int)c.state]++;
+            if (c.state == State::Retrying) {
+                if (!retrying.empty()) retrying += ", ";
+                retrying += std::string(c.id.begin(), c.id.end()) + " attempt " + std::to_string(c.attempt + 1);
             }
         }
+        std::string str = "Connecting: " + std::to_string(n[(int)State::Connected]) + "/" +
+            std::to_string(cameras.size()) + " connected";
+        if (n[(int)State::Connecting]) str += ", " + std::to_string(n[(int)State::Connecting]) + " in progress";
+        if (n[(int)State::Retrying])   str += ", " + std::to_string(n[(int)State::Retrying]) + " retrying [" + retrying + "]";
+        if (n[(int)State::Failed])     str += ", " + std::to_string(n[(int)State::Failed]) + " failed";
+        return str;
+    }
+};
 
-        // Check if all cameras are OK
-        bool allOk = !g_cameras.empty();
-        for (auto& cam : g_cameras) {
-            if (!cam->m_connected) {
-                allOk = false;
-                break;
-            }
-        }
+static void applyPresetTask(std::shared_ptr<CameraDevice> cam, uint64_t generation)
+{
+    if (!g_running || generation != g_connectGeneration) return;
+    std::lock_guard<std::mutex> op(cam->m_opMutex);
+    if (generation != g_connectGeneration || !cam->isRemote()) return;
+    auto preset = loadPreset(g_presetPath);
+    if (preset.empty()) return;
+    int n = applyPreset(*cam, preset);
+    logInfo("preset applied").kv("camera", cam->m_modelId).kv("settings", n);
+}
 
-        if (allOk) {
-            disconnectedSecs = 0;
-            continue;
-        }
+// Must be called with g_mutex held
+static void forgetConnectingIdLocked(const CrString& id, uint64_t generation)
+{
+    g_connectingIds.erase(std::remove_if(g_connectingIds.begin(), g_connectingIds.end(),
+        [&](const ConnectingId& c) { return c.id == id && c.generation == generation; }),
+        g_connectingIds.end());
+}
 
-        disconnectedSecs += 5;
-        std::cout << "Camera(s) disconnected for " << disconnectedSecs << "s...\n";
+static void forgetConnectingId(const CrString& id, uint64_t generation)
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+    forgetConnectingIdLocked(id, generation);
+}
 
-        // Only do a full tear-down after sustained disconnection
-        if (disconnectedSecs >= kResetAfterSecs) {
-            std::cout << "Resetting after " << disconnectedSecs << "s disconnection...\n";
-            for (auto& cam : g_cameras) cam->disconnect();
-            g_cameras.clear();
-            scanAndConnect(true);
-            disconnectedSecs = 0;
+// One connection attempt for one camera. Reschedules itself with backoff on
+// failure so the other cameras never wait on a flaky one.
+static void connectTask(std::shared_ptr<ScanSession> session, size_t slot, int attempt)
+{
+    ScanSession::Camera info;
+    {
+        std::lock_guard<std::mutex> lock(session->mutex);
+        info = session->cameras[slot];
+    }
+
+    if (!g_running || session->generation != g_connectGeneration) {
+        forgetConnectingId(info.id, session->generation);
+        session->update(slot, ScanSession::State::Cancelled, attempt);
+        return;
+    }
+
+    session->update(slot, ScanSession::State::Connecting, attempt);
+    auto cam = std::make_shared<CameraDevice>();
+    // Keep the id the registry and later scans know this body by. Set before
+    // connecting, since callbacks log it from the moment the SDK has the camera.
+    cam->m_modelId = info.id;
+    cam->m_objInfo = info.objInfo;
+    if (cam->connect(info.objInfo.get(), 1)) {
+        if (!info.registered) registerCamera(info.objInfo.get());
+        {
+            std::lock_guard<std::mutex> lock(g_mutex);
+            forgetConnectingIdLocked(info.id, session->generation);
+            if (session->generation != g_connectGeneration) {
+                // Cameras were torn down while this one was connecting
+                cam->disconnect();
+                session->update(slot, ScanSession::State::Cancelled, attempt);
+                return;
+            }
+            g_cameras.push_back(cam);
         }
+        session->update(slot, ScanSession::State::Connected, attempt);
+        g_connectQueue.push([cam, generation = session->generation]() { applyPresetTask(cam, generation); },
+                            ConnectQueue::Clock::now() + kPresetSettleDelay);
+        return;
+    }
+
+    if (attempt >= kMaxConnectAttempts) {
+        logError("connect gave up").kv("camera", info.id).kv("attempts", attempt);
+        forgetConnectingId(info.id, session->generation);
+        session->update(slot, ScanSession::State::Failed, attempt);
+        return;
+    }
+
+    int backoff = std::min(kConnectBackoffMaxSecs, 1 << attempt);
+    logInfo("connect retry scheduled").kv("camera", info.id).kv("in_s", backoff)
+        .kv("attempt", attempt + 1).kv("max", kMaxConnectAttempts);
+    session->update(slot, ScanSession::State::Retrying, attempt);
+    if (!g_connectQueue.push([session, slot, attempt]() { connectTask(session, slot, attempt + 1); },
+                             ConnectQueue::Clock::now() + std::chrono::seconds(backoff))) {
+        // Shutting down
+        forgetConnectingId(info.id, session->generation);
+        session->update(slot, ScanSession::State::Cancelled, attempt);
     }
 }
 
-// ---------------------------------------------------------------------------
-// File Download
-// ---------------------------------------------------------------------------
+// Queue a camera on the session unless it is already connected or connecting.
+// Must be called with g_mutex held.
+static bool addSessionCamera(ScanSession& session, const CrString& id,
+                             std::shared_ptr<const SCRSDK::ICrCameraObjectInfo> objInfo, bool registered)
+{
+    bool busy = std::any_of(g_connectingIds.begin(), g_connectingIds.end(),
+        [&](const ConnectingId& c) { return c.id == id && c.generation == session.generation; });
+    for (auto& cam : g_cameras) {
+        // A camera that is not connected is being recovered by the management thread
+        if (cam->m_modelId == id) busy = true;
+    }
+    if (busy) {
+        logDebug("already connected or connecting").kv("camera", id);
+        return false;
+    }
 
-static void downloadFilesThread()
+    g_connectingIds.push_back({ id, session.generation });
+    ScanSession::Camera cam;
+    cam.objInfo = std::move(objInfo);
+    cam.registered = registered;
+    cam.id = id;
+    session.cameras.push_back(cam);
+    return true;
+}
+
+// Start every camera of the session on the connect workers and wait until each
+// has had its first attempt. Returns the number connected in that round.
+static size_t runSession(std::shared_ptr<ScanSession> session)
 {
-    g_downloading = true;
-    std::string dlPath;
     {
         std::lock_guard<std::mutex> lock(g_mutex);
-        g_downloadStatus = "Starting download...";
-        dlPath = g_downloadPath;
+        session->firstRoundPending = session->cameras.size();
     }
-
-    // Create download directory
-    try {
-        fs::create_directories(dlPath);
-    } catch (const std::exception& e) {
-        std::lock_guard<std::mutex> lock(g_mutex);
-        g_downloadStatus = std::string("Error creating directory: ") + e.what();
-        g_downloading = false;
-        return;
+    std::cout << "Connecting " << session->cameras.size() << " camera(s), up to "
+              << kMaxParallelConnects << " at a time...\n";
+    for (size_t slot = 0; slot < session->cameras.size(); slot++) {
+        if (!g_connectQueue.push([session, slot]() { connectTask(session, slot, 1); })) {
+            // Shutting down: this camera gets no first attempt
+            forgetConnectingId(session->cameras[slot].id, session->generation);
+            session->update(slot, ScanSession::State::Cancelled, 0);
+        }
+    }
+    size_t rounds = (session->cameras.size() + kMaxParallelConnects - 1) / kMaxParallelConnects;
+    if (!session->waitFirstRound(kFirstAttemptTimeout * (long long)rounds)) {
+        logWarn("first connection round timed out").kv("cameras", session->cameras.size())
+            .kv("pending", session->count(ScanSession::State::Connecting));
     }
+    return session->count(ScanSession::State::Connected);
+}
 
-    // Step 1: Disconnect all cameras from Remote mode
+// Connect every registered camera directly, in parallel, without enumeration.
+// Returns the number connected in the first round.
+static size_t connectRegistered()
+{
+    std::vector<RegisteredCamera> known;
     {
-        std::lock_guard<std::mutex> lock(g_mutex);
-        g_downloadStatus = "Disconnecting cameras from Remote mode...";
-        for (auto& cam : g_cameras) cam->disconnect();
-        g_cameras.clear();
+        std::lock_guard<std::mutex> lock(g_registryMutex);
+        known = g_registry;
     }
+    if (known.empty()) return 0;
 
-    std::this_thread::sleep_for(std::chrono::seconds(2));
+    setScanStatus("Connecting registered cameras...");
 
-    // Step 2: Enumerate and connect in ContentsTransfer mode
-    {
+    auto session = std::make_shared<ScanSession>();
+    session->generation = g_connectGeneration;
+    for (const auto& reg : known) {
+        SCRSDK::ICrCameraObjectInfo* objInfo = createRegisteredObjectInfo(reg);
+        if (!objInfo) continue;
+        std::shared_ptr<const SCRSDK::ICrCameraObjectInfo> owned(objInfo,
+            [](const SCRSDK::ICrCameraObjectInfo* p) { const_cast<SCRSDK::ICrCameraObjectInfo*>(p)->Release(); });
         std::lock_guard<std::mutex> lock(g_mutex);
-        g_downloadStatus = "Scanning for cameras in ContentsTransfer mode...";
+        addSessionCamera(*session, CrString(reg.id.begin(), reg.id.end()), owned, true);
     }
 
+    size_t connected = 0;
+    if (!session->cameras.empty()) {
+        connected = runSession(session);
+        std::cout << connected << "/" << session->cameras.size() << " registered camera(s) connected.\n";
+        setScanStatus("Registered cameras: " + std::to_string(connected) + "/" +
+            std::to_string(session->cameras.size()) + " connected.");
+    }
+    return connected;
+}
+
+// Enumerate cameras and connect every new FX30 concurrently on the connect
+// workers. Returns once each camera has had its first attempt; cameras that
+// failed it keep retrying in the background while the healthy ones are
+// already in g_cameras. Runs on the scan job worker; must be called WITHOUT
+// g_mutex held.
+static void scanAndConnect(JobExecutor::Context& job, bool usbReset = false)
+{
+#if defined(__APPLE__)
+    if (usbReset) {
+        setScanStatus("Resetting USB devices...");
+        std::cout << "Resetting USB...\n";
+        resetUSBDevice(kSonyVendorId, kFX30ProductId);
+        setScanStatus("Waiting for USB re-enumeration...");
+        std::this_thread::sleep_for(std::chrono::milliseconds(6000));
+    }
+#endif
+
     SCRSDK::ICrEnumCameraObjectInfo* enumInfo = nullptr;
-    SCRSDK::CrError err = SCRSDK::EnumCameraObjects(&enumInfo, 3);
+    setScanStatus("Enumerating cameras...");
+    std::cout << "Scanning for cameras (3 seconds)...\n";
+
+    SCRSDK::CrError err = SdkCall::EnumCameraObjects(&enumInfo, 3);
     if (err || !enumInfo) {
-        std::lock_guard<std::mutex> lock(g_mutex);
-        g_downloadStatus = "Error: No cameras found for download.";
-        // Try to reconnect in Remote mode
-        scanAndConnect(false);
-        g_downloading = false;
+        std::cout << "No cameras found.\n";
+        setScanStatus("No cameras found.");
         return;
     }
 
-    uint32_t camCount = enumInfo->GetCount();
-    std::vector<std::unique_ptr<CameraDevice>> dlCameras;
+    auto session = std::make_shared<ScanSession>();
+    std::shared_ptr<SCRSDK::ICrEnumCameraObjectInfo> owner(enumInfo,
+        [](SCRSDK::ICrEnumCameraObjectInfo* p) { p->Release(); });
+    session->generation = g_connectGeneration;
 
-    for (uint32_t i = 0; i < camCount; i++) {
-        auto* objInfo = enumInfo->GetCameraObjectInfo(i);
-        if (!isFX30Camera(objInfo)) continue;
-
-        auto cam = std::make_unique<CameraDevice>();
-        if (cam->connectContentsTransfer(objInfo)) {
-            dlCameras.push_back(std::move(cam));
+    size_t total = 0;
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        uint32_t count = enumInfo->GetCount();
+        for (uint32_t i = 0; i < count; i++) {
+            auto* objInfo = enumInfo->GetCameraObjectInfo(i);
+            if (!isFX30Camera(objInfo)) {
+                CrCout << "  Skipping non-FX30: " << objInfo->GetModel() << "\n";
+                continue;
+            }
+            addSessionCamera(*session, getModelId(objInfo),
+                std::shared_ptr<const SCRSDK::ICrCameraObjectInfo>(owner, objInfo), false);
         }
+        total = g_cameras.size();
     }
-    enumInfo->Release();
 
-    if (dlCameras.empty()) {
-        std::lock_guard<std::mutex> lock(g_mutex);
-        g_downloadStatus = "Error: Could not connect to any camera in ContentsTransfer mode.";
-        scanAndConnect(false);
-        g_downloading = false;
+    if (session->cameras.empty()) {
+        std::cout << "No new FX30 cameras found.\n";
+        setScanStatus("Scan complete. No new cameras found.");
+        return;
+    }
+    if (job.cancelled()) {
+        // Nothing was queued yet; release the ids claimed above
+        for (const auto& cam : session->cameras) forgetConnectingId(cam.id, session->generation);
+        setScanStatus("Scan cancelled.");
         return;
     }
 
-    // Step 3: Wait for ContentsTransfer to become ready
-    std::this_thread::sleep_for(std::chrono::seconds(3));
+    size_t connected = runSession(session);
+    size_t retrying = session->count(ScanSession::State::Retrying);
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        total = g_cameras.size();
+    }
+    std::cout << connected << " FX30 camera(s) connected. Total: " << total << "\n";
+    std::string status = "Scan complete. " + std::to_string(connected) + " new camera(s), " +
+        std::to_string(total) + " total.";
+    if (retrying) status += " " + std::to_string(retrying) + " still retrying in background.";
+    setScanStatus(status);
+}
 
-    // Step 4: Download files from each camera
-    int totalFiles = 0;
-    int skippedFiles = 0;
-    int downloadedFiles = 0;
-    int errorFiles = 0;
+// ---------------------------------------------------------------------------
+// Camera management thread
+// ---------------------------------------------------------------------------
 
-    for (size_t ci = 0; ci < dlCameras.size(); ci++) {
-        auto& cam = dlCameras[ci];
-        std::string camName(cam->m_modelId.begin(), cam->m_modelId.end());
+// How long the SDK may try to reconnect on its own before the camera counts as lost
+static const std::chrono::seconds kReconnectGrace(20);
 
-        // Set save info
-        err = SCRSDK::SetSaveInfo(cam->m_device_handle,
-            const_cast<CrChar*>(dlPath.c_str()),
-            const_cast<CrChar*>(CRSTR("")), -1);
-        if (err) {
+// Reconnect one lost camera. Reschedules itself with backoff until the camera
+// is back; other cameras are never disconnected or reset for it.
+static void recoverTask(std::shared_ptr<CameraDevice> cam, uint64_t generation)
+{
+    if (!g_running || generation != g_connectGeneration) return;
+    // Handle, object info and mode are replaced below; API handlers skip the camera meanwhile
+    std::lock_guard<std::mutex> op(cam->m_opMutex);
+    // Checked under the lock: a reset, or the SDK reconnecting by itself, may have come first
+    if (!g_running || generation != g_connectGeneration) return;
+    if (cam->m_health != CameraDevice::Health::Recovering) return;
+
+    // Drop the dead handle first; the closing flag keeps its callbacks from counting as a loss
+    cam->disconnect();
+    cam->m_mode = CameraDevice::Mode::Remote;
+
+    std::shared_ptr<const SCRSDK::ICrCameraObjectInfo> objInfo = reconnectObjectInfo(*cam);
+
+    cam->m_recoveryAttempts++;
+    const CrString& modelId = cam->m_modelId;
+    if (objInfo && cam->connect(objInfo.get(), 1)) {
+        cam->m_objInfo = objInfo;
+        logInfo("recovered").kv("camera", modelId).kv("attempts", cam->m_recoveryAttempts);
+        cam->m_recoveryAttempts = 0;
+        g_connectQueue.push([cam, generation]() { applyPresetTask(cam, generation); },
+                            ConnectQueue::Clock::now() + kPresetSettleDelay);
+        return;
+    }
+
+    int backoff = std::min(kConnectBackoffMaxSecs, 1 << std::min(cam->m_recoveryAttempts, 5));
+    logWarn("recovery failed").kv("camera", modelId).kv("attempt", cam->m_recoveryAttempts)
+        .kv("retry_in_s", backoff);
+    g_connectQueue.push([cam, generation]() { recoverTask(cam, generation); },
+                        ConnectQueue::Clock::now() + std::chrono::seconds(backoff));
+}
+
+// Drives each camera's health state from its callbacks: a Reconnecting camera
+// gets kReconnectGrace to come back through the SDK, a Lost one is handed to
+// recoverTask. Wakes on health changes, and otherwise only for grace deadlines.
+static void cameraManagementThread()
+{
+    SdkTrace::setThreadName("management");
+    // Known bodies connect directly; enumeration then only looks for new ones.
+    // Without a registry, reset USB on startup to clear stale connections from
+    // a previous process.
+    loadRegistry();
+    g_jobs.submit(kScanJobs, "startup", [](JobExecutor::Context& job) {
+        scanAndConnect(job, connectRegistered() == 0);
+        job.setStatus(getScanStatus());
+    });
+
+    while (g_running) {
+        auto deadline = std::chrono::steady_clock::time_point::max();
+        std::vector<std::pair<std::shared_ptr<CameraDevice>, CameraDevice::Health>> lost;
+        {
             std::lock_guard<std::mutex> lock(g_mutex);
-            g_downloadStatus = "Error: SetSaveInfo failed for " + camName;
-            continue;
+            for (auto& cam : g_cameras) {
+                switch (cam->m_health.load()) {
+                case CameraDevice::Health::Reconnecting: {
+                    auto age = cam->healthAge();
+                    if (age >= kReconnectGrace) {
+                        logWarn("reconnect grace expired").kv("camera", cam->m_modelId)
+                            .kv("grace_s", (long long)kReconnectGrace.count());
+                        lost.emplace_back(cam, CameraDevice::Health::Reconnecting);
+                    } else {
+                        deadline = std::min(deadline, std::chrono::steady_clock::now() + (kReconnectGrace - age));
+                    }
+                    break;
+                }
+                case CameraDevice::Health::Lost:
+                    lost.emplace_back(cam, CameraDevice::Health::Lost);
+                    break;
+                default:
+                    break;
+                }
+            }
         }
 
-        // Get folder list
-        SCRSDK::CrMtpFolderInfo* folderList = nullptr;
-        CrInt32u folderCount = 0;
-        err = SCRSDK::GetDateFolderList(cam->m_device_handle, &folderList, &folderCount);
-        if (err || !folderList || folderCount == 0) {
-            std::lock_guard<std::mutex> lock(g_mutex);
-            g_downloadStatus = "No folders found on " + camName;
-            continue;
+        for (auto& entry : lost) {
+            auto cam = entry.first;
+            // Skip it if the SDK brought the camera back in the meantime
+            if (!cam->transitionHealth(entry.second, CameraDevice::Health::Recovering)) continue;
+            logWarn("lost, recovering").kv("camera", cam->m_modelId);
+            g_connectQueue.push([cam, generation = g_connectGeneration.load()]() { recoverTask(cam, generation); });
+        }
+
+        std::unique_lock<std::mutex> lock(g_healthMutex);
+        auto pred = []() { return g_healthChanged || !g_running; };
+        if (deadline == std::chrono::steady_clock::time_point::max()) {
+            g_healthCond.wait(lock, pred);
+        } else {
+            g_healthCond.wait_until(lock, deadline, pred);
         }
+        g_healthChanged = false;
+    }
+}
 
-        for (CrInt32u fi = 0; fi < folderCount; fi++) {
-            SCRSDK::CrContentHandle* contentHandles = nullptr;
-            CrInt32u contentCount = 0;
+// ---------------------------------------------------------------------------
+// File Download
+// ---------------------------------------------------------------------------
 
-            err = SCRSDK::GetContentsHandleList(cam->m_device_handle,
-                folderList[fi].handle, &contentHandles, &contentCount);
-            if (err || !contentHandles || contentCount == 0) continue;
+struct DownloadProgress {
+    int total = 0;
+    int skipped = 0;
+    int downloaded = 0;
+    int errors = 0;
+};
 
-            for (CrInt32u ci2 = 0; ci2 < contentCount; ci2++) {
-                SCRSDK::CrMtpContentsInfo info;
-                err = SCRSDK::GetContentsDetailInfo(cam->m_device_handle,
-                    contentHandles[ci2], &info);
-                if (err) { errorFiles++; continue; }
+// Also publishes the counts for /api/status
+static std::string verifyStatus(const MediaVerifier& verifier)
+{
+    MediaVerifier::Counts c = verifier.counts();
+    g_verifiedFiles = c.verified;
+    g_unverifiedFiles = c.queued - c.verified;
+    return ", Verified: " + std::to_string(c.verified) + ", Unverified: " + std::to_string(c.queued - c.verified);
+}
 
-                totalFiles++;
-                std::string fileName(info.fileName);
+// Pull every file from one camera that is connected in ContentsTransfer mode
+static void downloadCameraFiles(const JobExecutor::Context& job, const std::shared_ptr<CameraDevice>& cam,
+                                const std::string& dlPath, MediaVerifier& verifier, DownloadProgress& progress)
+{
+    std::string camName(cam->m_modelId.begin(), cam->m_modelId.end());
 
-                // Skip if file already exists
-                std::string fullPath = dlPath + "/" + fileName;
-                if (fs::exists(fullPath)) {
-                    skippedFiles++;
-                    {
-                        std::lock_guard<std::mutex> lock(g_mutex);
-                        g_downloadStatus = "Skipped (exists): " + fileName +
-                            " [" + std::to_string(downloadedFiles + skippedFiles) + "/" + std::to_string(totalFiles) + "]";
-                    }
-                    continue;
-                }
+    // Set save info
+    SCRSDK::CrError err = SdkCall::SetSaveInfo(cam->m_device_handle,
+        const_cast<CrChar*>(dlPath.c_str()),
+        const_cast<CrChar*>(CRSTR("")), -1);
+    if (err) {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        g_downloadStatus = "Error: SetSaveInfo failed for " + camName;
+        return;
+    }
 
+    // Get folder list
+    SCRSDK::CrMtpFolderInfo* folderList = nullptr;
+    CrInt32u folderCount = 0;
+    err = SdkCall::GetDateFolderList(cam->m_device_handle, &folderList, &folderCount);
+    if (err || !folderList || folderCount == 0) {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        g_downloadStatus = "No folders found on " + camName;
+        return;
+    }
+
+    for (CrInt32u fi = 0; fi < folderCount && !job.cancelled(); fi++) {
+        SCRSDK::CrContentHandle* contentHandles = nullptr;
+        CrInt32u contentCount = 0;
+
+        err = SdkCall::GetContentsHandleList(cam->m_device_handle,
+            folderList[fi].handle, &contentHandles, &contentCount);
+        if (err || !contentHandles || contentCount == 0) continue;
+
+        for (CrInt32u ci2 = 0; ci2 < contentCount && !job.cancelled(); ci2++) {
+            SCRSDK::CrMtpContentsInfo info;
+            err = SdkCall::GetContentsDetailInfo(cam->m_device_handle,
+                contentHandles[ci2], &info);
+            if (err) { progress.errors++; continue; }
+
+            progress.total++;
+            std::string fileName(info.fileName);
+
+            // Skip if file already exists; it still goes into the manifest,
+            // and a partial file from an interrupted run shows up as a size mismatch
+            std::string fullPath = dlPath + "/" + fileName;
+            if (fs::exists(fullPath)) {
+                progress.skipped++;
+                verifier.add(fullPath, fileName, info.contentSize);
                 {
                     std::lock_guard<std::mutex> lock(g_mutex);
-                    g_downloadStatus = "Downloading: " + fileName +
-                        " from " + camName +
-                        " [" + std::to_string(downloadedFiles + skippedFiles + 1) + "/" + std::to_string(totalFiles) + "]";
+                    g_downloadStatus = "Skipped (exists): " + fileName +
+                        " [" + std::to_string(progress.downloaded + progress.skipped) + "/" + std::to_string(progress.total) + "]";
                 }
+                continue;
+            }
 
-                // Pull file
-                std::promise<void> dlPromise;
-                std::future<void> dlFuture = dlPromise.get_future();
-                cam->setDownloadPromise(&dlPromise);
+            {
+                std::lock_guard<std::mutex> lock(g_mutex);
+                g_downloadStatus = "Downloading: " + fileName +
+                    " from " + camName +
+                    " [" + std::to_string(progress.downloaded + progress.skipped + 1) + "/" + std::to_string(progress.total) + "]" +
+                    verifyStatus(verifier);
+            }
 
-                err = SCRSDK::PullContentsFile(cam->m_device_handle,
-                    contentHandles[ci2], SCRSDK::CrPropertyStillImageTransSize_Original);
-                if (err) {
-                    cam->setDownloadPromise(nullptr);
-                    errorFiles++;
-                    continue;
-                }
+            // Pull file
+            AsyncOps::Op pulled = cam->m_ops.expect(AsyncOps::Kind::ContentsTransfer, contentHandles[ci2]);
 
-                // Wait for download completion (timeout 5 minutes per file)
-                try {
-                    auto status = dlFuture.wait_for(std::chrono::minutes(5));
-                    if (status == std::future_status::timeout) {
-                        errorFiles++;
-                        cam->setDownloadPromise(nullptr);
-                        std::lock_guard<std::mutex> lock(g_mutex);
-                        g_downloadStatus = "Timeout downloading: " + fileName;
-                        continue;
-                    }
-                    dlFuture.get();
-                    downloadedFiles++;
-                } catch (const std::exception&) {
-                    errorFiles++;
-                    std::lock_guard<std::mutex> lock(g_mutex);
-                    g_downloadStatus = "Error downloading: " + fileName;
-                }
+            static SdkCallMetrics& pullMetrics = sdkCallMetrics("PullContentsFile");
+            auto pullStarted = std::chrono::steady_clock::now();
+            err = timedSdkCall(pullMetrics, [&]() {
+                return SdkCall::PullContentsFile(cam->m_device_handle,
+                    contentHandles[ci2], SCRSDK::CrPropertyStillImageTransSize_Original);
+            });
+            if (err) {
+                progress.errors++;
+                appMetrics().downloadErrors.inc();
+                continue;
+            }
 
-                // Brief pause between files (workaround per SDK sample)
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            // Wait for download completion (timeout 5 minutes per file)
+            AsyncOps::Result pull = pulled.waitFor(std::chrono::minutes(5));
+            if (pull.ok) {
+                progress.downloaded++;
+                appMetrics().downloadSeconds.observe(std::chrono::steady_clock::now() - pullStarted);
+                appMetrics().downloadBytes.inc(info.contentSize);
+                verifier.add(fullPath, fileName, info.contentSize);
+            }
+            else {
+                progress.errors++;
+                appMetrics().downloadErrors.inc();
+                std::lock_guard<std::mutex> lock(g_mutex);
+                g_downloadStatus = (pull.timedOut ? "Timeout downloading: " : "Error downloading: ") + fileName;
+                if (pull.timedOut) continue;
             }
 
-            SCRSDK::ReleaseContentsHandleList(cam->m_device_handle, contentHandles);
+            // Brief pause between files (workaround per SDK sample)
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
         }
 
-        SCRSDK::ReleaseDateFolderList(cam->m_device_handle, folderList);
+        SdkCall::ReleaseContentsHandleList(cam->m_device_handle, contentHandles);
     }
 
-    // Step 5: Disconnect from ContentsTransfer
-    for (auto& cam : dlCameras) cam->disconnect();
-    dlCameras.clear();
-
-    std::this_thread::sleep_for(std::chrono::seconds(2));
+    SdkCall::ReleaseDateFolderList(cam->m_device_handle, folderList);
+}
 
-    // Step 6: Reconnect in Remote mode
+// Offload the given cameras one at a time. Each one is switched to
+// ContentsTransfer mode, emptied and switched back to Remote mode on its own,
+// so every other camera keeps recording and monitoring meanwhile. A camera is
+// held under its operation lock for the whole offload; one that is recording,
+// not in Remote mode or whose state cannot be read is skipped.
+// Runs on the download job worker; a cancelled job stops after the current
+// file and still switches that camera back.
+static void downloadFiles(JobExecutor::Context& job, const std::vector<std::shared_ptr<CameraDevice>>& targets,
+                          const std::string& dlPath)
+{
     {
         std::lock_guard<std::mutex> lock(g_mutex);
-        g_downloadStatus = "Download complete. Downloaded: " + std::to_string(downloadedFiles) +
-            ", Skipped: " + std::to_string(skippedFiles) +
-            ", Errors: " + std::to_string(errorFiles) +
-            ". Reconnecting...";
-        scanAndConnect(false);
-        g_downloadStatus = "Download complete. Downloaded: " + std::to_string(downloadedFiles) +
-            ", Skipped: " + std::to_string(skippedFiles) +
-            ", Errors: " + std::to_string(errorFiles);
+        g_downloadStatus = "Starting download...";
+    }
+
+    // Create download directory
+    try {
+        fs::create_directories(dlPath);
+    } catch (const std::exception& e) {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        g_downloadStatus = std::string("Error creating directory: ") + e.what();
+        job.fail(g_downloadStatus);
+        return;
+    }
+
+    // Each downloaded file is hashed while the next one transfers
+    MediaVerifier verifier;
+    g_verifiedFiles = 0;
+    g_unverifiedFiles = 0;
+    DownloadProgress progress;
+    int failedSwitches = 0;
+    int skippedCameras = 0;
+
+    for (auto& cam : targets) {
+        if (job.cancelled()) break;
+        std::string camName(cam->m_modelId.begin(), cam->m_modelId.end());
+        std::lock_guard<std::mutex> op(cam->m_opMutex);
+        bool recording = false;
+        if (!cam->isRemote() || !cam->readRecording(recording) || recording) {
+            logWarn("skipping download").kv("camera", cam->m_modelId)
+                .kv("reason", !cam->isRemote() ? "not in remote mode" : recording ? "recording" : "state unknown");
+            skippedCameras++;
+            continue;
+        }
+        {
+            std::lock_guard<std::mutex> lock(g_mutex);
+            g_downloadStatus = "Switching " + camName + " to ContentsTransfer mode...";
+        }
+        if (switchCameraMode(cam, CameraDevice::Mode::ContentsTransfer)) {
+            downloadCameraFiles(job, cam, dlPath, verifier, progress);
+        } else {
+            failedSwitches++;
+            std::lock_guard<std::mutex> lock(g_mutex);
+            g_downloadStatus = "Error: could not switch " + camName + " to ContentsTransfer mode";
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(g_mutex);
+            g_downloadStatus = "Switching " + camName + " back to Remote mode...";
+        }
+        if (!switchCameraMode(cam, CameraDevice::Mode::Remote)) {
+            logWarn("did not return to remote mode, recovering").kv("camera", cam->m_modelId);
+        }
     }
 
-    g_downloading = false;
+    // Finish verification and write the manifest
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        g_downloadStatus = "Verifying downloaded files" + verifyStatus(verifier) + "...";
+    }
+    verifier.wait();
+    std::string manifestNote;
+    if (verifier.counts().queued > 0) {
+        char stamp[32];
+        std::time_t now = std::time(nullptr);
+        std::tm tm;
+#if defined(_WIN32) || defined(_WIN64)
+        localtime_s(&tm, &now);
+#else
+        localtime_r(&now, &tm);
+#endif
+        strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", &tm);
+        std::string manifestPath = dlPath + "/fx30_" + stamp + ".mhl";
+        if (verifier.writeManifest(manifestPath, "fx30MultiRecord")) {
+            manifestNote = ". Manifest: " + manifestPath;
+        }
+        else {
+            manifestNote = ". Manifest write failed: " + manifestPath;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        g_downloadStatus = std::string(job.cancelled() ? "Download cancelled" : "Download complete") +
+            ". Downloaded: " + std::to_string(progress.downloaded) +
+            ", Skipped: " + std::to_string(progress.skipped) +
+            ", Errors: " + std::to_string(progress.errors + failedSwitches) +
+            (skippedCameras ? ", Cameras skipped: " + std::to_string(skippedCameras) : std::string()) +
+            verifyStatus(verifier) + manifestNote;
+        job.setStatus(g_downloadStatus);
+    }
 }
 
 // ---------------------------------------------------------------------------
@@ -1428,11 +2803,12 @@ function renderCameras(data) {
   document.getElementById('dlPath').value = data.downloadPath;
   document.getElementById('dlStatus').textContent = data.downloadStatus || '';
   document.getElementById('btnDownload').disabled = busy;
-  document.getElementById('btnStart').disabled = busy;
-  document.getElementById('btnStop').disabled = busy;
+  // Recording control stays available while single cameras offload
+  document.getElementById('btnStart').disabled = data.scanning;
+  document.getElementById('btnStop').disabled = data.scanning;
   document.getElementById('btnScan').disabled = busy;
   document.getElementById('btnReset').disabled = busy;
-  document.getElementById('btnFormat').disabled = busy;
+  document.getElementById('btnFormat').disabled = data.scanning;
   document.getElementById('presetStatus').textContent = data.hasPreset ? 'Preset: ' + data.presetPath : 'No preset saved';
 
   // Adjust poll rate when busy
@@ -1445,7 +2821,8 @@ function renderCameras(data) {
 
   grid.innerHTML = cams.map((c, i) => {
     const recClass = !c.connected ? 'off' : (c.recording ? 'recording' : 'idle');
-    const recText = !c.connected ? 'Disconnected' : (c.recording ? 'RECORDING' : 'Idle');
+    const recText = c.mode === 'contentsTransfer' ? 'Offloading' : !c.connected ? (c.health === 'recovering' ? 'Recovering' : 'Disconnected') :
+      (c.health === 'reconnecting' ? 'Reconnecting' : (c.recording ? 'RECORDING' : 'Idle'));
     const bPct = c.battery >= 0 ? c.battery : 0;
     const bColor = batteryColor(c.battery);
     const bText = c.battery >= 0 ? c.battery + '%' : 'N/A';
@@ -1512,77 +2889,216 @@ poll();
 // JSON Builders
 // ---------------------------------------------------------------------------
 
-static std::string buildCameraJson(size_t index, CameraDevice& cam)
+// With g_mutex held. A camera busy with recovery or offload is listed without properties.
+static void writeCameraJson(JsonWriter& w, size_t index, CameraDevice& cam)
 {
-    std::string modelStr(cam.m_modelId.begin(), cam.m_modelId.end());
     CameraProperties props;
-    if (cam.m_connected) {
+    auto op = cam.tryLockOps();
+    if (op.owns_lock() && cam.m_connected) {
         props = cam.getProperties();
     }
 
-    std::ostringstream js;
-    js << "{";
-    js << "\"index\":" << index << ",";
-    js << "\"model\":\"" << jsonEscape(modelStr) << "\",";
-    js << "\"connected\":" << (cam.m_connected ? "true" : "false") << ",";
-    js << "\"recording\":" << (props.recording ? "true" : "false") << ",";
-    js << "\"battery\":" << props.battery << ",";
-    js << "\"iso\":\"" << jsonEscape(props.iso) << "\",";
-    js << "\"shutterSpeed\":\"" << jsonEscape(props.shutterSpeed) << "\",";
-    js << "\"fNumber\":\"" << jsonEscape(props.fNumber) << "\",";
-    js << "\"whiteBalance\":\"" << jsonEscape(props.whiteBalance) << "\",";
-    js << "\"colorTemp\":" << props.colorTemp << ",";
-    js << "\"mediaSlot1Min\":" << props.mediaSlot1Min << ",";
-    js << "\"mediaSlot2Min\":" << props.mediaSlot2Min << ",";
-    js << "\"movieFormat\":\"" << jsonEscape(props.movieFormat) << "\",";
-    js << "\"recSetting\":\"" << jsonEscape(props.recSetting) << "\",";
-    js << "\"frameRate\":\"" << jsonEscape(props.frameRate) << "\",";
-    js << "\"clipName\":\"" << jsonEscape(props.clipName) << "\",";
-    js << "\"heatState\":" << props.heatState;
-    js << "}";
-    return js.str();
-}
-
-static std::string buildStatusJson()
+    w.beginObject();
+    w.kv("index", index);
+#if defined(_WIN32) || defined(_WIN64)
+    w.kv("model", std::string(cam.m_modelId.begin(), cam.m_modelId.end()));
+#else
+    w.kv("model", cam.m_modelId);
+#endif
+    w.kv("connected", cam.m_connected);
+    w.kv("health", CameraDevice::healthName(cam.m_health));
+    w.kv("mode", cam.m_mode == CameraDevice::Mode::Remote ? "remote" : "contentsTransfer");
+    w.kv("busy", !op.owns_lock());
+    w.kv("recording", props.recording);
+    w.kv("battery", props.battery);
+    w.kv("iso", props.iso);
+    w.kv("shutterSpeed", props.shutterSpeed);
+    w.kv("fNumber", props.fNumber);
+    w.kv("whiteBalance", props.whiteBalance);
+    w.kv("colorTemp", props.colorTemp);
+    w.kv("mediaSlot1Min", props.mediaSlot1Min);
+    w.kv("mediaSlot2Min", props.mediaSlot2Min);
+    w.kv("movieFormat", props.movieFormat);
+    w.kv("recSetting", props.recSetting);
+    w.kv("frameRate", props.frameRate);
+    w.kv("clipName", props.clipName);
+    w.kv("heatState", props.heatState);
+    w.endObject();
+}
+
+static void writeStatusJson(JsonWriter& w)
 {
     std::unique_lock<std::mutex> lock(g_mutex, std::try_to_lock);
 
-    std::ostringstream js;
-    js << "{\"cameras\":[";
+    w.beginObject();
+    w.key("cameras").beginArray();
     if (lock.owns_lock()) {
         for (size_t i = 0; i < g_cameras.size(); i++) {
-            if (i > 0) js << ",";
-            js << buildCameraJson(i, *g_cameras[i]);
+            writeCameraJson(w, i, *g_cameras[i]);
         }
     }
-    js << "],";
-    js << "\"downloading\":" << (g_downloading.load() ? "true" : "false") << ",";
-    js << "\"downloadStatus\":\"" << jsonEscape(g_downloadStatus) << "\",";
-    js << "\"downloadPath\":\"" << jsonEscape(g_downloadPath) << "\",";
-    js << "\"scanning\":" << (g_scanning.load() ? "true" : "false") << ",";
-    js << "\"scanStatus\":\"" << jsonEscape(g_scanStatus) << "\",";
-    js << "\"presetPath\":\"" << jsonEscape(g_presetPath) << "\",";
-    js << "\"hasPreset\":" << (fs::exists(g_presetPath) ? "true" : "false");
-    js << "}";
-    return js.str();
+    w.endArray();
+    w.kv("downloading", g_jobs.busy(kDownloadJobs));
+    w.kv("downloadStatus", g_downloadStatus);
+    w.kv("verifiedFiles", g_verifiedFiles.load());
+    w.kv("unverifiedFiles", g_unverifiedFiles.load());
+    w.kv("downloadPath", g_downloadPath);
+    w.kv("scanning", g_jobs.busy(kScanJobs));
+    w.kv("scanStatus", getScanStatus());
+    w.kv("presetPath", g_presetPath);
+    w.kv("hasPreset", fs::exists(g_presetPath));
+    w.endObject();
+}
+
+static void writeJobsJson(JsonWriter& w)
+{
+    w.beginObject().key("jobs").beginArray();
+    for (const auto& job : g_jobs.jobs()) {
+        w.beginObject()
+            .kv("id", job.id)
+            .kv("queue", job.queue)
+            .kv("key", job.key)
+            .kv("state", JobExecutor::stateName(job.state))
+            .kv("status", job.status)
+            .kv("queuedMs", (long long)(job.queuedSecs * 1000))
+            .kv("runMs", (long long)(job.runSecs * 1000))
+            .endObject();
+    }
+    w.endArray().endObject();
+}
+
+// {"status":..., "job":id, "coalesced":bool}; a full queue is reported as an error
+static void sendSubmitted(httplib::Response& res, const JobExecutor::Submitted& job, const char* status)
+{
+    if (job.id == 0) {
+        sendError(res, "Too many pending jobs, try again later");
+        return;
+    }
+    JsonWriter& w = jsonWriter();
+    w.beginObject().kv("status", status).kv("job", job.id).kv("coalesced", job.coalesced).endObject();
+    sendJson(res, w);
 }
 
 // ---------------------------------------------------------------------------
-// Simple JSON body parser (extract string value for a key)
+// API Request Decoding
 // ---------------------------------------------------------------------------
 
-static std::string jsonGetString(const std::string& body, const std::string& key)
+// Each endpoint decodes its body once into a typed request. An empty body is
+// treated as "{}" so optional fields keep their defaults.
+
+// Per-thread token buffer reused across requests
+static JsonDocument& parseRequestBody(const std::string& body, std::string& error)
 {
-    std::string needle = "\"" + key + "\"";
-    auto pos = body.find(needle);
-    if (pos == std::string::npos) return "";
-    pos = body.find(':', pos + needle.size());
-    if (pos == std::string::npos) return "";
-    pos = body.find('"', pos + 1);
-    if (pos == std::string::npos) return "";
-    auto end = body.find('"', pos + 1);
-    if (end == std::string::npos) return "";
-    return body.substr(pos + 1, end - pos - 1);
+    static thread_local JsonDocument doc;
+    if (!doc.parse(body.empty() ? std::string_view("{}") : std::string_view(body))) {
+        error = std::string("invalid JSON: ") + doc.error();
+    } else if (!doc.root().isObject()) {
+        error = "request body must be a JSON object";
+    }
+    return doc;
+}
+
+struct PathRequest {
+    std::string path;   // Empty if not given
+};
+
+static bool decodePathRequest(const std::string& body, PathRequest& req, std::string& error)
+{
+    JsonDocument& doc = parseRequestBody(body, error);
+    if (!error.empty()) return false;
+    JsonValue path = doc.root()["path"];
+    if (path.valid() && !path.asString(req.path)) {
+        error = "\"path\" must be a string";
+        return false;
+    }
+    return true;
+}
+
+// Optional "cameras" member: an array of camera indexes
+static bool decodeCameraList(JsonValue cameras, std::vector<size_t>& out, std::string& error)
+{
+    if (!cameras.valid()) return true;
+    bool ok = cameras.isArray();
+    if (ok) {
+        cameras.forEachElement([&](JsonValue v) {
+            uint64_t index = 0;
+            if (!v.asUint(index)) ok = false;
+            else out.push_back((size_t)index);
+        });
+    }
+    if (!ok) error = "\"cameras\" must be an array of camera indexes";
+    return ok;
+}
+
+// {"path":"...", "cameras":[0,2]}, both optional. Omitting "cameras" offloads every camera.
+struct DownloadRequest {
+    std::string path;   // Empty if not given
+    std::vector<size_t> cameras;
+};
+
+static bool decodeDownloadRequest(const std::string& body, DownloadRequest& req, std::string& error)
+{
+    JsonDocument& doc = parseRequestBody(body, error);
+    if (!error.empty()) return false;
+    JsonValue path = doc.root()["path"];
+    if (path.valid() && !path.asString(req.path)) {
+        error = "\"path\" must be a string";
+        return false;
+    }
+    return decodeCameraList(doc.root()["cameras"], req.cameras, error);
+}
+
+struct JobRequest {
+    uint64_t id = 0;
+};
+
+static bool decodeJobRequest(const std::string& body, JobRequest& req, std::string& error)
+{
+    JsonDocument& doc = parseRequestBody(body, error);
+    if (!error.empty()) return false;
+    if (!doc.root()["id"].asUint(req.id)) {
+        error = "\"id\" must be a job id";
+        return false;
+    }
+    return true;
+}
+
+struct FormatRequest {
+    int64_t slot = 1;
+};
+
+static bool decodeFormatRequest(const std::string& body, FormatRequest& req, std::string& error)
+{
+    JsonDocument& doc = parseRequestBody(body, error);
+    if (!error.empty()) return false;
+    JsonValue slot = doc.root()["slot"];
+    if (slot.valid() && (!slot.asInt(req.slot) || (req.slot != 1 && req.slot != 2))) {
+        error = "\"slot\" must be 1 or 2";
+        return false;
+    }
+    return true;
+}
+
+// {"cameras":[0,2], "properties":{"iso":..., "FNumber":...}}
+// Omitting "cameras" targets every connected camera.
+struct PropertyBatchRequest {
+    std::vector<size_t> cameras;
+    std::vector<PresetEntry> properties;
+};
+
+static bool decodePropertyBatchRequest(const std::string& body, PropertyBatchRequest& req, std::string& error)
+{
+    JsonDocument& doc = parseRequestBody(body, error);
+    if (!error.empty()) return false;
+
+    if (!decodeCameraList(doc.root()["cameras"], req.cameras, error)) return false;
+
+    if (!decodePropertyMap(doc.root()["properties"], req.properties, error)) return false;
+    if (req.properties.empty()) {
+        error = "no properties given";
+        return false;
+    }
+    return true;
 }
 
 // ---------------------------------------------------------------------------
@@ -1601,19 +3117,31 @@ int main(int argc, char* argv[])
             g_downloadPath = argv[++i];
         } else if (arg == "--preset" && i + 1 < argc) {
             g_presetPath = argv[++i];
+        } else if (arg == "--registry" && i + 1 < argc) {
+            g_registryPath = argv[++i];
+        } else if (arg == "--log-level" && i + 1 < argc) {
+            LogLevel level;
+            if (parseLogLevel(argv[++i], level)) Logger::instance().setLevel(level);
+            else std::cerr << "Unknown log level " << argv[i] << ", using info\n";
         }
     }
 
     // Disable stdout buffering
     std::setvbuf(stdout, nullptr, _IONBF, 0);
     std::cout << "=== FX30 Multi-Camera Web Controller ===\n\n";
+    Logger::instance().start();
 
     if (!SCRSDK::Init()) {
         std::cerr << "Failed to initialize Sony Camera Remote SDK.\n";
         return 1;
     }
 
-    // Start camera management thread (handles initial scan + auto-rescan)
+    // Start connection workers and the camera management thread (handles initial scan + auto-rescan)
+    g_connectQueue.start(kMaxParallelConnects);
+    CallbackDispatcher::instance().setLatencyHistogram(&metrics().histogram(
+        "fx30_callback_dispatch_seconds", "Time from an SDK callback to the end of its handler"));
+    CallbackDispatcher::instance().start();
+    g_jobs.start([](const std::string& queue) { SdkTrace::setThreadName(queue + "-job"); });
     std::thread mgmtThread(cameraManagementThread);
 
     // Create HTTP server (starts immediately, doesn't wait for camera scan)
@@ -1624,177 +3152,394 @@ int main(int argc, char* argv[])
         res.set_content(HTML_PAGE, "text/html");
     });
 
+    // GET /metrics (Prometheus text format)
+    svr.Get("/metrics", [](const httplib::Request&, httplib::Response& res) {
+        {
+            std::lock_guard<std::mutex> lock(g_mutex);
+            int64_t connected = 0;
+            for (auto& cam : g_cameras) {
+                if (cam->m_health == CameraDevice::Health::Connected) connected++;
+            }
+            appMetrics().camerasConnected.set(connected);
+            appMetrics().cameras.set((int64_t)g_cameras.size());
+        }
+        CallbackDispatcher& dispatcher = CallbackDispatcher::instance();
+        appMetrics().callbackQueueDepth.set((int64_t)dispatcher.depth());
+        appMetrics().callbackQueueHighWater.set((int64_t)dispatcher.highWater());
+        appMetrics().callbackEventsDropped.set((int64_t)dispatcher.dropped());
+        res.set_content(metrics().render(), "text/plain; version=0.0.4");
+    });
+
+    // GET /api/trace — recent SDK calls as Chrome trace-event JSON
+    // (?clear=1 starts a new trace after this one)
+    svr.Get("/api/trace", [](const httplib::Request& req, httplib::Response& res) {
+        std::string json;
+        SdkTrace::writeChromeTrace(json);
+        if (req.get_param_value("clear") == "1") SdkTrace::clear();
+        res.set_content(json, "application/json");
+    });
+
     // GET /api/status
     svr.Get("/api/status", [](const httplib::Request&, httplib::Response& res) {
-        res.set_content(buildStatusJson(), "application/json");
+        JsonWriter& w = jsonWriter();
+        writeStatusJson(w);
+        sendJson(res, w);
     });
 
     // POST /api/start
     svr.Post("/api/start", [](const httplib::Request&, httplib::Response& res) {
-        if (g_downloading) {
-            res.set_content("{\"error\":\"Download in progress\"}", "application/json");
-            return;
-        }
+        // Cameras that are offloading or being recovered are skipped and counted
+        // as busy; the rest keep recording
         std::lock_guard<std::mutex> lock(g_mutex);
-        int ok = 0, fail = 0;
+        int ok = 0, fail = 0, busy = 0;
         for (auto& cam : g_cameras) {
-            if (cam->startRecording()) ok++; else fail++;
+            auto op = cam->tryLockOps();
+            if (!op.owns_lock()) busy++;
+            else if (cam->startRecording()) ok++;
+            else fail++;
         }
-        res.set_content("{\"ok\":" + std::to_string(ok) + ",\"failed\":" + std::to_string(fail) + "}", "application/json");
+        JsonWriter& w = jsonWriter();
+        w.beginObject().kv("ok", ok).kv("failed", fail).kv("busy", busy).endObject();
+        sendJson(res, w);
     });
 
     // POST /api/stop
     svr.Post("/api/stop", [](const httplib::Request&, httplib::Response& res) {
-        if (g_downloading) {
-            res.set_content("{\"error\":\"Download in progress\"}", "application/json");
-            return;
-        }
+        // Cameras that are offloading or being recovered are skipped and counted
+        // as busy; the rest keep recording
         std::lock_guard<std::mutex> lock(g_mutex);
-        int ok = 0, fail = 0;
+        int ok = 0, fail = 0, busy = 0;
         for (auto& cam : g_cameras) {
-            if (cam->stopRecording()) ok++; else fail++;
+            auto op = cam->tryLockOps();
+            if (!op.owns_lock()) busy++;
+            else if (cam->stopRecording()) ok++;
+            else fail++;
         }
-        res.set_content("{\"ok\":" + std::to_string(ok) + ",\"failed\":" + std::to_string(fail) + "}", "application/json");
+        JsonWriter& w = jsonWriter();
+        w.beginObject().kv("ok", ok).kv("failed", fail).kv("busy", busy).endObject();
+        sendJson(res, w);
     });
 
     // POST /api/scan
     svr.Post("/api/scan", [](const httplib::Request&, httplib::Response& res) {
-        if (g_downloading) {
-            res.set_content("{\"error\":\"Download in progress\"}", "application/json");
-            return;
-        }
-        if (g_scanning) {
-            res.set_content("{\"error\":\"Scan already in progress\"}", "application/json");
+        if (g_jobs.busy(kDownloadJobs)) {
+            sendError(res, "Download in progress");
             return;
         }
-        std::thread([]() {
-            std::lock_guard<std::mutex> lock(g_mutex);
-            scanAndConnect();
-        }).detach();
-        res.set_content("{\"status\":\"scan started\"}", "application/json");
+        auto job = g_jobs.submit(kScanJobs, "scan", [](JobExecutor::Context& job) {
+            scanAndConnect(job);
+            job.setStatus(getScanStatus());
+        });
+        sendSubmitted(res, job, "scan queued");
     });
 
     // POST /api/reset
     svr.Post("/api/reset", [](const httplib::Request&, httplib::Response& res) {
-        if (g_downloading) {
-            res.set_content("{\"error\":\"Download in progress\"}", "application/json");
-            return;
-        }
-        if (g_scanning) {
-            res.set_content("{\"error\":\"Scan already in progress\"}", "application/json");
+        if (g_jobs.busy(kDownloadJobs) || g_jobs.busy(kFormatJobs)) {
+            sendError(res, "Download or format in progress");
             return;
         }
-        std::thread([]() {
-            std::lock_guard<std::mutex> lock(g_mutex);
-            for (auto& cam : g_cameras) cam->disconnect();
-            g_cameras.clear();
-            scanAndConnect(true);
-        }).detach();
-        res.set_content("{\"status\":\"reset started\"}", "application/json");
+        auto job = g_jobs.submit(kScanJobs, "reset", [](JobExecutor::Context& job) {
+            disconnectAllCameras();
+            if (job.cancelled()) return;
+            scanAndConnect(job, true);
+            job.setStatus(getScanStatus());
+        });
+        sendSubmitted(res, job, "reset queued");
     });
 
-    // POST /api/format - quick format slot 1 on all cameras
-    svr.Post("/api/format", [](const httplib::Request&, httplib::Response& res) {
-        if (g_downloading || g_scanning) {
-            res.set_content("{\"error\":\"Busy\"}", "application/json");
+    // POST /api/format - quick format a slot on all cameras
+    // Body (optional): {"slot": 1|2}, default slot 1
+    svr.Post("/api/format", [](const httplib::Request& req, httplib::Response& res) {
+        if (g_jobs.busy(kScanJobs)) {
+            sendError(res, "Busy");
             return;
         }
-        std::lock_guard<std::mutex> lock(g_mutex);
-        int ok = 0, fail = 0;
-        for (auto& cam : g_cameras) {
-            if (cam->formatSlot1()) ok++; else fail++;
+        if (g_jobs.busy(kDownloadJobs)) {
+            sendError(res, "Download in progress");
+            return;
+        }
+        FormatRequest fmt;
+        std::string error;
+        if (!decodeFormatRequest(req.body, fmt, error)) {
+            sendError(res, error);
+            return;
         }
-        res.set_content("{\"ok\":" + std::to_string(ok) + ",\"failed\":" + std::to_string(fail) + "}", "application/json");
+        int64_t slot = fmt.slot;
+        auto job = g_jobs.submit(kFormatJobs, "slot" + std::to_string(slot), [slot](JobExecutor::Context& job) {
+            std::vector<std::shared_ptr<CameraDevice>> targets;
+            {
+                std::lock_guard<std::mutex> lock(g_mutex);
+                targets = g_cameras;
+            }
+            if (g_jobs.busy(kDownloadJobs)) {
+                job.fail("Download in progress");
+                return;
+            }
+            // A camera that is recording, not in Remote mode or whose state
+            // cannot be read is left alone
+            int ok = 0, fail = 0, skipped = 0;
+            for (auto& cam : targets) {
+                if (job.cancelled()) break;
+                std::lock_guard<std::mutex> op(cam->m_opMutex);
+                bool recording = false;
+                if (!cam->readRecording(recording) || recording) {
+                    skipped++;
+                    continue;
+                }
+                bool done = (slot == 2) ? cam->formatSlot2() : cam->formatSlot1();
+                if (done) ok++; else fail++;
+            }
+            std::string result = "Slot " + std::to_string(slot) + " formatted on " + std::to_string(ok) +
+                " camera(s), failed on " + std::to_string(fail) + ", skipped " + std::to_string(skipped);
+            if (fail) job.fail(result);
+            else job.setStatus(result);
+        });
+        sendSubmitted(res, job, "format queued");
     });
 
     // POST /api/preset/save - save current camera settings to preset file
     svr.Post("/api/preset/save", [](const httplib::Request&, httplib::Response& res) {
         std::lock_guard<std::mutex> lock(g_mutex);
         if (g_cameras.empty()) {
-            res.set_content("{\"error\":\"No cameras connected\"}", "application/json");
+            sendError(res, "No cameras connected");
             return;
         }
         // Save from first connected camera
         for (auto& cam : g_cameras) {
-            if (cam->m_connected) {
+            auto op = cam->tryLockOps();
+            if (op.owns_lock() && cam->m_connected) {
                 if (savePreset(*cam, g_presetPath)) {
-                    res.set_content("{\"status\":\"Preset saved to " + jsonEscape(g_presetPath) + "\"}", "application/json");
+                    JsonWriter& w = jsonWriter();
+                    w.beginObject().kv("status", "Preset saved to " + g_presetPath).endObject();
+                    sendJson(res, w);
                 } else {
-                    res.set_content("{\"error\":\"Failed to save preset\"}", "application/json");
+                    sendError(res, "Failed to save preset");
                 }
                 return;
             }
         }
-        res.set_content("{\"error\":\"No connected camera\"}", "application/json");
+        sendError(res, "No connected camera");
     });
 
     // POST /api/preset/apply - apply preset to all cameras now
+    // The preset is read when the job runs, so a coalesced request still gets the latest file
     svr.Post("/api/preset/apply", [](const httplib::Request&, httplib::Response& res) {
-        std::lock_guard<std::mutex> lock(g_mutex);
-        auto preset = loadPreset(g_presetPath);
-        if (preset.empty()) {
-            res.set_content("{\"error\":\"No preset file found at " + jsonEscape(g_presetPath) + "\"}", "application/json");
+        if (!fs::exists(g_presetPath)) {
+            sendError(res, "No preset file found at " + g_presetPath);
             return;
         }
-        int total = 0;
-        for (auto& cam : g_cameras) {
-            if (cam->m_connected) {
-                total += applyPreset(*cam, preset);
+        auto job = g_jobs.submit(kPresetJobs, "apply", [](JobExecutor::Context& job) {
+            auto preset = loadPreset(g_presetPath);
+            if (preset.empty()) {
+                job.fail("No usable preset at " + g_presetPath);
+                return;
             }
-        }
-        res.set_content("{\"applied\":" + std::to_string(total) + "}", "application/json");
+            std::vector<std::shared_ptr<CameraDevice>> cameras;
+            {
+                std::lock_guard<std::mutex> lock(g_mutex);
+                cameras = g_cameras;
+            }
+            // Busy cameras (offloading, recovering) are skipped rather than
+            // waited for, as are ones recording or not in Remote mode
+            std::vector<CameraDevice*> targets;
+            std::vector<std::unique_lock<std::mutex>> ops;
+            size_t skipped = 0;
+            for (auto& cam : cameras) {
+                auto op = cam->tryLockOps();
+                bool recording = false;
+                if (!op.owns_lock() || !cam->readRecording(recording) || recording) {
+                    skipped++;
+                    continue;
+                }
+                ops.push_back(std::move(op));
+                targets.push_back(cam.get());
+            }
+            int total = 0;
+            for (int n : applyPresetParallel(targets, preset)) total += n;
+            ops.clear();
+            job.setStatus("Applied " + std::to_string(total) + " setting(s) on " +
+                std::to_string(targets.size()) + " camera(s), skipped " + std::to_string(skipped));
+        });
+        sendSubmitted(res, job, "preset queued");
     });
 
     // GET /api/preset - get current preset contents
     svr.Get("/api/preset", [](const httplib::Request&, httplib::Response& res) {
         std::ifstream f(g_presetPath);
         if (!f.is_open()) {
-            res.set_content("{\"preset\":null,\"path\":\"" + jsonEscape(g_presetPath) + "\"}", "application/json");
+            JsonWriter& w = jsonWriter();
+            w.beginObject().key("preset").null().kv("path", g_presetPath).endObject();
+            sendJson(res, w);
             return;
         }
         std::string content((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
         f.close();
-        res.set_content("{\"preset\":" + content + ",\"path\":\"" + jsonEscape(g_presetPath) + "\"}", "application/json");
+        JsonWriter& w = jsonWriter();
+        w.beginObject().key("preset").raw(content).kv("path", g_presetPath).endObject();
+        sendJson(res, w);
+    });
+
+    // POST /api/properties - set several properties on several cameras in one request
+    // Body: {"cameras":[0,1], "properties":{"iso":..., "IsoSensitivity":...}}
+    // Applied on the preset queue; the job status lists the result per camera
+    svr.Post("/api/properties", [](const httplib::Request& req, httplib::Response& res) {
+        if (g_jobs.busy(kScanJobs)) {
+            sendError(res, "Busy");
+            return;
+        }
+        auto batch = std::make_shared<PropertyBatchRequest>();
+        std::string error;
+        if (!decodePropertyBatchRequest(req.body, *batch, error)) {
+            sendError(res, error);
+            return;
+        }
+        auto job = g_jobs.submit(kPresetJobs, "properties " + req.body, [batch](JobExecutor::Context& job) {
+            std::vector<std::shared_ptr<CameraDevice>> cameras;
+            {
+                std::lock_guard<std::mutex> lock(g_mutex);
+                cameras = g_cameras;
+            }
+            if (batch->cameras.empty()) {
+                for (size_t i = 0; i < cameras.size(); i++) batch->cameras.push_back(i);
+            }
+            // Each camera appears once in the parallel batch even if listed twice
+            std::vector<CameraDevice*> targets;
+            std::vector<size_t> targetIndex;
+            std::vector<size_t> busyIndex;
+            std::vector<std::unique_lock<std::mutex>> ops;
+            for (size_t index : batch->cameras) {
+                if (index >= cameras.size()) continue;
+                if (std::find(targetIndex.begin(), targetIndex.end(), index) != targetIndex.end()) continue;
+                if (std::find(busyIndex.begin(), busyIndex.end(), index) != busyIndex.end()) continue;
+                auto op = cameras[index]->tryLockOps();
+                if (!op.owns_lock()) {
+                    busyIndex.push_back(index);
+                    continue;
+                }
+                if (!cameras[index]->isRemote()) continue;
+                ops.push_back(std::move(op));
+                targets.push_back(cameras[index].get());
+                targetIndex.push_back(index);
+            }
+            std::vector<int> applied = applyPresetParallel(targets, batch->properties);
+            ops.clear();
+
+            std::string status;
+            for (size_t index : batch->cameras) {
+                if (!status.empty()) status += ", ";
+                status += "camera " + std::to_string(index) + ": ";
+                auto it = std::find(targetIndex.begin(), targetIndex.end(), index);
+                if (it != targetIndex.end()) {
+                    status += std::to_string(applied[it - targetIndex.begin()]) + " applied";
+                } else if (std::find(busyIndex.begin(), busyIndex.end(), index) != busyIndex.end()) {
+                    status += "busy";
+                } else {
+                    status += "not connected";
+                }
+            }
+            job.setStatus(status);
+        });
+        sendSubmitted(res, job, "properties queued");
     });
 
     // GET /api/files - list files on all cameras (mode-switch)
     svr.Get("/api/files", [](const httplib::Request&, httplib::Response& res) {
-        if (g_downloading) {
-            res.set_content("{\"error\":\"Download in progress\"}", "application/json");
+        if (g_jobs.busy(kDownloadJobs)) {
+            sendError(res, "Download in progress");
             return;
         }
         // For now, return a simple message - full listing requires mode switch
-        res.set_content("{\"message\":\"Use download to fetch files\"}", "application/json");
+        JsonWriter& w = jsonWriter();
+        w.beginObject().kv("message", "Use download to fetch files").endObject();
+        sendJson(res, w);
     });
 
     // POST /api/download
     svr.Post("/api/download", [](const httplib::Request& req, httplib::Response& res) {
-        if (g_downloading) {
-            res.set_content("{\"error\":\"Download already in progress\"}", "application/json");
+        DownloadRequest dlReq;
+        std::string error;
+        if (!decodeDownloadRequest(req.body, dlReq, error)) {
+            sendError(res, error);
             return;
         }
-        // Parse optional path from body
-        if (!req.body.empty()) {
-            std::string path = jsonGetString(req.body, "path");
-            if (!path.empty()) {
-                std::lock_guard<std::mutex> lock(g_mutex);
-                g_downloadPath = path;
+        if (g_jobs.busy(kFormatJobs) || g_jobs.busy(kScanJobs)) {
+            sendError(res, "Format or scan in progress");
+            return;
+        }
+        std::vector<std::shared_ptr<CameraDevice>> targets;
+        std::string dlPath;
+        {
+            std::lock_guard<std::mutex> lock(g_mutex);
+            if (!dlReq.path.empty()) g_downloadPath = dlReq.path;
+            dlPath = g_downloadPath;
+            if (dlReq.cameras.empty()) {
+                for (size_t i = 0; i < g_cameras.size(); i++) dlReq.cameras.push_back(i);
+            }
+            for (size_t index : dlReq.cameras) {
+                if (index >= g_cameras.size() || !g_cameras[index]->isRemote()) continue;
+                if (std::find(targets.begin(), targets.end(), g_cameras[index]) != targets.end()) continue;
+                targets.push_back(g_cameras[index]);
+            }
+        }
+        if (targets.empty()) {
+            sendError(res, "No connected cameras to download from");
+            return;
+        }
+        // Same destination and cameras as a pending download → same job
+        std::string key = dlPath;
+        for (auto& cam : targets) key += "|" + std::string(cam->m_modelId.begin(), cam->m_modelId.end());
+        auto job = g_jobs.submit(kDownloadJobs, key, [targets, dlPath](JobExecutor::Context& job) {
+            if (g_jobs.busy(kFormatJobs)) {
+                job.fail("Format in progress");
+                return;
             }
+            downloadFiles(job, targets, dlPath);
+        });
+        sendSubmitted(res, job, "download queued");
+    });
+
+    // GET /api/jobs - background jobs: pending, running and the last finished ones
+    svr.Get("/api/jobs", [](const httplib::Request&, httplib::Response& res) {
+        JsonWriter& w = jsonWriter();
+        writeJobsJson(w);
+        sendJson(res, w);
+    });
+
+    // POST /api/jobs/cancel - Body: {"id": N}. A running job stops at its next safe point.
+    svr.Post("/api/jobs/cancel", [](const httplib::Request& req, httplib::Response& res) {
+        JobRequest jobReq;
+        std::string error;
+        if (!decodeJobRequest(req.body, jobReq, error)) {
+            sendError(res, error);
+            return;
         }
-        std::thread(downloadFilesThread).detach();
-        res.set_content("{\"status\":\"download started\"}", "application/json");
+        if (!g_jobs.cancel(jobReq.id)) {
+            sendError(res, "No pending or running job " + std::to_string(jobReq.id));
+            return;
+        }
+        JsonWriter& w = jsonWriter();
+        w.beginObject().kv("cancelled", jobReq.id).endObject();
+        sendJson(res, w);
     });
 
     // POST /api/set-download-path
     svr.Post("/api/set-download-path", [](const httplib::Request& req, httplib::Response& res) {
-        std::string path = jsonGetString(req.body, "path");
-        if (path.empty()) {
-            res.set_content("{\"error\":\"Missing path\"}", "application/json");
+        PathRequest pathReq;
+        std::string error;
+        if (!decodePathRequest(req.body, pathReq, error)) {
+            sendError(res, error);
+            return;
+        }
+        if (pathReq.path.empty()) {
+            sendError(res, "Missing path");
             return;
         }
         std::lock_guard<std::mutex> lock(g_mutex);
-        g_downloadPath = path;
-        res.set_content("{\"downloadPath\":\"" + jsonEscape(g_downloadPath) + "\"}", "application/json");
+        g_downloadPath = pathReq.path;
+        JsonWriter& w = jsonWriter();
+        w.beginObject().kv("downloadPath", g_downloadPath).endObject();
+        sendJson(res, w);
     });
 
     std::cout << "Server running at http://localhost:" << port << "\n";
@@ -1804,14 +3549,16 @@ int main(int argc, char* argv[])
 
     // Shutdown
     g_running = false;
+    notifyHealthChange();
     if (mgmtThread.joinable()) mgmtThread.join();
+    // Before the connect workers: a running scan waits on its connect tasks
+    g_jobs.stop();
+    g_connectQueue.stop();
 
-    {
-        std::lock_guard<std::mutex> lock(g_mutex);
-        for (auto& cam : g_cameras) cam->disconnect();
-        g_cameras.clear();
-    }
+    disconnectAllCameras();
     SCRSDK::Release();
+    CallbackDispatcher::instance().stop();
+    Logger::instance().stop();
 
     std::cout << "Server stopped.\n";
     return 0;
@@ -0,0 +1,631 @@
+// recording start/stop latency and cross-camera skew benchmark
+//
+// Repeatedly sends MovieRecord Down/Up to every connected camera and measures,
+// per camera, the time from issuing SendCommand to the OnPropertyChangedCodes
+// that reports the new CrDeviceProperty_RecordingState, plus the spread of
+// those times across cameras. Every sample goes to a CSV file; latency and
+// skew distributions go to a JSON summary.
+//
+//   recordLatencyBench [--iterations 20] [--record-ms 3000] [--idle-ms 2000]
+//                      [--timeout-ms 5000] [--parallel] [--csv file] [--json file]
+//                      [--simulate N [--sim-latency-ms 120] [--sim-jitter-ms 30]]
+//
+// --simulate runs against N simulated cameras instead of the SDK, to check the
+// harness (and its own overhead) without hardware.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// macro for multibyte character
+#if defined(_WIN32) || defined(_WIN64)
+  using CrString = std::wstring;
+  #define CRSTR(s) L ## s
+  #define CrCout std::wcout
+#else
+  using CrString = std::string;
+  #define CRSTR(s) s
+  #define CrCout std::cout
+#endif
+
+#include "CrDeviceProperty.h"
+#include "CameraRemote_SDK.h"
+#include "IDeviceCallback.h"
+#include "CrDebugString.h"   // use CrDebugString.cpp
+
+using Clock = std::chrono::steady_clock;
+
+static double toMs(Clock::duration d)
+{
+    return std::chrono::duration<double, std::milli>(d).count();
+}
+
+// ---------------------------------------------------------------------------
+// Cameras
+// ---------------------------------------------------------------------------
+
+// One camera under test. Backends report every RecordingState change through
+// notifyRecordingStateChanged(), with the time taken on entry to the callback.
+class BenchCamera
+{
+public:
+    std::string m_name;
+
+    virtual ~BenchCamera() = default;
+
+    // SendCommand(MovieRecord, Down/Up)
+    virtual bool sendRecord(bool start) = 0;
+    // Current CrDeviceProperty_RecordingState == Recording
+    virtual bool readRecording(bool& recording) = 0;
+
+    void notifyRecordingStateChanged(Clock::time_point at)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_changes.push_back(at);
+        m_cond.notify_all();
+    }
+
+    // Forget earlier changes; call before sending the command
+    void arm()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_changes.clear();
+    }
+
+    // Wait for a change after arm() that leaves the camera in the given
+    // state. changedAt is the time of the last change seen before it was read.
+    bool waitForState(bool recording, Clock::time_point deadline, Clock::time_point& changedAt)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        size_t seen = 0;
+        while (true) {
+            if (!m_cond.wait_until(lock, deadline, [&]() { return m_changes.size() > seen; })) return false;
+            seen = m_changes.size();
+            Clock::time_point last = m_changes.back();
+            lock.unlock();
+            bool state = false;
+            bool ok = readRecording(state);
+            lock.lock();
+            if (ok && state == recording) {
+                changedAt = last;
+                return true;
+            }
+        }
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::vector<Clock::time_point> m_changes;
+};
+
+class SdkCamera : public BenchCamera, public SCRSDK::IDeviceCallback
+{
+public:
+    int64_t m_device_handle = 0;
+
+    ~SdkCamera() override { disconnect(); }
+
+    bool connect(SCRSDK::ICrCameraObjectInfo* objInfo)
+    {
+        CrString model(objInfo->GetModel());
+        m_name.assign(model.begin(), model.end());
+        CrString id = (CrString(objInfo->GetConnectionTypeName()) == CRSTR("IP"))
+            ? CrString(objInfo->GetMACAddressChar()) : CrString((CrChar*)objInfo->GetId());
+        m_name += " (" + std::string(id.begin(), id.end()) + ")";
+
+        if (objInfo->GetSSHsupport() == SCRSDK::CrSSHsupport_ON) {
+            std::cout << "  Skipping " << m_name << ": SSH cameras are not supported by this benchmark\n";
+            return false;
+        }
+
+        std::future<bool> connected = expectConnection();
+        SCRSDK::CrError err = SCRSDK::Connect(objInfo, this, &m_device_handle,
+            SCRSDK::CrSdkControlMode_Remote, SCRSDK::CrReconnecting_ON);
+        if (err) {
+            std::cout << "  Connect failed for " << m_name << ": " << CrErrorString(err) << "\n";
+            cancelConnection();
+            return false;
+        }
+        if (connected.wait_for(std::chrono::seconds(10)) != std::future_status::ready || !connected.get()) {
+            std::cout << "  No connection to " << m_name << "\n";
+            cancelConnection();
+            return false;
+        }
+        m_connected = true;
+        return true;
+    }
+
+    void disconnect()
+    {
+        if (m_connected) {
+            SCRSDK::Disconnect(m_device_handle);
+            for (int i = 0; i < 30 && m_connected; i++) std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            m_connected = false;
+        }
+        if (m_device_handle) {
+            SCRSDK::ReleaseDevice(m_device_handle);
+            m_device_handle = 0;
+        }
+    }
+
+    bool sendRecord(bool start) override
+    {
+        return SCRSDK::SendCommand(m_device_handle, SCRSDK::CrCommandId_MovieRecord,
+            start ? SCRSDK::CrCommandParam_Down : SCRSDK::CrCommandParam_Up) == SCRSDK::CrError_None;
+    }
+
+    bool readRecording(bool& recording) override
+    {
+        CrInt32u code = SCRSDK::CrDeviceProperty_RecordingState;
+        SCRSDK::CrDeviceProperty* props = nullptr;
+        CrInt32 n = 0;
+        SCRSDK::CrError err = SCRSDK::GetSelectDeviceProperties(m_device_handle, 1, &code, &props, &n);
+        if (err || !props) return false;
+        bool ok = n >= 1;
+        if (ok) recording = props[0].GetCurrentValue() == SCRSDK::CrMovie_Recording_State_Recording;
+        SCRSDK::ReleaseDeviceProperties(m_device_handle, props);
+        return ok;
+    }
+
+    // override of IDeviceCallback
+
+    void OnConnected(SCRSDK::DeviceConnectionVersioin version) override { resolveConnection(true); }
+    void OnError(CrInt32u error) override { resolveConnection(false); }
+    void OnDisconnected(CrInt32u error) override { m_connected = false; }
+
+    // Timestamp first; the state itself is read by the waiting thread
+    void OnPropertyChangedCodes(CrInt32u num, CrInt32u* codes) override
+    {
+        Clock::time_point now = Clock::now();
+        for (CrInt32u i = 0; i < num; i++) {
+            if (codes[i] == SCRSDK::CrDeviceProperty_RecordingState) {
+                notifyRecordingStateChanged(now);
+                return;
+            }
+        }
+    }
+
+private:
+    std::atomic<bool> m_connected{false};
+    std::mutex m_connectMutex;
+    std::unique_ptr<std::promise<bool>> m_connectPromise;
+
+    std::future<bool> expectConnection()
+    {
+        std::lock_guard<std::mutex> lock(m_connectMutex);
+        m_connectPromise.reset(new std::promise<bool>());
+        return m_connectPromise->get_future();
+    }
+
+    void cancelConnection()
+    {
+        std::lock_guard<std::mutex> lock(m_connectMutex);
+        m_connectPromise.reset();
+        if (m_device_handle) {
+            SCRSDK::ReleaseDevice(m_device_handle);
+            m_device_handle = 0;
+        }
+    }
+
+    void resolveConnection(bool ok)
+    {
+        std::lock_guard<std::mutex> lock(m_connectMutex);
+        if (m_connectPromise) {
+            m_connectPromise->set_value(ok);
+            m_connectPromise.reset();
+        }
+    }
+};
+
+// Reports the state change after a random delay (normal around a per-camera
+// mean), on its own thread like the SDK's callback thread. A jitter of zero
+// or less gives the mean every time.
+class SimCamera : public BenchCamera
+{
+public:
+    SimCamera(int index, double latencyMs, double jitterMs)
+        : m_rng(0x5eed + index), m_jitterMs(std::max(0.0, jitterMs)),
+          m_meanMs(latencyMs + index * m_jitterMs / 4)
+    {
+        m_name = "sim-" + std::to_string(index);
+        m_thread = std::thread([this]() { run(); });
+    }
+
+    ~SimCamera() override
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_cond.notify_all();
+        m_thread.join();
+    }
+
+    bool sendRecord(bool start) override
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // Scaled standard normal: normal_distribution needs a positive stddev
+        double ms = m_meanMs;
+        if (m_jitterMs > 0) ms += m_jitterMs * m_normal(m_rng);
+        ms = std::max(1.0, ms);
+        m_due = Clock::now() + std::chrono::microseconds((int64_t)(ms * 1000));
+        m_target = start;
+        m_pending = true;
+        m_cond.notify_all();
+        return true;
+    }
+
+    bool readRecording(bool& recording) override
+    {
+        recording = m_recording.load();
+        return true;
+    }
+
+private:
+    std::mt19937 m_rng;
+    double m_jitterMs;
+    double m_meanMs;
+    std::normal_distribution<double> m_normal; // mean 0, stddev 1
+    std::atomic<bool> m_recording{false};
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    Clock::time_point m_due;
+    bool m_target = false;
+    bool m_pending = false;
+    bool m_stop = false;
+    std::thread m_thread;
+
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (!m_stop) {
+            if (!m_pending) {
+                m_cond.wait(lock);
+                continue;
+            }
+            if (Clock::now() < m_due) {
+                m_cond.wait_until(lock, m_due);
+                continue;
+            }
+            m_pending = false;
+            m_recording = m_target;
+            lock.unlock();
+            notifyRecordingStateChanged(Clock::now());
+            lock.lock();
+        }
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Measurement
+// ---------------------------------------------------------------------------
+
+struct Sample {
+    int iteration;
+    bool start;              // start (Down) or stop (Up)
+    size_t camera;
+    Clock::time_point issued;   // just before SendCommand
+    Clock::time_point returned; // SendCommand returned
+    Clock::time_point changed;  // RecordingState callback
+    bool sent = false;
+    bool ok = false;            // state reached before the timeout
+};
+
+struct Options {
+    int iterations = 20;
+    int recordMs = 3000;
+    int idleMs = 2000;
+    int timeoutMs = 5000;
+    bool parallel = false;
+    int simulate = 0;
+    double simLatencyMs = 120;
+    double simJitterMs = 30;
+    std::string csvPath = "record_latency.csv";
+    std::string jsonPath = "record_latency.json";
+};
+
+// Issue the command to every camera, sequentially in camera order (as the
+// web controller does) or all at once from one thread per camera, then wait
+// for each RecordingState change.
+static std::vector<Sample> runPhase(std::vector<BenchCamera*>& cams, int iteration, bool start, const Options& opt)
+{
+    std::vector<Sample> samples(cams.size());
+    for (size_t i = 0; i < cams.size(); i++) {
+        samples[i].iteration = iteration;
+        samples[i].start = start;
+        samples[i].camera = i;
+        cams[i]->arm();
+    }
+
+    auto issue = [&](size_t i) {
+        samples[i].issued = Clock::now();
+        samples[i].sent = cams[i]->sendRecord(start);
+        samples[i].returned = Clock::now();
+    };
+    if (opt.parallel) {
+        std::vector<std::thread> threads;
+        std::atomic<size_t> ready{0};
+        std::atomic<bool> go{false};
+        for (size_t i = 0; i < cams.size(); i++) {
+            threads.emplace_back([&, i]() {
+                ready++;
+                while (!go) std::this_thread::yield();
+                issue(i);
+            });
+        }
+        while (ready < cams.size()) std::this_thread::yield();
+        go = true;
+        for (auto& t : threads) t.join();
+    }
+    else {
+        for (size_t i = 0; i < cams.size(); i++) issue(i);
+    }
+
+    for (size_t i = 0; i < cams.size(); i++) {
+        if (!samples[i].sent) continue;
+        Clock::time_point deadline = samples[i].issued + std::chrono::milliseconds(opt.timeoutMs);
+        samples[i].ok = cams[i]->waitForState(start, deadline, samples[i].changed);
+    }
+    return samples;
+}
+
+struct Stats {
+    size_t count = 0;
+    double min = 0, mean = 0, p50 = 0, p90 = 0, p99 = 0, max = 0;
+};
+
+static Stats stats(std::vector<double> v)
+{
+    Stats s;
+    s.count = v.size();
+    if (v.empty()) return s;
+    std::sort(v.begin(), v.end());
+    // Nearest rank
+    auto pct = [&](double p) {
+        size_t rank = (size_t)std::ceil(p * v.size());
+        return v[std::min(v.size(), std::max<size_t>(rank, 1)) - 1];
+    };
+    s.min = v.front();
+    s.max = v.back();
+    double sum = 0;
+    for (double x : v) sum += x;
+    s.mean = sum / v.size();
+    s.p50 = pct(0.50);
+    s.p90 = pct(0.90);
+    s.p99 = pct(0.99);
+    return s;
+}
+
+static void writeStats(std::ostream& out, const char* name, const Stats& s)
+{
+    char buf[256];
+    snprintf(buf, sizeof(buf),
+        "\"%s\":{\"count\":%zu,\"min\":%.3f,\"mean\":%.3f,\"p50\":%.3f,\"p90\":%.3f,\"p99\":%.3f,\"max\":%.3f}",
+        name, s.count, s.min, s.mean, s.p50, s.p90, s.p99, s.max);
+    out << buf;
+}
+
+static std::string jsonString(const std::string& s)
+{
+    std::string out = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out + "\"";
+}
+
+// Per phase: latency per camera and overall, SendCommand time, skew
+// (max - min change time per iteration, over cameras that all made it)
+static void writeSummary(std::ostream& out, const std::vector<BenchCamera*>& cams,
+                         const std::vector<Sample>& all, const Options& opt)
+{
+    out << "{\"backend\":\"" << (opt.simulate ? "simulated" : "sdk") << "\""
+        << ",\"iterations\":" << opt.iterations
+        << ",\"parallelIssue\":" << (opt.parallel ? "true" : "false")
+        << ",\"unit\":\"ms\",\"cameras\":[";
+    for (size_t i = 0; i < cams.size(); i++) out << (i ? "," : "") << jsonString(cams[i]->m_name);
+    out << "]";
+
+    for (bool start : { true, false }) {
+        std::vector<double> latency, send, skew, issueSpread;
+        std::vector<std::vector<double>> perCamera(cams.size());
+        size_t timeouts = 0;
+        for (int it = 1; it <= opt.iterations; it++) {
+            Clock::time_point first = Clock::time_point::max(), last = Clock::time_point::min();
+            Clock::time_point firstIssue = Clock::time_point::max(), lastIssue = Clock::time_point::min();
+            bool complete = true;
+            for (const auto& s : all) {
+                if (s.iteration != it || s.start != start) continue;
+                if (!s.sent || !s.ok) {
+                    timeouts++;
+                    complete = false;
+                    continue;
+                }
+                double ms = toMs(s.changed - s.issued);
+                latency.push_back(ms);
+                perCamera[s.camera].push_back(ms);
+                send.push_back(toMs(s.returned - s.issued));
+                first = std::min(first, s.changed);
+                last = std::max(last, s.changed);
+                firstIssue = std::min(firstIssue, s.issued);
+                lastIssue = std::max(lastIssue, s.issued);
+            }
+            if (complete && cams.size() > 1 && first != Clock::time_point::max()) {
+                skew.push_back(toMs(last - first));
+                issueSpread.push_back(toMs(lastIssue - firstIssue));
+            }
+        }
+
+        out << ",\"" << (start ? "start" : "stop") << "\":{";
+        out << "\"failed\":" << timeouts << ",";
+        writeStats(out, "latency", stats(latency));
+        out << ",";
+        writeStats(out, "sendCommand", stats(send));
+        out << ",";
+        writeStats(out, "skew", stats(skew));
+        out << ",";
+        writeStats(out, "issueSpread", stats(issueSpread));
+        out << ",\"perCamera\":[";
+        for (size_t i = 0; i < cams.size(); i++) {
+            out << (i ? "," : "") << "{";
+            writeStats(out, "latency", stats(perCamera[i]));
+            out << "}";
+        }
+        out << "]}";
+    }
+    out << "}\n";
+}
+
+static void printSummary(const std::vector<BenchCamera*>& cams, const std::vector<Sample>& all)
+{
+    for (bool start : { true, false }) {
+        std::cout << (start ? "Start" : "Stop") << " latency (ms):\n";
+        for (size_t i = 0; i < cams.size(); i++) {
+            std::vector<double> v;
+            size_t failed = 0;
+            for (const auto& s : all) {
+                if (s.start != start || s.camera != i) continue;
+                if (s.sent && s.ok) v.push_back(toMs(s.changed - s.issued));
+                else failed++;
+            }
+            Stats st = stats(v);
+            printf("  %-36s n=%-4zu p50=%8.1f p90=%8.1f max=%8.1f failed=%zu\n",
+                cams[i]->m_name.c_str(), st.count, st.p50, st.p90, st.max, failed);
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// main
+// ---------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+    Options opt;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--iterations" && hasValue) opt.iterations = std::atoi(argv[++i]);
+        else if (arg == "--record-ms" && hasValue) opt.recordMs = std::atoi(argv[++i]);
+        else if (arg == "--idle-ms" && hasValue) opt.idleMs = std::atoi(argv[++i]);
+        else if (arg == "--timeout-ms" && hasValue) opt.timeoutMs = std::atoi(argv[++i]);
+        else if (arg == "--parallel") opt.parallel = true;
+        else if (arg == "--simulate" && hasValue) opt.simulate = std::atoi(argv[++i]);
+        else if (arg == "--sim-latency-ms" && hasValue) opt.simLatencyMs = std::atof(argv[++i]);
+        else if (arg == "--sim-jitter-ms" && hasValue) opt.simJitterMs = std::atof(argv[++i]);
+        else if (arg == "--csv" && hasValue) opt.csvPath = argv[++i];
+        else if (arg == "--json" && hasValue) opt.jsonPath = argv[++i];
+        else {
+            std::cerr << "unknown argument: " << arg << "\n";
+            return 1;
+        }
+    }
+    if (opt.iterations < 1) opt.iterations = 1;
+
+    std::vector<std::unique_ptr<SimCamera>> simCameras;
+    std::vector<std::unique_ptr<SdkCamera>> sdkCameras;
+    std::vector<BenchCamera*> cams;
+    SCRSDK::ICrEnumCameraObjectInfo* enumInfo = nullptr;
+
+    if (opt.simulate > 0) {
+        for (int i = 0; i < opt.simulate; i++) {
+            simCameras.emplace_back(new SimCamera(i, opt.simLatencyMs, opt.simJitterMs));
+            cams.push_back(simCameras.back().get());
+        }
+    }
+    else {
+        if (!SCRSDK::Init()) {
+            std::cerr << "Failed to initialize Sony Camera Remote SDK.\n";
+            return 1;
+        }
+        SCRSDK::CrError err = SCRSDK::EnumCameraObjects(&enumInfo, 3/*timeInSec*/);
+        if (err || !enumInfo) {
+            std::cerr << "No cameras found.\n";
+            SCRSDK::Release();
+            return 1;
+        }
+        for (CrInt32u i = 0; i < enumInfo->GetCount(); i++) {
+            std::unique_ptr<SdkCamera> cam(new SdkCamera());
+            if (!cam->connect(const_cast<SCRSDK::ICrCameraObjectInfo*>(enumInfo->GetCameraObjectInfo(i)))) continue;
+            std::cout << "  Connected: " << cam->m_name << "\n";
+            cams.push_back(cam.get());
+            sdkCameras.push_back(std::move(cam));
+        }
+        // Let the cameras settle after connecting before the first command
+        std::this_thread::sleep_for(std::chrono::seconds(2));
+    }
+
+    int result = 1;
+    if (cams.empty()) {
+        std::cerr << "No cameras connected.\n";
+    }
+    else {
+        std::cout << "Benchmarking " << cams.size() << " camera(s), " << opt.iterations << " iteration(s), "
+                  << (opt.parallel ? "parallel" : "sequential") << " issue\n";
+
+        // Start from Not_Recording everywhere
+        std::vector<BenchCamera*> recording;
+        for (auto* cam : cams) {
+            bool rec = false;
+            if (cam->readRecording(rec) && rec) recording.push_back(cam);
+        }
+        if (!recording.empty()) {
+            std::cout << "Stopping " << recording.size() << " camera(s) that are already recording\n";
+            runPhase(recording, 0, false, opt);
+            std::this_thread::sleep_for(std::chrono::milliseconds(opt.idleMs));
+        }
+
+        std::vector<Sample> all;
+        for (int it = 1; it <= opt.iterations; it++) {
+            for (auto& s : runPhase(cams, it, true, opt)) all.push_back(s);
+            std::this_thread::sleep_for(std::chrono::milliseconds(opt.recordMs));
+            for (auto& s : runPhase(cams, it, false, opt)) all.push_back(s);
+            std::cout << "  iteration " << it << "/" << opt.iterations << " done\n";
+            if (it < opt.iterations) std::this_thread::sleep_for(std::chrono::milliseconds(opt.idleMs));
+        }
+
+        // Times are relative to the first command, in microseconds
+        Clock::time_point origin = all.empty() ? Clock::now() : all.front().issued;
+        auto us = [&](Clock::time_point t) { return (long long)std::chrono::duration_cast<std::chrono::microseconds>(t - origin).count(); };
+        std::ofstream csv(opt.csvPath, std::ios::out | std::ios::trunc);
+        csv << "iteration,phase,camera,issued_us,returned_us,changed_us,send_ms,latency_ms,result\n";
+        for (const auto& s : all) {
+            char line[512];
+            const char* res = !s.sent ? "send_failed" : (s.ok ? "ok" : "timeout");
+            snprintf(line, sizeof(line), "%d,%s,\"%s\",%lld,%lld,%lld,%.3f,%.3f,%s\n",
+                s.iteration, s.start ? "start" : "stop", cams[s.camera]->m_name.c_str(),
+                us(s.issued), us(s.returned), s.ok ? us(s.changed) : -1LL,
+                toMs(s.returned - s.issued), s.ok ? toMs(s.changed - s.issued) : -1.0, res);
+            csv << line;
+        }
+        std::ofstream json(opt.jsonPath, std::ios::out | std::ios::trunc);
+        writeSummary(json, cams, all, opt);
+
+        printSummary(cams, all);
+        std::cout << "Samples: " << opt.csvPath << ", summary: " << opt.jsonPath << "\n";
+        result = (csv && json) ? 0 : 1;
+    }
+
+    sdkCameras.clear();
+    simCameras.clear();
+    if (opt.simulate == 0) {
+        if (enumInfo) enumInfo->Release();
+        SCRSDK::Release();
+    }
+    return result;
+}